@@ -1120,8 +1120,8 @@ ASGError_t asgGeometryComputeBounds(ASGGeometry geom,
                     sg->vertices[sg->indices[i]*3+2]
                 };
 
-                asg::Vec3f v1 = v - sg->radii[sg->indices[i]];
-                asg::Vec3f v2 = v + sg->radii[sg->indices[i]];
+                asg::Vec3f v1 = v - (sg->radii ? sg->radii[sg->indices[i]] : sg->defaultRadius);
+                asg::Vec3f v2 = v + (sg->radii ? sg->radii[sg->indices[i]] : sg->defaultRadius);
 
                 *minX = fminf(*minX,v1.x);
                 *minY = fminf(*minY,v1.y);
@@ -1148,8 +1148,8 @@ ASGError_t asgGeometryComputeBounds(ASGGeometry geom,
                     sg->vertices[i*3+2]
                 };
 
-                asg::Vec3f v1 = v - sg->radii[i];
-                asg::Vec3f v2 = v + sg->radii[i];
+                asg::Vec3f v1 = v - (sg->radii ? sg->radii[i] : sg->defaultRadius);
+                asg::Vec3f v2 = v + (sg->radii ? sg->radii[i] : sg->defaultRadius);
 
                 *minX = fminf(*minX,v1.x);
                 *minY = fminf(*minY,v1.y);
@@ -1187,7 +1187,7 @@ ASGError_t asgGeometryComputeBounds(ASGGeometry geom,
                     cg->vertices[cg->indices[i*2+1]*3+2]
                 };
 
-                float radius = cg->radii[i];
+                float radius = (cg->radii ? cg->radii[i] : cg->defaultRadius);
 
                 asg::Vec3f a = v2 - v1;
                 float aa = dot(a,a);
@@ -1243,7 +1243,7 @@ ASGError_t asgGeometryComputeBounds(ASGGeometry geom,
                     cg->vertices[i*6+5]
                 };
 
-                float radius = cg->radii[i];
+                float radius = (cg->radii ? cg->radii[i] : cg->defaultRadius);
 
                 asg::Vec3f a = v2 - v1;
                 float aa = dot(a,a);
@@ -2162,8 +2162,8 @@ static void visitBounds(ASGVisitor self, ASGObject obj, void* userData) {
                             geom->vertices[geom->indices[i]*3+2]
                         };
 
-                        asg::Vec3f v1 = v - geom->radii[geom->indices[i]];
-                        asg::Vec3f v2 = v + geom->radii[geom->indices[i]];
+                        asg::Vec3f v1 = v - (geom->radii ? geom->radii[geom->indices[i]] : geom->defaultRadius);
+                        asg::Vec3f v2 = v + (geom->radii ? geom->radii[geom->indices[i]] : geom->defaultRadius);
 
                         for (asg::Mat4x3f trans : bounds->transStack) {
                             v1 = trans * asg::Vec4f{v1.x,v1.y,v1.z,1.f};
@@ -2185,8 +2185,8 @@ static void visitBounds(ASGVisitor self, ASGObject obj, void* userData) {
                             geom->vertices[i*3+2]
                         };
 
-                        asg::Vec3f v1 = v - geom->radii[i];
-                        asg::Vec3f v2 = v + geom->radii[i];
+                        asg::Vec3f v1 = v - (geom->radii ? geom->radii[i] : geom->defaultRadius);
+                        asg::Vec3f v2 = v + (geom->radii ? geom->radii[i] : geom->defaultRadius);
 
                         for (asg::Mat4x3f trans : bounds->transStack) {
                             v1 = trans * asg::Vec4f{v1.x,v1.y,v1.z,1.f};
@@ -2219,7 +2219,7 @@ static void visitBounds(ASGVisitor self, ASGObject obj, void* userData) {
                             geom->vertices[geom->indices[i*2+1]*3+2]
                         };
 
-                        float radius = geom->radii[i];
+                        float radius = (geom->radii ? geom->radii[i] : geom->defaultRadius);
 
                         asg::Vec3f a = v2 - v1;
                         float aa = dot(a,a);
@@ -2271,7 +2271,7 @@ static void visitBounds(ASGVisitor self, ASGObject obj, void* userData) {
                             geom->vertices[i*6+5]
                         };
 
-                        float radius = geom->radii[i];
+                        float radius = (geom->radii ? geom->radii[i] : geom->defaultRadius);
 
                         asg::Vec3f a = v2 - v1;
                         float aa = dot(a,a);
@@ -2489,8 +2489,8 @@ static void pickObject(ASGVisitor self, ASGObject obj, void* userData) {
                             geom->vertices[geom->indices[i]*3+2]
                         };
 
-                        asg::Vec3f v1 = v - geom->radii[geom->indices[i]];
-                        asg::Vec3f v2 = v + geom->radii[geom->indices[i]];
+                        asg::Vec3f v1 = v - (geom->radii ? geom->radii[geom->indices[i]] : geom->defaultRadius);
+                        asg::Vec3f v2 = v + (geom->radii ? geom->radii[geom->indices[i]] : geom->defaultRadius);
 
                         for (asg::Mat4x3f trans : bounds.transStack) {
                             v1 = trans * asg::Vec4f{v1.x,v1.y,v1.z,1.f};
@@ -2512,8 +2512,8 @@ static void pickObject(ASGVisitor self, ASGObject obj, void* userData) {
                             geom->vertices[i*3+2]
                         };
 
-                        asg::Vec3f v1 = v - geom->radii[i];
-                        asg::Vec3f v2 = v + geom->radii[i];
+                        asg::Vec3f v1 = v - (geom->radii ? geom->radii[i] : geom->defaultRadius);
+                        asg::Vec3f v2 = v + (geom->radii ? geom->radii[i] : geom->defaultRadius);
 
                         for (asg::Mat4x3f trans : bounds.transStack) {
                             v1 = trans * asg::Vec4f{v1.x,v1.y,v1.z,1.f};
@@ -2546,7 +2546,7 @@ static void pickObject(ASGVisitor self, ASGObject obj, void* userData) {
                             geom->vertices[geom->indices[i*2+1]*3+2]
                         };
 
-                        float radius = geom->radii[i];
+                        float radius = (geom->radii ? geom->radii[i] : geom->defaultRadius);
 
                         asg::Vec3f a = v2 - v1;
                         float aa = dot(a,a);
@@ -2598,7 +2598,7 @@ static void pickObject(ASGVisitor self, ASGObject obj, void* userData) {
                             geom->vertices[i*6+5]
                         };
 
-                        float radius = geom->radii[i];
+                        float radius = (geom->radii ? geom->radii[i] : geom->defaultRadius);
 
                         asg::Vec3f a = v2 - v1;
                         float aa = dot(a,a);
@@ -2736,6 +2736,26 @@ struct ANARI {
     asg::Mat4x3f trans;
 };
 
+// Geometry, volume and lookup table buffers stay valid for as long as the
+// asg objects, which are never freed before the world is. They are handed
+// over with a deleter that does nothing, so that the device may use them in
+// place rather than copy them when the arrays are released
+static void keepBuffer(const void* userPtr, const void* appMemory)
+{
+}
+
+// The handle vectors are temporaries, so object arrays are managed by the
+// device rather than shared
+static ANARIArray1D newObjectArray1D(ANARIDevice device, const void* objects,
+                                     ANARIDataType type, uint64_t numObjects)
+{
+    ANARIArray1D array = anariNewArray1D(device,nullptr,0,0,type,numObjects);
+    void* data = anariMapArray(device,array);
+    memcpy(data,objects,numObjects*sizeof(ANARIObject));
+    anariUnmapArray(device,array);
+    return array;
+}
+
 template <typename GroupNode>
 void setANARIEntities(GroupNode groupNode, ANARI& anari)
 {
@@ -2746,22 +2766,22 @@ void setANARIEntities(GroupNode groupNode, ANARI& anari)
         anariUnsetParameter(anari.device,groupNode,"light");
 
     if (anari.surfaces.size() > 0) {
-        ANARIArray1D surfaces = anariNewArray1D(anari.device,anari.surfaces.data(),0,0,
-                                                ANARI_SURFACE,anari.surfaces.size());
+        ANARIArray1D surfaces = newObjectArray1D(anari.device,anari.surfaces.data(),
+                                                 ANARI_SURFACE,anari.surfaces.size());
         anariSetParameter(anari.device,groupNode,"surface",ANARI_ARRAY1D,&surfaces);
         anariRelease(anari.device,surfaces);
     }
 
     if (anari.volumes.size() > 0) {
-        ANARIArray1D volumes = anariNewArray1D(anari.device,anari.volumes.data(),0,0,
-                                               ANARI_VOLUME,anari.volumes.size());
+        ANARIArray1D volumes = newObjectArray1D(anari.device,anari.volumes.data(),
+                                                ANARI_VOLUME,anari.volumes.size());
         anariSetParameter(anari.device,groupNode,"volume",ANARI_ARRAY1D,&volumes);
         anariRelease(anari.device,volumes);
     }
 
     if ((anari.flags & ASG_BUILD_WORLD_FLAG_LIGHTS) && anari.lights.size() > 0) {
-        ANARIArray1D lights = anariNewArray1D(anari.device,anari.lights.data(),0,0,
-                                              ANARI_LIGHT,anari.lights.size());
+        ANARIArray1D lights = newObjectArray1D(anari.device,anari.lights.data(),
+                                               ANARI_LIGHT,anari.lights.size());
         anariSetParameter(anari.device,groupNode,"light",ANARI_ARRAY1D,&lights);
         anariRelease(anari.device,lights);
     }
@@ -2770,9 +2790,8 @@ void setANARIEntities(GroupNode groupNode, ANARI& anari)
         anariUnsetParameter(anari.device,groupNode,"instance");
 
         if (anari.instances.size() > 0) {
-            ANARIArray1D instances = anariNewArray1D(anari.device,anari.instances.data(),
-                                                     0,0,ANARI_INSTANCE,
-                                                     anari.instances.size());
+            ANARIArray1D instances = newObjectArray1D(anari.device,anari.instances.data(),
+                                                      ANARI_INSTANCE,anari.instances.size());
             anariSetParameter(anari.device,groupNode,"instance",ANARI_ARRAY1D,&instances);
             anariRelease(anari.device,instances);
         }
@@ -2934,7 +2953,7 @@ static void visitANARIWorld(ASGVisitor self, ASGObject obj, void* userData) {
 
                 ANARIArray1D vertexPosition = anariNewArray1D(anari->device,
                                                               geom->vertices,
-                                                              0,0,ANARI_FLOAT32_VEC3,
+                                                              keepBuffer,nullptr,ANARI_FLOAT32_VEC3,
                                                               geom->numVertices);
 
                 anariSetParameter(anari->device,geom->anariGeometry,"vertex.position",
@@ -2945,7 +2964,7 @@ static void visitANARIWorld(ASGVisitor self, ASGObject obj, void* userData) {
                 if (geom->indices != nullptr && geom->numIndices > 0) {
                     ANARIArray1D primitiveIndex = anariNewArray1D(anari->device,
                                                                   geom->indices,
-                                                                  0,0,
+                                                                  keepBuffer,nullptr,
                                                                   ANARI_UINT32_VEC3,
                                                                   geom->numIndices);
                     anariSetParameter(anari->device,geom->anariGeometry,
@@ -2969,28 +2988,37 @@ static void visitANARIWorld(ASGVisitor self, ASGObject obj, void* userData) {
 
                 ANARIArray1D vertexPosition = anariNewArray1D(anari->device,
                                                               geom->vertices,
-                                                              0,0,ANARI_FLOAT32_VEC3,
+                                                              keepBuffer,nullptr,ANARI_FLOAT32_VEC3,
                                                               geom->numVertices);
 
-                ANARIArray1D vertexRadius = anariNewArray1D(anari->device,
-                                                            geom->radii,
-                                                            0,0,ANARI_FLOAT32,
-                                                            geom->numVertices);
-
                 anariSetParameter(anari->device,geom->anariGeometry,"vertex.position",
                                   ANARI_ARRAY1D,&vertexPosition);
 
-                anariSetParameter(anari->device,geom->anariGeometry,"vertex.radius",
-                                  ANARI_ARRAY1D,&vertexRadius);
-
                 anariRelease(anari->device,vertexPosition);
-                anariRelease(anari->device,vertexRadius);
+
+                // Without per-vertex radii, all spheres use the default one
+                if (geom->radii != nullptr) {
+                    ANARIArray1D vertexRadius = anariNewArray1D(anari->device,
+                                                                geom->radii,
+                                                                keepBuffer,nullptr,ANARI_FLOAT32,
+                                                                geom->numVertices);
+
+                    anariSetParameter(anari->device,geom->anariGeometry,"vertex.radius",
+                                      ANARI_ARRAY1D,&vertexRadius);
+
+                    anariRelease(anari->device,vertexRadius);
+                } else {
+                    anariUnsetParameter(anari->device,geom->anariGeometry,"vertex.radius");
+                }
+
+                anariSetParameter(anari->device,geom->anariGeometry,"radius",
+                                  ANARI_FLOAT32,&geom->defaultRadius);
 
                 if (geom->vertexColors) {
                     // TODO: support all color types
                     ANARIArray1D vertexColor = anariNewArray1D(anari->device,
                                                                geom->vertexColors,
-                                                               0,0,ANARI_FLOAT32_VEC4,
+                                                               keepBuffer,nullptr,ANARI_FLOAT32_VEC4,
                                                                geom->numVertices);
 
                     anariSetParameter(anari->device,geom->anariGeometry,"vertex.color",
@@ -3002,8 +3030,8 @@ static void visitANARIWorld(ASGVisitor self, ASGObject obj, void* userData) {
                 if (geom->indices != nullptr && geom->numIndices > 0) {
                     ANARIArray1D primitiveIndex = anariNewArray1D(anari->device,
                                                                   geom->indices,
-                                                                  0,0,
-                                                                  ANARI_UINT32_VEC3,
+                                                                  keepBuffer,nullptr,
+                                                                  ANARI_UINT32,
                                                                   geom->numIndices);
                     anariSetParameter(anari->device,geom->anariGeometry,
                                       "primitive.index",
@@ -3026,28 +3054,40 @@ static void visitANARIWorld(ASGVisitor self, ASGObject obj, void* userData) {
 
                 ANARIArray1D vertexPosition = anariNewArray1D(anari->device,
                                                               geom->vertices,
-                                                              0,0,ANARI_FLOAT32_VEC3,
+                                                              keepBuffer,nullptr,ANARI_FLOAT32_VEC3,
                                                               geom->numVertices);
 
-                ANARIArray1D primitiveRadius = anariNewArray1D(anari->device,
-                                                               geom->radii,
-                                                               0,0,ANARI_FLOAT32,
-                                                               geom->numVertices);
-
                 anariSetParameter(anari->device,geom->anariGeometry,"vertex.position",
                                   ANARI_ARRAY1D,&vertexPosition);
 
-                anariSetParameter(anari->device,geom->anariGeometry,"primitive.radius",
-                                  ANARI_ARRAY1D,&primitiveRadius);
-
                 anariRelease(anari->device,vertexPosition);
-                anariRelease(anari->device,primitiveRadius);
+
+                // One radius per cylinder; without them, all use the default one
+                if (geom->radii != nullptr) {
+                    uint32_t numCylinders = geom->indices != nullptr && geom->numIndices > 0
+                        ? geom->numIndices : geom->numVertices/2;
+
+                    ANARIArray1D primitiveRadius = anariNewArray1D(anari->device,
+                                                                   geom->radii,
+                                                                   keepBuffer,nullptr,ANARI_FLOAT32,
+                                                                   numCylinders);
+
+                    anariSetParameter(anari->device,geom->anariGeometry,"primitive.radius",
+                                      ANARI_ARRAY1D,&primitiveRadius);
+
+                    anariRelease(anari->device,primitiveRadius);
+                } else {
+                    anariUnsetParameter(anari->device,geom->anariGeometry,"primitive.radius");
+                }
+
+                anariSetParameter(anari->device,geom->anariGeometry,"radius",
+                                  ANARI_FLOAT32,&geom->defaultRadius);
 
                 if (geom->vertexColors) {
                     // TODO: support all color types
                     ANARIArray1D vertexColor = anariNewArray1D(anari->device,
                                                                geom->vertexColors,
-                                                               0,0,ANARI_FLOAT32_VEC4,
+                                                               keepBuffer,nullptr,ANARI_FLOAT32_VEC4,
                                                                geom->numVertices);
 
                     anariSetParameter(anari->device,geom->anariGeometry,"vertex.color",
@@ -3059,8 +3099,8 @@ static void visitANARIWorld(ASGVisitor self, ASGObject obj, void* userData) {
                 if (geom->indices != nullptr && geom->numIndices > 0) {
                     ANARIArray1D primitiveIndex = anariNewArray1D(anari->device,
                                                                   geom->indices,
-                                                                  0,0,
-                                                                  ANARI_UINT32_VEC3,
+                                                                  keepBuffer,nullptr,
+                                                                  ANARI_UINT32_VEC2,
                                                                   geom->numIndices);
                     anariSetParameter(anari->device,geom->anariGeometry,
                                       "primitive.index",
@@ -3191,7 +3231,7 @@ static void visitANARIWorld(ASGVisitor self, ASGObject obj, void* userData) {
                 anariRelease(anari->device, vol->anariSpatialField);
 
                 ANARIArray3D scalar = anariNewArray3D(anari->device,vol->data,
-                                                      0,0,ANARI_FLOAT32,
+                                                      keepBuffer,nullptr,ANARI_FLOAT32,
                                                       volDims[0],volDims[1],volDims[2]);
 
                 vol->anariSpatialField = anariNewSpatialField(anari->device,
@@ -3231,8 +3271,8 @@ static void visitANARIWorld(ASGVisitor self, ASGObject obj, void* userData) {
                     asgLookupTable1DGetNumEntries(vol->lut1D, &numEntries);
                 }
 
-                ANARIArray1D anariColor = anariNewArray1D(anari->device, rgb, 0, 0, ANARI_FLOAT32_VEC3, numEntries);
-                ANARIArray1D anariOpacity = anariNewArray1D(anari->device, alpha, 0, 0, ANARI_FLOAT32, numEntries);
+                ANARIArray1D anariColor = anariNewArray1D(anari->device, rgb, keepBuffer, nullptr, ANARI_FLOAT32_VEC3, numEntries);
+                ANARIArray1D anariOpacity = anariNewArray1D(anari->device, alpha, keepBuffer, nullptr, ANARI_FLOAT32, numEntries);
 
                 anariSetParameter(anari->device, vol->anariVolume, "color", ANARI_ARRAY1D, &anariColor);
                 anariSetParameter(anari->device, vol->anariVolume, "opacity", ANARI_ARRAY1D, &anariOpacity);
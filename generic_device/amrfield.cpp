@@ -0,0 +1,116 @@
+#include <string.h>
+#include "amrfield.hpp"
+#include "array.hpp"
+#include "backend.hpp"
+#include "logging.hpp"
+#include "param.hpp"
+
+namespace generic {
+
+    AMRField::AMRField()
+        : SpatialField()
+    {
+    }
+
+    AMRField::~AMRField()
+    {
+        ReleaseResource(blockBounds);
+        ReleaseResource(blockLevel);
+        ReleaseResource(blockData);
+        ReleaseResource(cellWidth);
+    }
+
+    void AMRField::commit()
+    {
+        if (blockBounds == nullptr || blockLevel == nullptr || blockData == nullptr) {
+            LOG(logging::Level::Error) << "SpatialField.AMR error: "
+                << "block.bounds, block.level and block.data are required parameters";
+            return;
+        }
+
+        Array1D* bounds = (Array1D*)GetResource(blockBounds);
+        Array1D* level = (Array1D*)GetResource(blockLevel);
+        Array1D* data = (Array1D*)GetResource(blockData);
+
+        if (bounds->elementType != ANARI_INT32_BOX3 || level->elementType != ANARI_INT32
+         || data->elementType != ANARI_ARRAY3D) {
+            LOG(logging::Level::Error) << "SpatialField.AMR error: "
+                << "unsupported block.bounds, block.level or block.data element type";
+            return;
+        }
+
+        if (bounds->numItems[0] != level->numItems[0]
+         || bounds->numItems[0] != data->numItems[0]) {
+            LOG(logging::Level::Error) << "SpatialField.AMR error: "
+                << "block.bounds, block.level and block.data must have the same size";
+            return;
+        }
+
+        Array1D* width = (Array1D*)GetResource(cellWidth);
+        if (width != nullptr && width->elementType != ANARI_FLOAT32) {
+            LOG(logging::Level::Error) << "SpatialField.AMR error: "
+                << "cellWidth must be a FLOAT32 array";
+            return;
+        }
+
+        for (uint64_t i=0; i<level->numItems[0]; ++i) {
+            int32_t l;
+            memcpy(&l,level->internalData+i*level->getElementStride(),sizeof(l));
+            if (l < 0 || (width != nullptr && uint64_t(l) >= width->numItems[0])) {
+                LOG(logging::Level::Error) << "SpatialField.AMR error: "
+                    << "block.level[" << i << "] is negative or has no cellWidth entry";
+                return;
+            }
+        }
+
+        for (uint64_t i=0; i<data->numItems[0]; ++i) {
+            ANARIArray3D d;
+            memcpy(&d,data->internalData+i*data->getElementStride(),sizeof(d));
+            Array3D* brick = (Array3D*)GetResource(d);
+            if (brick == nullptr || brick->elementType != ANARI_FLOAT32) {
+                LOG(logging::Level::Error) << "SpatialField.AMR error: "
+                    << "block.data[" << i << "] must be a FLOAT32 Array3D";
+                return;
+            }
+        }
+
+        backend::commit(*this);
+    }
+
+    void AMRField::release()
+    {
+    }
+
+    void AMRField::retain()
+    {
+    }
+
+    static constexpr auto paramTable = sortParams({
+        GENERIC_PARAM(AMRFieldParams,"block.bounds",ANARI_ARRAY1D,blockBounds),
+        GENERIC_PARAM(AMRFieldParams,"block.level",ANARI_ARRAY1D,blockLevel),
+        GENERIC_PARAM(AMRFieldParams,"block.data",ANARI_ARRAY1D,blockData),
+        GENERIC_PARAM(AMRFieldParams,"cellWidth",ANARI_ARRAY1D,cellWidth),
+    });
+    static_assert(uniqueParamHashes(paramTable));
+
+    void AMRField::setParameter(const char* name,
+                                ANARIDataType type,
+                                const void* mem)
+    {
+        if (setParam(paramTable,static_cast<AMRFieldParams&>(*this),name,type,mem))
+            return;
+
+        LOG(logging::Level::Warning) << "AMRField: Unsupported parameter "
+            << "/ parameter type: " << name << " / " << type;
+    }
+
+    void AMRField::unsetParameter(const char* name)
+    {
+        if (unsetParam(paramTable,static_cast<AMRFieldParams&>(*this),name))
+            return;
+
+        LOG(logging::Level::Warning) << "AMRField: Unsupported parameter " << name;
+    }
+
+} // generic
+
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "spatialfield.hpp"
+
+namespace generic {
+
+    struct AMRFieldParams
+    {
+        ANARIArray1D blockBounds = nullptr;
+        ANARIArray1D blockLevel = nullptr;
+        ANARIArray1D blockData = nullptr;
+        ANARIArray1D cellWidth = nullptr;
+    };
+
+    // Block-structured AMR field; block bounds are given in the index
+    // space of the block's refinement level (cf. OpenVKL), level 0 being
+    // the coarsest level. cellWidth has one entry per level, 2^-L if unset
+    class AMRField : public SpatialField, public AMRFieldParams
+    {
+    public:
+        AMRField();
+       ~AMRField();
+
+        void commit();
+
+        void release();
+
+        void retain();
+
+        void setParameter(const char* name,
+                          ANARIDataType type,
+                          const void* mem);
+
+        void unsetParameter(const char* name);
+    };
+
+} // generic
+
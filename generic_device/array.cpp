@@ -1,10 +1,18 @@
 #include <string.h>
+#include <atomic>
+#include <new>
 #include <anari/anari_cpp.hpp>
 #include "array.hpp"
+#include "logging.hpp"
 #include <iostream>
 
 namespace generic {
 
+    enum { Alignment = 64 };
+
+    static std::atomic<size_t> allocatedBytes{0};
+    static std::atomic<size_t> copiedBytes{0};
+
     //--- ArrayStorage ------------------------------------
     ArrayStorage::ArrayStorage(const void* appMemory, ANARIMemoryDeleter deleter,
                                const void* userPtr, ANARIDataType elementType)
@@ -21,9 +29,16 @@ namespace generic {
 
     ArrayStorage::~ArrayStorage()
     {
-        if (appMemory == nullptr) {
+        for (ResourceHandle obj : objects) {
+            ReleaseResource(obj);
+        }
+
+        if (allocatedSize > 0) {
             // that means the array is managed, so we delete the data
-            delete[] internalData;
+            operator delete[](internalData,std::align_val_t(Alignment));
+            allocatedBytes -= allocatedSize;
+        } else if (appMemory != nullptr && deleter != nullptr) {
+            deleter(userPtr,appMemory);
         }
     }
 
@@ -33,13 +48,34 @@ namespace generic {
 
     void ArrayStorage::release()
     {
-        // Transfer ownership after user releases the object
-        if (appMemory != nullptr) {
-            internalData = new uint8_t[getSizeInBytes()];
-            memcpy(internalData,appMemory,getSizeInBytes());
+        if (appMemory == nullptr || allocatedSize > 0)
+            return;
+
+        // With a deleter, ownership was transferred on creation; the memory
+        // stays in place and is handed back to the application when the
+        // array is destroyed
+        if (deleter != nullptr)
+            return;
 
-            if (deleter != nullptr)
-                deleter(userPtr,appMemory);
+        // Shared memory may be reclaimed by the application right after
+        // release; copy only if the device still needs it, i.e. if other
+        // objects reference the array
+        if (refCount > 1) {
+            // Gathers strided elements, the copy is tightly packed
+            const uint8_t* src = internalData;
+            size_t stride = getElementStride();
+            size_t elementSize = anari::sizeOf(elementType);
+
+            allocate();
+            if (stride == elementSize) {
+                memcpy(internalData,src,getSizeInBytes());
+            } else {
+                for (size_t i=0; i<getNumElements(); ++i) {
+                    memcpy(internalData+i*elementSize,src+i*stride,elementSize);
+                }
+            }
+            byteStride = 0;
+            copiedBytes += getSizeInBytes();
         }
     }
 
@@ -47,6 +83,238 @@ namespace generic {
     {
     }
 
+    void ArrayStorage::retainObjects()
+    {
+        switch (elementType) {
+            case ANARI_OBJECT:
+            case ANARI_ARRAY:
+            case ANARI_ARRAY1D:
+            case ANARI_ARRAY2D:
+            case ANARI_ARRAY3D:
+            case ANARI_CAMERA:
+            case ANARI_FRAME:
+            case ANARI_GEOMETRY:
+            case ANARI_GROUP:
+            case ANARI_INSTANCE:
+            case ANARI_LIGHT:
+            case ANARI_MATERIAL:
+            case ANARI_RENDERER:
+            case ANARI_SAMPLER:
+            case ANARI_SPATIAL_FIELD:
+            case ANARI_SURFACE:
+            case ANARI_VOLUME:
+            case ANARI_WORLD:
+                break;
+            default:
+                return;
+        }
+
+        // Retain first, the new contents may overlap with the old ones
+        std::vector<ResourceHandle> newObjects(getNumElements());
+        for (size_t i=0; i<newObjects.size(); ++i) {
+            memcpy(&newObjects[i],internalData+i*getElementStride(),sizeof(ResourceHandle));
+        }
+
+        for (ResourceHandle obj : newObjects) {
+            RetainResource(obj);
+        }
+
+        for (ResourceHandle obj : objects) {
+            ReleaseResource(obj);
+        }
+
+        objects = std::move(newObjects);
+    }
+
+    size_t ArrayStorage::getElementStride() const
+    {
+        return byteStride != 0 ? byteStride : anari::sizeOf(elementType);
+    }
+
+    void ArrayStorage::setParameter(const char* name, ANARIDataType type, const void* mem)
+    {
+        if (strcmp(name,"byteStride")==0 && type==ANARI_UINT64 && allocatedSize == 0) {
+            memcpy(&byteStride,mem,sizeof(byteStride));
+        } else {
+            LOG(logging::Level::Warning) << "Array: Unsupported parameter "
+                << "/ parameter type: " << name << " / " << type
+                << " (byteStride only applies to arrays on application memory)";
+        }
+    }
+
+    void ArrayStorage::unsetParameter(const char* name)
+    {
+        if (strcmp(name,"byteStride")==0) {
+            byteStride = 0;
+        } else {
+            LOG(logging::Level::Warning) << "Array: Unsupported parameter " << name;
+        }
+    }
+
+    // Scalar type and component count of vector types that can be converted
+    struct VectorType
+    {
+        ANARIDataType type;
+        ANARIDataType scalar;
+        int numComponents;
+    };
+
+    static const VectorType vectorTypes[] = {
+        { ANARI_FLOAT32,      ANARI_FLOAT32, 1 },
+        { ANARI_FLOAT32_VEC2, ANARI_FLOAT32, 2 },
+        { ANARI_FLOAT32_VEC3, ANARI_FLOAT32, 3 },
+        { ANARI_FLOAT32_VEC4, ANARI_FLOAT32, 4 },
+        { ANARI_FLOAT64,      ANARI_FLOAT64, 1 },
+        { ANARI_FLOAT64_VEC2, ANARI_FLOAT64, 2 },
+        { ANARI_FLOAT64_VEC3, ANARI_FLOAT64, 3 },
+        { ANARI_FLOAT64_VEC4, ANARI_FLOAT64, 4 },
+        { ANARI_UINT8,        ANARI_UINT8,   1 },
+        { ANARI_UINT8_VEC2,   ANARI_UINT8,   2 },
+        { ANARI_UINT8_VEC3,   ANARI_UINT8,   3 },
+        { ANARI_UINT8_VEC4,   ANARI_UINT8,   4 },
+        { ANARI_UINT16,       ANARI_UINT16,  1 },
+        { ANARI_UINT16_VEC2,  ANARI_UINT16,  2 },
+        { ANARI_UINT16_VEC3,  ANARI_UINT16,  3 },
+        { ANARI_UINT16_VEC4,  ANARI_UINT16,  4 },
+        { ANARI_UINT32,       ANARI_UINT32,  1 },
+        { ANARI_UINT32_VEC2,  ANARI_UINT32,  2 },
+        { ANARI_UINT32_VEC3,  ANARI_UINT32,  3 },
+        { ANARI_UINT32_VEC4,  ANARI_UINT32,  4 },
+        { ANARI_UINT64,       ANARI_UINT64,  1 },
+        { ANARI_UINT64_VEC2,  ANARI_UINT64,  2 },
+        { ANARI_UINT64_VEC3,  ANARI_UINT64,  3 },
+        { ANARI_UINT64_VEC4,  ANARI_UINT64,  4 },
+        { ANARI_INT32,        ANARI_INT32,   1 },
+        { ANARI_INT32_VEC2,   ANARI_INT32,   2 },
+        { ANARI_INT32_VEC3,   ANARI_INT32,   3 },
+        { ANARI_INT32_VEC4,   ANARI_INT32,   4 },
+    };
+
+    static const VectorType* findVectorType(ANARIDataType type)
+    {
+        for (const VectorType& vt : vectorTypes) {
+            if (vt.type == type)
+                return &vt;
+        }
+        return nullptr;
+    }
+
+    template <typename Src, typename Dst>
+    static void convertElements(const uint8_t* src, size_t stride, size_t numElements,
+                                int numComponents, Dst* dst)
+    {
+        if (stride == numComponents*sizeof(Src)) {
+            // Tightly packed, a single flat loop that vectorizes
+            const Src* s = (const Src*)src;
+            size_t n = numElements*numComponents;
+            for (size_t i=0; i<n; ++i) {
+                dst[i] = (Dst)s[i];
+            }
+        } else {
+            // Strided, e.g. one attribute of an interleaved buffer (AoS to SoA)
+            for (size_t i=0; i<numElements; ++i) {
+                const Src* s = (const Src*)(src+i*stride);
+                for (int c=0; c<numComponents; ++c) {
+                    dst[i*numComponents+c] = (Dst)s[c];
+                }
+            }
+        }
+    }
+
+    template <typename Dst>
+    static bool convertElements(ANARIDataType srcScalar, const uint8_t* src, size_t stride,
+                                size_t numElements, int numComponents, Dst* dst)
+    {
+        switch (srcScalar) {
+            case ANARI_FLOAT32:
+                convertElements<float>(src,stride,numElements,numComponents,dst);
+                return true;
+            case ANARI_FLOAT64:
+                convertElements<double>(src,stride,numElements,numComponents,dst);
+                return true;
+            case ANARI_UINT8:
+                convertElements<uint8_t>(src,stride,numElements,numComponents,dst);
+                return true;
+            case ANARI_UINT16:
+                convertElements<uint16_t>(src,stride,numElements,numComponents,dst);
+                return true;
+            case ANARI_UINT32:
+                convertElements<uint32_t>(src,stride,numElements,numComponents,dst);
+                return true;
+            case ANARI_UINT64:
+                convertElements<uint64_t>(src,stride,numElements,numComponents,dst);
+                return true;
+            case ANARI_INT32:
+                convertElements<int32_t>(src,stride,numElements,numComponents,dst);
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    bool ArrayStorage::convertibleTo(ANARIDataType type) const
+    {
+        if (type == elementType)
+            return true;
+
+        const VectorType* src = findVectorType(elementType);
+        const VectorType* dst = findVectorType(type);
+
+        return src != nullptr && dst != nullptr
+            && src->numComponents == dst->numComponents
+            && (dst->scalar == ANARI_FLOAT32 || dst->scalar == ANARI_UINT32);
+    }
+
+    bool ArrayStorage::convert(ANARIDataType type, void* dst) const
+    {
+        if (!convertibleTo(type))
+            return false;
+
+        size_t stride = getElementStride();
+
+        if (type == elementType) {
+            size_t elementSize = anari::sizeOf(elementType);
+            for (size_t i=0; i<getNumElements(); ++i) {
+                memcpy((uint8_t*)dst+i*elementSize,internalData+i*stride,elementSize);
+            }
+            return true;
+        }
+
+        const VectorType* src = findVectorType(elementType);
+        const VectorType* vt = findVectorType(type);
+
+        if (vt->scalar == ANARI_FLOAT32) {
+            return convertElements(src->scalar,internalData,stride,getNumElements(),
+                                   vt->numComponents,(float*)dst);
+        } else {
+            return convertElements(src->scalar,internalData,stride,getNumElements(),
+                                   vt->numComponents,(uint32_t*)dst);
+        }
+    }
+
+    size_t ArrayStorage::getAllocatedBytes()
+    {
+        return allocatedBytes;
+    }
+
+    size_t ArrayStorage::getCopiedBytes()
+    {
+        return copiedBytes;
+    }
+
+    bool ArrayStorage::isDataStable() const
+    {
+        return appMemory == nullptr || allocatedSize > 0 || deleter != nullptr;
+    }
+
+    void ArrayStorage::allocate()
+    {
+        // Cache line aligned, so mapped arrays can be filled with SIMD stores
+        allocatedSize = getSizeInBytes();
+        internalData = new (std::align_val_t(Alignment)) uint8_t[allocatedSize];
+        allocatedBytes += allocatedSize;
+    }
+
     //--- Array1D -----------------------------------------
     Array1D::Array1D(const void* appMemory, ANARIMemoryDeleter deleter,
           const void* userPtr, ANARIDataType elementType, uint64_t numItems1)
@@ -56,7 +324,9 @@ namespace generic {
         numItems[0] = numItems1;
 
         if (internalData == nullptr)
-            internalData = new uint8_t[getSizeInBytes()];
+            allocate();
+        else
+            retainObjects();
     }
 
     Array1D::~Array1D()
@@ -73,6 +343,11 @@ namespace generic {
         return numItems[0]*anari::sizeOf(elementType);
     }
 
+    size_t Array1D::getNumElements() const
+    {
+        return numItems[0];
+    }
+
     //--- Array2D -----------------------------------------
     Array2D::Array2D(const void* appMemory, ANARIMemoryDeleter deleter,
           const void* userPtr, ANARIDataType elementType,uint64_t numItems1,
@@ -84,7 +359,9 @@ namespace generic {
         numItems[1] = numItems2;
 
         if (internalData == nullptr)
-            internalData = new uint8_t[getSizeInBytes()];
+            allocate();
+        else
+            retainObjects();
     }
 
     Array2D::~Array2D()
@@ -101,6 +378,11 @@ namespace generic {
         return numItems[0]*numItems[1]*anari::sizeOf(elementType);
     }
 
+    size_t Array2D::getNumElements() const
+    {
+        return numItems[0]*numItems[1];
+    }
+
     //--- Array3D -----------------------------------------
     Array3D::Array3D(const void* appMemory, ANARIMemoryDeleter deleter,
           const void* userPtr, ANARIDataType elementType, uint64_t numItems1,
@@ -113,7 +395,9 @@ namespace generic {
         numItems[2] = numItems3;
 
         if (internalData == nullptr)
-            internalData = new uint8_t[getSizeInBytes()];
+            allocate();
+        else
+            retainObjects();
     }
 
     Array3D::~Array3D()
@@ -130,6 +414,11 @@ namespace generic {
         return numItems[0]*numItems[1]*numItems[2]*anari::sizeOf(elementType);
     }
 
+    size_t Array3D::getNumElements() const
+    {
+        return numItems[0]*numItems[1]*numItems[2];
+    }
+
 } // generic
 
 
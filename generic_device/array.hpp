@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <vector>
 #include "object.hpp"
 #include "resource.hpp"
 
@@ -24,11 +25,49 @@ namespace generic {
 
         virtual size_t getSizeInBytes() const = 0;
 
+        virtual size_t getNumElements() const = 0;
+
+        // Distance between elements in bytes, the element size unless the
+        // array views a single attribute of an interleaved buffer
+        size_t getElementStride() const;
+
+        // Array parameters; "byteStride" (UINT64, 0 means tightly packed)
+        void setParameter(const char* name, ANARIDataType type, const void* mem);
+        void unsetParameter(const char* name);
+
+        // Convert the elements to a tightly packed array of the given type,
+        // e.g. FLOAT64_VEC3 to FLOAT32_VEC3 or UINT16_VEC3 to UINT32_VEC3;
+        // the component count must match
+        bool convertibleTo(ANARIDataType type) const;
+        bool convert(ANARIDataType type, void* dst) const;
+
+        // Arrays of objects hold a reference to each of their elements;
+        // call when the array contents were (re)specified
+        void retainObjects();
+
+        // Bytes of array data allocated by the device
+        static size_t getAllocatedBytes();
+
+        // Bytes copied from application memory so far
+        static size_t getCopiedBytes();
+
+        // True if internalData stays valid and in place until the array is
+        // destroyed, i.e. release() never replaces it with a copy
+        bool isDataStable() const;
+
         const void* appMemory = nullptr;
         ANARIMemoryDeleter deleter = nullptr;
         const void* userPtr = nullptr; // additional pointer, can be passed to deleter
         uint8_t* internalData;
         ANARIDataType elementType;
+        uint64_t byteStride = 0;
+
+    protected:
+        void allocate();
+
+    private:
+        size_t allocatedSize = 0;
+        std::vector<ResourceHandle> objects;
     };
 
     class Array1D : public ArrayStorage
@@ -42,6 +81,8 @@ namespace generic {
 
         uint64_t numItems[1] = {1};
 
+        size_t getNumElements() const;
+
     private:
         size_t getSizeInBytes() const;
 
@@ -60,6 +101,8 @@ namespace generic {
 
         uint64_t numItems[2] = {1,1};
 
+        size_t getNumElements() const;
+
     private:
         size_t getSizeInBytes() const;
 
@@ -79,6 +122,8 @@ namespace generic {
 
         uint64_t numItems[3] = {1,1,1};
 
+        size_t getNumElements() const;
+
     private:
         size_t getSizeInBytes() const;
 
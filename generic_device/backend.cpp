@@ -5,17 +5,25 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstring>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <mutex>
+#include <shared_mutex>
 #include <thread>
+#include <type_traits>
+#include <utility>
 #include <visionaray/math/math.h>
 #include <visionaray/area_light.h>
 #include <visionaray/bvh.h>
 #include <visionaray/texture/texture.h>
 #include <visionaray/aligned_vector.h>
 #include <visionaray/cpu_buffer_rt.h>
+#include <visionaray/detail/parallel_for.h>
 #include <visionaray/generic_light.h>
 #include <visionaray/generic_material.h>
 #include <visionaray/kernels.h>
@@ -39,6 +47,202 @@ namespace generic {
     namespace backend {
         enum class Algorithm { Pathtracing, AmbientOcclusion, };
 
+        // Array elements as tightly packed T; converted (and gathered if
+        // strided) into scratch unless the array already stores exactly that
+        template <typename T>
+        static const T* getArrayData(const ArrayStorage* arr, ANARIDataType type,
+                                     aligned_vector<T>& scratch)
+        {
+            if (arr->elementType == type && arr->getElementStride() == sizeof(T))
+                return (const T*)arr->internalData;
+
+            scratch.resize(arr->getNumElements());
+            if (!arr->convert(type,scratch.data()))
+                return nullptr;
+
+            return scratch.data();
+        }
+
+        // The i'th element of an array, e.g. an object handle, respecting
+        // the element stride
+        template <typename T>
+        static T getArrayElement(const ArrayStorage* arr, size_t i)
+        {
+            T t;
+            memcpy(&t,arr->internalData+i*arr->getElementStride(),sizeof(T));
+            return t;
+        }
+
+        // Copy of an object's parameters and handle, taken when commit() is
+        // called; commits are flushed later, possibly while application
+        // threads already set the next parameters on the same object
+        template <typename... Params>
+        struct Snapshot : Params...
+        {
+            template <typename Obj>
+            explicit Snapshot(Obj& obj)
+                : Params(static_cast<const Params&>(obj))...
+                , handle(obj.getResourceHandle())
+            {
+            }
+
+            ResourceHandle getResourceHandle() const
+            {
+                return handle;
+            }
+
+            ResourceHandle handle = nullptr;
+        };
+
+        // Auxiliary channels, filled from the first hit by the render kernels
+        enum AOV
+        {
+            AOVNormal      = 0x1,
+            AOVAlbedo      = 0x2,
+            AOVPrimitiveID = 0x4,
+            AOVObjectID    = 0x8,
+            AOVInstanceID  = 0x10,
+        };
+
+        // Raw pointers to the auxiliary channels of a frame, null if not
+        // requested; passed by value into the kernels
+        // First interaction of a single sample
+        struct AOVSample
+        {
+            void firstHit(float t, const vec3f& n,
+                          unsigned primID, unsigned objID, unsigned instID)
+            {
+                depth = t;
+                normal = n;
+                primitiveID = primID;
+                objectID = objID;
+                instanceID = instID;
+            }
+
+            void firstAlbedo(const vec3f& a)
+            {
+                albedo = a;
+            }
+
+            float depth = std::numeric_limits<float>::infinity();
+            vec3f normal{0.f,0.f,0.f};
+            vec3f albedo{0.f,0.f,0.f};
+            unsigned primitiveID = ~0u;
+            unsigned objectID = ~0u;
+            unsigned instanceID = ~0u;
+        };
+
+        struct FrameAOVs
+        {
+            // The denoiser guides (depth, normal, albedo) are blended with
+            // the same factor as the color, so that they match the mean
+            // over the jittered samples; the IDs are the last sample's
+            void write(size_t pixel, const AOVSample& s) const
+            {
+                if (depth != nullptr) {
+                    // Misses are infinitely far away; only the depths of
+                    // hits are blended, so that a pixel never turns NaN
+                    float& d = depth[pixel];
+                    if (blend >= 1.f || !std::isfinite(d) || !std::isfinite(s.depth))
+                        d = blend >= 1.f ? s.depth : fminf(d,s.depth);
+                    else
+                        d += (s.depth-d)*blend;
+                }
+
+                if (normal != nullptr)
+                    normal[pixel] = blend >= 1.f ? s.normal : lerp(normal[pixel],s.normal,blend);
+
+                if (albedo != nullptr)
+                    albedo[pixel] = blend >= 1.f ? s.albedo : lerp(albedo[pixel],s.albedo,blend);
+
+                if (primitiveID != nullptr)
+                    primitiveID[pixel] = s.primitiveID;
+
+                if (objectID != nullptr)
+                    objectID[pixel] = s.objectID;
+
+                if (instanceID != nullptr)
+                    instanceID[pixel] = s.instanceID;
+            }
+
+            float blend = 1.f; // weight of the current frame
+            int width = 0;
+            float* depth = nullptr;
+            vec3f* normal = nullptr;
+            vec3f* albedo = nullptr;
+            uint32_t* primitiveID = nullptr;
+            uint32_t* objectID = nullptr;
+            uint32_t* instanceID = nullptr;
+        };
+
+        // IEEE 754 binary16, rounded to nearest even; overflows to infinity
+        inline uint16_t floatToHalf(float f)
+        {
+            uint32_t x;
+            memcpy(&x,&f,sizeof(x));
+
+            uint32_t sign = (x>>16) & 0x8000;
+            uint32_t absx = x & 0x7fffffff;
+
+            if (absx >= 0x7f800000) // inf or nan
+                return sign | 0x7c00 | (absx > 0x7f800000 ? 0x200 : 0);
+
+            if (absx >= 0x477ff000) // rounds to more than 65504
+                return sign | 0x7c00;
+
+            if (absx < 0x38800000) { // subnormal half
+                if (absx < 0x33000000)
+                    return sign;
+
+                uint32_t e = absx>>23;
+                uint32_t m = (absx & 0x7fffff) | 0x800000;
+                uint32_t shift = 126-e;
+                uint32_t h = m>>shift;
+                uint32_t rem = m & ((1u<<shift)-1);
+                uint32_t halfway = 1u<<(shift-1);
+                if (rem > halfway || (rem == halfway && (h & 1)))
+                    ++h;
+                return sign | h;
+            }
+
+            uint32_t h = (absx-0x38000000)>>13;
+            uint32_t rem = absx & 0x1fff;
+            if (rem > 0x1000 || (rem == 0x1000 && (h & 1)))
+                ++h;
+            return sign | h;
+        }
+
+        // Tone mapping operators for 8-bit color output
+        enum class Tonemap { None, ACES, ACESApprox, };
+
+        // https://github.com/TheRealMJP/BakingLab/blob/master/BakingLab/ACES.hlsl
+        inline vec3f acesFitted(vec3f v)
+        {
+            const mat3 inputMatrix = transpose(mat3{
+                {0.59719f, 0.35458f, 0.04823f},
+                {0.07600f, 0.90834f, 0.01566f},
+                {0.02840f, 0.13383f, 0.83777f}
+            });
+
+            const mat3 outputMatrix = transpose(mat3{
+                { 1.60475f, -0.53108f, -0.07367f},
+                {-0.10208f,  1.10813f, -0.00605f},
+                {-0.00327f, -0.07276f,  1.07602f}
+            });
+
+            v = inputMatrix * v;
+            vec3f a = v * (v + 0.0245786f) - 0.000090537f;
+            vec3f b = v * (0.983729f * v + 0.4329510f) + 0.238081f;
+            return outputMatrix * (a / b);
+        }
+
+        // https://knarkowicz.wordpress.com/2016/01/06/aces-filmic-tone-mapping-curve/
+        inline vec3f acesApprox(vec3f v)
+        {
+            v *= 0.6f;
+            return (v*(2.51f*v+0.03f))/(v*(2.43f*v+0.59f)+0.14f);
+        }
+
         struct Frame : render_target
         {
             using SP = std::shared_ptr<Frame>;
@@ -59,19 +263,41 @@ namespace generic {
             {
                 accumBuffer.end_frame();
 
+                const vec4f* color = accumBuffer.color();
+
+                if (denoising) {
+                    denoise();
+                    color = denoiseBuffer.data();
+                }
+
                 parallel_for(pool,tiled_range2d<int>(0,width(),64,0,height(),64),
                     [&](range2d<int> r) {
                         for (int y=r.cols().begin(); y!=r.cols().end(); ++y) {
                             for (int x=r.rows().begin(); x!=r.rows().end(); ++x) {
-                                 vec4f src = accumBuffer.color()[y*width()+x];
-
-                                if (1) {
+                                 vec4f src = color[y*width()+x];
+
+                                if (colorType == ANARI_FLOAT32_VEC4) {
+                                    ((vec4f*)colorPtr)[y*width()+x] = src;
+                                } else if (colorType == ANARI_FLOAT16_VEC4) {
+                                    uint16_t* dst = (uint16_t*)colorPtr + (y*width()+x)*4;
+                                    dst[0] = floatToHalf(src.x);
+                                    dst[1] = floatToHalf(src.y);
+                                    dst[2] = floatToHalf(src.z);
+                                    dst[3] = floatToHalf(src.w);
+                                } else {
 #if DEBUGGING
                                     if (x==width()/2 || y==height()/2)
                                         src.xyz() = vec3f(1.f)-src.xyz();
 #endif
 
-                                    src.xyz() = linear_to_srgb(src.xyz());
+                                    if (tonemap == Tonemap::ACES)
+                                        src.xyz() = acesFitted(src.xyz());
+                                    else if (tonemap == Tonemap::ACESApprox)
+                                        src.xyz() = acesApprox(src.xyz());
+
+                                    if (colorType == ANARI_UFIXED8_RGBA_SRGB)
+                                        src.xyz() = linear_to_srgb(clamp(src.xyz(),vec3f(0.f),vec3f(1.f)));
+
                                     int32_t r = clamp(int32_t(src.x*256.f),0,255);
                                     int32_t g = clamp(int32_t(src.y*256.f),0,255);
                                     int32_t b = clamp(int32_t(src.z*256.f),0,255);
@@ -85,36 +311,271 @@ namespace generic {
                     });
             }
 
+            // Edge-avoiding a-trous wavelet filter (Dammertz et al. 2010)
+            // over the accumulated color, guided by the first-hit normal,
+            // albedo and depth channels, which are accumulated alike. The albedo is divided out before
+            // filtering so that texture detail is not blurred; the
+            // accumulation buffer itself is left untouched
+            void denoise()
+            {
+                FrameAOVs guide = aovs();
+                if (guide.depth == nullptr || guide.normal == nullptr || guide.albedo == nullptr)
+                    return;
+
+                int w = width();
+                int h = height();
+                size_t numPixels = size_t(w)*h;
+
+                denoiseBuffer.resize(numPixels);
+                denoiseScratch.resize(numPixels);
+
+                const vec4f* color = accumBuffer.color();
+
+                parallel_for(pool,tiled_range2d<int>(0,w,64,0,h,64),
+                    [&](range2d<int> r) {
+                        for (int y=r.cols().begin(); y!=r.cols().end(); ++y) {
+                            for (int x=r.rows().begin(); x!=r.rows().end(); ++x) {
+                                size_t i = size_t(y)*w+x;
+                                vec3f albedo = max(guide.albedo[i],vec3f(1e-3f));
+                                denoiseBuffer[i] = vec4f(color[i].xyz()/albedo,color[i].w);
+                            }
+                        }
+                    });
+
+                // B3 spline taps, indexed by the distance from the center
+                const float taps[3] = { 3.f/8.f, 1.f/4.f, 1.f/16.f };
+
+                float sigmaColor = 1.f;
+                const int normalExpLog2 = 7; // cos^128
+                const float sigmaDepth = .05f; // relative to the center depth
+
+                // Taps are weighted for four consecutive pixels of a row at
+                // once; the channels are stored AoS, so pixels are loaded
+                // lane by lane. Lanes are clamped to the image, their
+                // weights are masked out later
+                struct Pixel4
+                {
+                    simd::float4 r, g, b, a;
+                    simd::float4 nx, ny, nz;
+                    simd::float4 z;
+                };
+
+                auto load4 = [&](const vec4f* src, int x, int y) {
+                    VSNRAY_ALIGN(16) float v[8][4];
+                    for (int k=0; k<4; ++k) {
+                        size_t j = size_t(y)*w+std::min(std::max(x+k,0),w-1);
+                        v[0][k] = src[j].x;
+                        v[1][k] = src[j].y;
+                        v[2][k] = src[j].z;
+                        v[3][k] = src[j].w;
+                        v[4][k] = guide.normal[j].x;
+                        v[5][k] = guide.normal[j].y;
+                        v[6][k] = guide.normal[j].z;
+                        v[7][k] = guide.depth[j];
+                    }
+                    return Pixel4{simd::float4(v[0]),simd::float4(v[1]),
+                                  simd::float4(v[2]),simd::float4(v[3]),
+                                  simd::float4(v[4]),simd::float4(v[5]),
+                                  simd::float4(v[6]),simd::float4(v[7])};
+                };
+
+                const simd::float4 zero(0.f), one(1.f);
+                const simd::float4 inf(std::numeric_limits<float>::infinity());
+                const simd::float4 lanes(0.f,1.f,2.f,3.f);
+
+                for (int iter=0; iter<NumDenoiseIterations; ++iter) {
+                    int step = 1<<iter;
+                    const vec4f* src = denoiseBuffer.data();
+                    vec4f* dst = denoiseScratch.data();
+                    simd::float4 invSigmaColor2(1.f/(sigmaColor*sigmaColor));
+
+                    parallel_for(pool,tiled_range2d<int>(0,w,64,0,h,64),
+                        [&](range2d<int> r) {
+                            for (int y=r.cols().begin(); y!=r.cols().end(); ++y) {
+                                for (int x=r.rows().begin(); x<r.rows().end(); x+=4) {
+                                    Pixel4 p0 = load4(src,x,y);
+                                    simd::float4 hasNormal0 = select(p0.nx*p0.nx+p0.ny*p0.ny+p0.nz*p0.nz > zero,one,zero);
+                                    simd::float4 hasDepth0 = select(p0.z < inf,one,zero);
+                                    simd::float4 invDepthScale = one/(simd::float4(sigmaDepth*step)*p0.z+simd::float4(1e-6f));
+
+                                    simd::float4 sumR(0.f), sumG(0.f), sumB(0.f), sumA(0.f);
+                                    simd::float4 weightSum(0.f);
+
+                                    for (int dy=-2; dy<=2; ++dy) {
+                                        int yy = y+dy*step;
+                                        if (yy < 0 || yy >= h)
+                                            continue;
+
+                                        for (int dx=-2; dx<=2; ++dx) {
+                                            int xx = x+dx*step;
+                                            Pixel4 p = load4(src,xx,yy);
+
+                                            simd::float4 lx = simd::float4((float)xx)+lanes;
+                                            simd::mask4 inside = (lx >= zero) & (lx < simd::float4((float)w));
+
+                                            // Never mix hits with misses
+                                            simd::float4 hasNormal = select(p.nx*p.nx+p.ny*p.ny+p.nz*p.nz > zero,one,zero);
+                                            simd::float4 hasDepth = select(p.z < inf,one,zero);
+                                            simd::mask4 valid = inside & (hasNormal == hasNormal0)
+                                                                       & (hasDepth == hasDepth0);
+
+                                            simd::float4 dr = p.r-p0.r, dg = p.g-p0.g, db = p.b-p0.b;
+                                            simd::float4 arg = -(dr*dr+dg*dg+db*db)*invSigmaColor2;
+                                            arg = arg-select(hasDepth0 > zero,abs(p0.z-p.z)*invDepthScale,zero);
+
+                                            simd::float4 cosine = max(zero,p0.nx*p.nx+p0.ny*p.ny+p0.nz*p.nz);
+                                            for (int k=0; k<normalExpLog2; ++k) {
+                                                cosine = cosine*cosine;
+                                            }
+
+                                            simd::float4 weight = simd::float4(taps[abs(dx)]*taps[abs(dy)])
+                                                                * exp(max(arg,simd::float4(-80.f)))
+                                                                * select(hasNormal0 > zero,cosine,one);
+                                            weight = select(valid,weight,zero);
+
+                                            sumR = sumR+p.r*weight;
+                                            sumG = sumG+p.g*weight;
+                                            sumB = sumB+p.b*weight;
+                                            sumA = sumA+p.a*weight;
+                                            weightSum = weightSum+weight;
+                                        }
+                                    }
+
+                                    simd::mask4 filtered = weightSum > zero;
+                                    simd::float4 invWeightSum = one/select(filtered,weightSum,one);
+
+                                    VSNRAY_ALIGN(16) float out[4][4];
+                                    store(out[0],select(filtered,sumR*invWeightSum,p0.r));
+                                    store(out[1],select(filtered,sumG*invWeightSum,p0.g));
+                                    store(out[2],select(filtered,sumB*invWeightSum,p0.b));
+                                    store(out[3],select(filtered,sumA*invWeightSum,p0.a));
+
+                                    for (int k=0; k<4 && x+k<r.rows().end(); ++k) {
+                                        dst[size_t(y)*w+x+k] = vec4f(out[0][k],out[1][k],out[2][k],out[3][k]);
+                                    }
+                                }
+                            }
+                        });
+
+                    std::swap(denoiseBuffer,denoiseScratch);
+
+                    // Finer color differences are tolerated at coarser scales
+                    sigmaColor *= .5f;
+                }
+
+                parallel_for(pool,tiled_range1d<size_t>(0,numPixels,4096),
+                    [&](range1d<size_t> r) {
+                        for (size_t i=r.begin(); i!=r.end(); ++i) {
+                            vec3f albedo = max(guide.albedo[i],vec3f(1e-3f));
+                            denoiseBuffer[i].xyz() *= albedo;
+                        }
+                    });
+            }
+
             void resize(int w, int h)
             {
                 render_target::resize(w,h);
                 accumBuffer.resize(w,h);
             }
 
-            void reset(int width, int height, pixel_format color, pixel_format depth, bool srgb)
+            // color is one of the ANARI color channel types, anything
+            // unsupported falls back to UFIXED8_VEC4
+            void reset(int width, int height, ANARIDataType color, pixel_format depth,
+                       Tonemap tm, unsigned aovMask)
             {
                 resize(width,height);
 
-                if (color==PF_RGBA8 && depth==PF_UNSPECIFIED) { // TODO: use anari types!
-                    colorPtr = new uint32_t[width*height]; // TODO: delete!!!
-                } else if (color==PF_RGBA8 && depth==PF_DEPTH32F) {
-                    colorPtr = new uint32_t[width*height];
-                    depthPtr = new float[width*height];
-                } else if (color==PF_RGBA32F && depth==PF_UNSPECIFIED) {
-                    colorPtr = new vec4f[width*height];
-                } else if (color==PF_RGBA32F && depth==PF_DEPTH32F) {
-                    colorPtr = new vec4f[width*height];
-                    depthPtr = new float[width*height];
-                }
+                if (color != ANARI_FLOAT32_VEC4 && color != ANARI_FLOAT16_VEC4
+                 && color != ANARI_UFIXED8_RGBA_SRGB)
+                    color = ANARI_UFIXED8_VEC4;
+
+                size_t numPixels = size_t(width)*height;
+                size_t colorSize = color==ANARI_FLOAT32_VEC4 ? sizeof(vec4f)
+                                 : color==ANARI_FLOAT16_VEC4 ? sizeof(uint16_t)*4
+                                 : sizeof(uint32_t);
+                size_t depthSize = depth==PF_DEPTH32F ? sizeof(float) : 0;
+
+                // Assign fresh vectors so that shrinking frees the memory, too
+                colorBuffer = aligned_vector<uint8_t>(numPixels*colorSize);
+                depthBuffer = aligned_vector<uint8_t>(numPixels*depthSize);
+
+                colorPtr = colorBuffer.data();
+                depthPtr = depthBuffer.empty() ? nullptr : depthBuffer.data();
+
+                normalBuffer = aligned_vector<vec3f>(aovMask & AOVNormal ? numPixels : 0);
+                albedoBuffer = aligned_vector<vec3f>(aovMask & AOVAlbedo ? numPixels : 0);
+                primitiveIDBuffer = aligned_vector<uint32_t>(aovMask & AOVPrimitiveID ? numPixels : 0);
+                objectIDBuffer = aligned_vector<uint32_t>(aovMask & AOVObjectID ? numPixels : 0);
+                instanceIDBuffer = aligned_vector<uint32_t>(aovMask & AOVInstanceID ? numPixels : 0);
+
+                colorType = color;
+                tonemap = tm;
+            }
+
+            FrameAOVs aovs()
+            {
+                FrameAOVs result;
+                result.width = width();
+                result.depth = (float*)depthPtr;
+                result.normal = normalBuffer.empty() ? nullptr : normalBuffer.data();
+                result.albedo = albedoBuffer.empty() ? nullptr : albedoBuffer.data();
+                result.primitiveID = primitiveIDBuffer.empty() ? nullptr : primitiveIDBuffer.data();
+                result.objectID = objectIDBuffer.empty() ? nullptr : objectIDBuffer.data();
+                result.instanceID = instanceIDBuffer.empty() ? nullptr : instanceIDBuffer.data();
+                return result;
+            }
+
+            // Mapped pointer of an ANARI frame channel, or null
+            void* channelPtr(const char* channel)
+            {
+                if (strcmp(channel,"channel.color")==0)
+                    return colorPtr;
+                else if (strcmp(channel,"channel.depth")==0)
+                    return depthPtr;
+                else if (strcmp(channel,"channel.normal")==0)
+                    return normalBuffer.empty() ? nullptr : normalBuffer.data();
+                else if (strcmp(channel,"channel.albedo")==0)
+                    return albedoBuffer.empty() ? nullptr : albedoBuffer.data();
+                else if (strcmp(channel,"channel.primitiveId")==0)
+                    return primitiveIDBuffer.empty() ? nullptr : primitiveIDBuffer.data();
+                else if (strcmp(channel,"channel.objectId")==0)
+                    return objectIDBuffer.empty() ? nullptr : objectIDBuffer.data();
+                else if (strcmp(channel,"channel.instanceId")==0)
+                    return instanceIDBuffer.empty() ? nullptr : instanceIDBuffer.data();
+
+                return nullptr;
+            }
 
-                sRGB = srgb;
+            size_t getSizeInBytes() const
+            {
+                return colorBuffer.size()+depthBuffer.size()
+                     + (normalBuffer.size()+albedoBuffer.size())*sizeof(vec3f)
+                     + (primitiveIDBuffer.size()+objectIDBuffer.size()+instanceIDBuffer.size())*sizeof(uint32_t)
+                     + (denoiseBuffer.size()+denoiseScratch.size())*sizeof(vec4f)
+                     + size_t(width())*height()*(sizeof(vec4f)*2+sizeof(float));
             }
 
             thread_pool pool{std::thread::hardware_concurrency()};
 
             cpu_buffer_rt<PF_RGBA32F, PF_DEPTH32F, PF_RGBA32F> accumBuffer;
 
-            bool sRGB = false;
+            ANARIDataType colorType = ANARI_UFIXED8_VEC4;
+
+            // Only applied to 8-bit output, float output stays linear
+            Tonemap tonemap = Tonemap::None;
+
+            aligned_vector<uint8_t> colorBuffer;
+            aligned_vector<uint8_t> depthBuffer;
+            aligned_vector<vec3f> normalBuffer;
+            aligned_vector<vec3f> albedoBuffer;
+            aligned_vector<uint32_t> primitiveIDBuffer;
+            aligned_vector<uint32_t> objectIDBuffer;
+            aligned_vector<uint32_t> instanceIDBuffer;
+
+            enum { NumDenoiseIterations = 5 };
+            bool denoising = false;
+            aligned_vector<vec4f> denoiseBuffer;
+            aligned_vector<vec4f> denoiseScratch;
 
             void* colorPtr = nullptr;
             void* depthPtr = nullptr;
@@ -132,11 +593,84 @@ namespace generic {
             ANARICamera handle = nullptr;
         };
 
+        // Alias table entry (Walker/Vose) for O(1) sampling of discrete
+        // distributions; pdf is the normalized weight of the entry
+        struct AliasEntry
+        {
+            float prob = 1.f;
+            unsigned alias = 0;
+            float pdf = 0.f;
+        };
+
+        inline void buildAliasTable(const float* weights, unsigned n, AliasEntry* table)
+        {
+            double sum = 0.0;
+            for (unsigned i=0; i<n; ++i) {
+                sum += weights[i];
+            }
+
+            if (sum <= 0.0) {
+                for (unsigned i=0; i<n; ++i) {
+                    table[i].prob = 1.f;
+                    table[i].alias = i;
+                    table[i].pdf = 1.f/n;
+                }
+                return;
+            }
+
+            std::vector<float> scaled(n);
+            std::vector<unsigned> small, large;
+
+            for (unsigned i=0; i<n; ++i) {
+                table[i].pdf = float(weights[i]/sum);
+                scaled[i] = table[i].pdf*n;
+                if (scaled[i] < 1.f)
+                    small.push_back(i);
+                else
+                    large.push_back(i);
+            }
+
+            while (!small.empty() && !large.empty()) {
+                unsigned s = small.back();
+                small.pop_back();
+                unsigned l = large.back();
+                large.pop_back();
+
+                table[s].prob = scaled[s];
+                table[s].alias = l;
+
+                scaled[l] = (scaled[l]+scaled[s])-1.f;
+                if (scaled[l] < 1.f)
+                    small.push_back(l);
+                else
+                    large.push_back(l);
+            }
+
+            // Leftovers (only due to round-off) always pick themselves
+            for (unsigned i : large) {
+                table[i].prob = 1.f;
+                table[i].alias = i;
+            }
+
+            for (unsigned i : small) {
+                table[i].prob = 1.f;
+                table[i].alias = i;
+            }
+        }
+
+        VSNRAY_FUNC
+        inline unsigned sampleAliasTable(const AliasEntry* table, unsigned n, float u)
+        {
+            float x = u*n;
+            unsigned i = min((unsigned)x,n-1);
+            return x-i < table[i].prob ? i : table[i].alias;
+        }
+
         struct Light
         {
             using SP = std::shared_ptr<Light>;
 
-            enum class Type { Point, Quad, };
+            enum class Type { Point, Quad, Directional, HDRI, };
 
             enum class Side { Front, Back, Both, };
 
@@ -144,6 +678,8 @@ namespace generic {
 
             vec3f color{1.f,1.f,1.f};
 
+            bool visible = true;
+
             struct {
                 vec3f position{0.f,0.f,0.f};
                 float intensity = 1.f;
@@ -166,163 +702,2485 @@ namespace generic {
                 bool powerWasSet = false;
             } asQuadLight;
 
-            ANARILight handle = nullptr;
+            struct {
+                vec3f direction{0.f,0.f,-1.f};
+                float irradiance = 1.f;
+            } asDirectionalLight;
+
+            // Radiance map and its sampling distribution: the marginal table
+            // selects a row, the per-row conditional tables a column
+            struct {
+                vec3f up{0.f,0.f,1.f};
+                vec3f direction{1.f,0.f,0.f};
+                float scale = 1.f;
+                int width = 0;
+                int height = 0;
+                aligned_vector<vec3f> radiance;
+                aligned_vector<AliasEntry> marginal;
+                aligned_vector<AliasEntry> conditional;
+            } asHDRILight;
+
+            ANARILight handle = nullptr;
+        };
+
+        // Two-level grid of BrickSize^3 bricks; bricks that contain only
+        // the empty value are not stored
+        struct SparseFieldRef
+        {
+            enum { BrickSize = 8 };
+
+            const int* brickIDs = nullptr;  // per brick, -1 if empty
+            const float* bricks = nullptr;  // BrickSize^3 voxels per brick
+            vec3i dims;
+            vec3i numBricks;
+            float emptyValue = 0.f;
+            bool nearest = false;
+
+            VSNRAY_FUNC
+            float voxel(int x, int y, int z) const
+            {
+                x = clamp(x,0,dims.x-1);
+                y = clamp(y,0,dims.y-1);
+                z = clamp(z,0,dims.z-1);
+
+                int bx = x/BrickSize, by = y/BrickSize, bz = z/BrickSize;
+                int brickID = brickIDs[(bz*numBricks.y+by)*numBricks.x+bx];
+
+                if (brickID < 0)
+                    return emptyValue;
+
+                int lx = x%BrickSize, ly = y%BrickSize, lz = z%BrickSize;
+                size_t offset = size_t(brickID)*BrickSize*BrickSize*BrickSize;
+                return bricks[offset+(lz*BrickSize+ly)*BrickSize+lx];
+            }
+
+            // Trilinear interpolation, voxel centers are at i+.5 like
+            // with the dense textures
+            VSNRAY_FUNC
+            float value(vec3f const& pos) const
+            {
+                if (nearest)
+                    return voxel((int)floor(pos.x),(int)floor(pos.y),(int)floor(pos.z));
+
+                vec3f p = pos-vec3f(.5f);
+                vec3i i0((int)floor(p.x),(int)floor(p.y),(int)floor(p.z));
+                vec3f frac = p-vec3f(i0);
+
+                float v000 = voxel(i0.x,  i0.y,  i0.z  );
+                float v100 = voxel(i0.x+1,i0.y,  i0.z  );
+                float v010 = voxel(i0.x,  i0.y+1,i0.z  );
+                float v110 = voxel(i0.x+1,i0.y+1,i0.z  );
+                float v001 = voxel(i0.x,  i0.y,  i0.z+1);
+                float v101 = voxel(i0.x+1,i0.y,  i0.z+1);
+                float v011 = voxel(i0.x,  i0.y+1,i0.z+1);
+                float v111 = voxel(i0.x+1,i0.y+1,i0.z+1);
+
+                return lerp(lerp(lerp(v000,v100,frac.x),lerp(v010,v110,frac.x),frac.y),
+                            lerp(lerp(v001,v101,frac.x),lerp(v011,v111,frac.x),frac.y),
+                            frac.z);
+            }
+        };
+
+        // Grid of macro cells storing the value range of the field inside
+        // each cell; volumes derive per-cell majorants from these
+        struct MacroCellGridRef
+        {
+            aabb bounds;
+            vec3i dims;
+            vec3f cellSize;
+            const vec2f* valueRanges = nullptr;
+        };
+
+        // AMR blocks as in OpenVKL: bounds are given in the index space of
+        // the block's level, upper is inclusive; level 0 is the coarsest
+        // level, cells on level L are cellWidth[L] wide (2^-L by default)
+        struct AMRBlock
+        {
+            aabbi bounds;
+            int level = 0;
+            float cellWidth = 1.f;
+            size_t offset = 0; // into the scalars array
+            aabb worldBounds;
+        };
+
+        struct AMRFieldRef
+        {
+            struct Node
+            {
+                aabb bounds;
+                unsigned first = 0; // left child (inner) or first index (leaf)
+                unsigned count = 0; // 0 for inner nodes
+            };
+
+            const AMRBlock* blocks = nullptr;
+            const float* scalars = nullptr;
+
+            // One brick BVH per level, sharing the nodes and indices arrays
+            const Node* nodes = nullptr;
+            const unsigned* indices = nullptr;
+            const unsigned* levelRoots = nullptr; // ~0u if level is empty
+            int numLevels = 0;
+
+            aabb bounds;
+
+            // Find the block containing pos on the given level
+            VSNRAY_FUNC
+            bool findBlock(vec3f const& pos, int level, unsigned& blockID) const
+            {
+                if (levelRoots[level] == ~0u)
+                    return false;
+
+                unsigned stack[64];
+                int ptr = 0;
+                stack[ptr++] = levelRoots[level];
+
+                while (ptr > 0) {
+                    const Node& node = nodes[stack[--ptr]];
+
+                    if (pos.x < node.bounds.min.x || pos.x >= node.bounds.max.x
+                     || pos.y < node.bounds.min.y || pos.y >= node.bounds.max.y
+                     || pos.z < node.bounds.min.z || pos.z >= node.bounds.max.z)
+                        continue;
+
+                    if (node.count == 0) {
+                        stack[ptr++] = node.first;
+                        stack[ptr++] = node.first+1;
+                    } else {
+                        for (unsigned i=node.first; i<node.first+node.count; ++i) {
+                            const aabb& wb = blocks[indices[i]].worldBounds;
+                            if (pos.x >= wb.min.x && pos.x < wb.max.x
+                             && pos.y >= wb.min.y && pos.y < wb.max.y
+                             && pos.z >= wb.min.z && pos.z < wb.max.z) {
+                                blockID = indices[i];
+                                return true;
+                            }
+                        }
+                    }
+                }
+
+                return false;
+            }
+
+            // Value of the finest cell containing pos (box filter)
+            VSNRAY_FUNC
+            float value(vec3f const& pos) const
+            {
+                for (int level=numLevels-1; level>=0; --level) {
+                    unsigned blockID;
+                    if (findBlock(pos,level,blockID)) {
+                        const AMRBlock& block = blocks[blockID];
+                        vec3i dims = block.bounds.max-block.bounds.min+vec3i(1);
+                        vec3i cell((int)floor(pos.x/block.cellWidth),
+                                   (int)floor(pos.y/block.cellWidth),
+                                   (int)floor(pos.z/block.cellWidth));
+                        cell = clamp(cell-block.bounds.min,vec3i(0),dims-vec3i(1));
+                        return scalars[block.offset+(size_t(cell.z)*dims.y+cell.y)*dims.x+cell.x];
+                    }
+                }
+
+                return 0.f;
+            }
+        };
+
+        // Unstructured cells are stored as tetrahedra, other cell types are
+        // split into tets at commit time
+        struct UnstructuredFieldRef
+        {
+            struct Node
+            {
+                aabb bounds;
+                vec2f valueRange;   // min/max over the node's tets
+                unsigned first = 0; // left child (inner) or first index (leaf)
+                unsigned count = 0; // 0 for inner nodes
+            };
+
+            const vec3f* vertices = nullptr;
+            const float* values = nullptr; // per vertex
+            const vec4ui* tets = nullptr;
+
+            const Node* nodes = nullptr;
+            const unsigned* indices = nullptr;
+
+            aabb bounds;
+
+            // Barycentric interpolation if pos is inside the tet
+            VSNRAY_FUNC
+            bool tetValue(unsigned tetID, vec3f const& pos, float& value) const
+            {
+                const vec4ui& tet = tets[tetID];
+                vec3f v0 = vertices[tet.x];
+                vec3f e1 = vertices[tet.y]-v0;
+                vec3f e2 = vertices[tet.z]-v0;
+                vec3f e3 = vertices[tet.w]-v0;
+                vec3f p = pos-v0;
+
+                float det = dot(e1,cross(e2,e3));
+                if (det == 0.f)
+                    return false;
+
+                float b1 = dot(p,cross(e2,e3))/det;
+                float b2 = dot(e1,cross(p,e3))/det;
+                float b3 = dot(e1,cross(e2,p))/det;
+                float b0 = 1.f-b1-b2-b3;
+
+                const float eps = -1e-6f;
+                if (b0 < eps || b1 < eps || b2 < eps || b3 < eps)
+                    return false;
+
+                value = b0*values[tet.x]+b1*values[tet.y]
+                      + b2*values[tet.z]+b3*values[tet.w];
+                return true;
+            }
+
+            // Point location with the cell BVH; 0 outside the mesh
+            VSNRAY_FUNC
+            float value(vec3f const& pos) const
+            {
+                if (nodes == nullptr)
+                    return 0.f;
+
+                unsigned stack[64];
+                int ptr = 0;
+                stack[ptr++] = 0;
+
+                while (ptr > 0) {
+                    const Node& node = nodes[stack[--ptr]];
+
+                    if (pos.x < node.bounds.min.x || pos.x > node.bounds.max.x
+                     || pos.y < node.bounds.min.y || pos.y > node.bounds.max.y
+                     || pos.z < node.bounds.min.z || pos.z > node.bounds.max.z)
+                        continue;
+
+                    if (node.count == 0) {
+                        stack[ptr++] = node.first;
+                        stack[ptr++] = node.first+1;
+                    } else {
+                        for (unsigned i=node.first; i<node.first+node.count; ++i) {
+                            float value;
+                            if (tetValue(indices[i],pos,value))
+                                return value;
+                        }
+                    }
+                }
+
+                return 0.f;
+            }
+        };
+
+        enum class FieldType { StructuredRegular, Sparse, AMR, Unstructured, };
+
+        struct VolumeRef
+        {
+            FieldType fieldType = FieldType::StructuredRegular;
+
+            texture_ref<float, 3> texture3f;
+            SparseFieldRef sparse;
+            AMRFieldRef amr;
+            UnstructuredFieldRef unstructured;
+
+            // Fields other than structured ones provide a macro cell grid,
+            // majorants are per macro cell and derived from the TF
+            MacroCellGridRef grid;
+            const float* majorants = nullptr;
+
+            texture_ref<vec4f, 1> textureRGBA;
+
+            // Pre-integrated TF, indexed by front and back scalar of a
+            // segment; stores color and opacity per unit length
+            texture_ref<vec4f, 2> texturePreIntegrated;
+            bool preIntegrated = false;
+
+            aabb bbox;
+            float mu_ = 1.f;
+
+            // Field value at pos, given in volume space ([0..dims])
+            VSNRAY_FUNC
+            float sampleField(vec3 const& pos)
+            {
+                if (fieldType == FieldType::Sparse)
+                    return sparse.value(pos);
+                else if (fieldType == FieldType::AMR)
+                    return amr.value(pos);
+                else if (fieldType == FieldType::Unstructured)
+                    return unstructured.value(pos);
+                else
+                    return (float)tex3D(texture3f, pos / bbox.size());
+            }
+
+            VSNRAY_FUNC
+            vec4f classify(float voxel)
+            {
+                // normalize to [0..1]
+                //voxel = normalize(volume, voxel);
+
+                return tex1D(textureRGBA, voxel);
+            }
+
+            VSNRAY_FUNC
+            vec3 albedo(vec3 const& pos)
+            {
+                return classify(sampleField(pos)).xyz();
+            }
+
+            VSNRAY_FUNC
+            float mu(vec3 const& pos)
+            {
+                return classify(sampleField(pos)).w;
+            }
+
+            // Delta tracking in [tnear,tfar), r is given in volume space
+            template <typename Ray>
+            VSNRAY_FUNC
+            bool sample_interaction(const Ray& r, float tnear, float tfar, float& t,
+                                    random_generator<float>& gen)
+            {
+                if (majorants != nullptr)
+                    return sample_interaction_grid(r,tnear,tfar,t,gen);
+
+                t = tnear;
+                vec3 pos;
+
+                do
+                {
+                    t -= log(1.0f - gen.next()) / mu_;
+
+                    pos = r.ori + r.dir * t;
+                    if (t >= tfar)
+                    {
+                        return false;
+                    }
+                }
+                while (mu(pos) < gen.next() * mu_);
+
+                return true;
+            }
+
+            // Delta tracking with local majorants; walks the macro cells with
+            // a 3D DDA and skips cells whose majorant is zero
+            template <typename Ray>
+            VSNRAY_FUNC
+            bool sample_interaction_grid(const Ray& r, float tnear, float tfar, float& t,
+                                         random_generator<float>& gen)
+            {
+                const vec3i& gridDims = grid.dims;
+                const vec3f& cellSize = grid.cellSize;
+
+                t = tnear;
+                vec3f p = r.ori + r.dir * t - grid.bounds.min;
+                vec3i cell((int)(p.x/cellSize.x),(int)(p.y/cellSize.y),(int)(p.z/cellSize.z));
+                cell = clamp(cell,vec3i(0),gridDims-vec3i(1));
+
+                vec3i step;
+                vec3f tDelta, tNext;
+                for (int i=0; i<3; ++i) {
+                    if (r.dir[i] > 0.f) {
+                        step[i] = 1;
+                        tDelta[i] = cellSize[i]/r.dir[i];
+                        tNext[i] = t+((cell[i]+1)*cellSize[i]-p[i])/r.dir[i];
+                    } else if (r.dir[i] < 0.f) {
+                        step[i] = -1;
+                        tDelta[i] = -cellSize[i]/r.dir[i];
+                        tNext[i] = t+(cell[i]*cellSize[i]-p[i])/r.dir[i];
+                    } else {
+                        step[i] = 0;
+                        tDelta[i] = std::numeric_limits<float>::max();
+                        tNext[i] = std::numeric_limits<float>::max();
+                    }
+                }
+
+                while (t < tfar) {
+                    int axis = tNext.x < tNext.y ? (tNext.x < tNext.z ? 0 : 2)
+                                                 : (tNext.y < tNext.z ? 1 : 2);
+                    float tCellEnd = min(tNext[axis],tfar);
+
+                    size_t cellID = (size_t(cell.z)*gridDims.y+cell.y)*gridDims.x+cell.x;
+                    float majorant = majorants[cellID];
+
+                    if (majorant > 0.f) {
+                        for (;;) {
+                            t -= log(1.0f - gen.next()) / majorant;
+
+                            if (t >= tCellEnd)
+                                break;
+
+                            if (mu(r.ori + r.dir * t) >= gen.next() * majorant)
+                                return true;
+                        }
+                    }
+
+                    // free flight is memoryless, restart at the cell boundary
+                    t = tCellEnd;
+
+                    cell[axis] += step[axis];
+                    if (cell[axis] < 0 || cell[axis] >= gridDims[axis])
+                        break;
+                    tNext[axis] += tDelta[axis];
+                }
+
+                return false;
+            }
+
+            // Central differences with a one voxel offset
+            VSNRAY_FUNC
+            inline vec3f gradient(vec3f pos)
+            {
+                return vec3f(+sampleField(vec3f(pos.x+1.f,pos.y,pos.z))
+                             -sampleField(vec3f(pos.x-1.f,pos.y,pos.z)),
+                             +sampleField(vec3f(pos.x,pos.y+1.f,pos.z))
+                             -sampleField(vec3f(pos.x,pos.y-1.f,pos.z)),
+                             +sampleField(vec3f(pos.x,pos.y,pos.z+1.f))
+                             -sampleField(vec3f(pos.x,pos.y,pos.z-1.f)));
+            }
+        };
+
+        struct MacroCellGrid
+        {
+            // Macro cell edge length in field units
+            void reset(const aabb& b, float macroCellSize)
+            {
+                bounds = b;
+                vec3f size = bounds.size();
+                dims = vec3i(std::max(1,(int)ceilf(size.x/macroCellSize)),
+                             std::max(1,(int)ceilf(size.y/macroCellSize)),
+                             std::max(1,(int)ceilf(size.z/macroCellSize)));
+                cellSize = size/vec3f(dims);
+
+                valueRanges.assign(size_t(dims.x)*dims.y*dims.z,
+                                   vec2f(std::numeric_limits<float>::max(),
+                                         -std::numeric_limits<float>::max()));
+            }
+
+            aabb cellBounds(int x, int y, int z) const
+            {
+                vec3f lo = bounds.min+vec3f((float)x,(float)y,(float)z)*cellSize;
+                return aabb(lo,lo+cellSize);
+            }
+
+            // Extend the value range of all macro cells overlapping box
+            void insert(const aabb& box, vec2f range)
+            {
+                vec3f lo = (box.min-bounds.min)/cellSize;
+                vec3f hi = (box.max-bounds.min)/cellSize;
+                vec3i cellLo = clamp(vec3i((int)lo.x,(int)lo.y,(int)lo.z),
+                                     vec3i(0),dims-vec3i(1));
+                vec3i cellHi = clamp(vec3i((int)ceilf(hi.x)-1,(int)ceilf(hi.y)-1,(int)ceilf(hi.z)-1),
+                                     vec3i(0),dims-vec3i(1));
+
+                for (int z=cellLo.z; z<=cellHi.z; ++z) {
+                    for (int y=cellLo.y; y<=cellHi.y; ++y) {
+                        for (int x=cellLo.x; x<=cellHi.x; ++x) {
+                            vec2f& r = valueRanges[(size_t(z)*dims.y+y)*dims.x+x];
+                            r.x = fminf(r.x,range.x);
+                            r.y = fmaxf(r.y,range.y);
+                        }
+                    }
+                }
+            }
+
+            MacroCellGridRef ref() const
+            {
+                MacroCellGridRef result;
+                result.bounds = bounds;
+                result.dims = dims;
+                result.cellSize = cellSize;
+                result.valueRanges = valueRanges.data();
+                return result;
+            }
+
+            aabb bounds;
+            vec3i dims;
+            vec3f cellSize;
+            aligned_vector<vec2f> valueRanges;
+        };
+
+        struct SpatialField
+        {
+            using SP = std::shared_ptr<SpatialField>;
+
+            virtual ~SpatialField() {}
+
+            ANARISpatialField handle = nullptr;
+        };
+
+        struct SparseField : SpatialField
+        {
+            using SP = std::shared_ptr<SparseField>;
+
+            enum { BrickSize = SparseFieldRef::BrickSize };
+
+            static_assert((int)BrickSize == (int)generic::SparseRegular::BrickSize,
+                          "Brick size must match the frontend's");
+
+            // Convert from dense storage, dropping bricks where
+            // all voxels equal the empty value
+            void reset(const float* data, vec3i d, float empty, thread_pool& pool)
+            {
+                dims = d;
+                numBricks = vec3i((dims.x+BrickSize-1)/BrickSize,
+                                  (dims.y+BrickSize-1)/BrickSize,
+                                  (dims.z+BrickSize-1)/BrickSize);
+                emptyValue = empty;
+
+                int totalBricks = numBricks.x*numBricks.y*numBricks.z;
+
+                auto brickCoord = [this](int b) {
+                    return vec3i(b%numBricks.x,
+                                 (b/numBricks.x)%numBricks.y,
+                                 b/(numBricks.x*numBricks.y));
+                };
+
+                // 1st pass: find non-empty bricks
+                std::vector<uint8_t> occupied(totalBricks);
+
+                parallel_for(pool,tiled_range1d<int>(0,totalBricks,64),
+                    [&](range1d<int> r) {
+                        for (int b=r.begin(); b!=r.end(); ++b) {
+                            vec3i lo = brickCoord(b)*BrickSize;
+                            vec3i hi = min(lo+vec3i(BrickSize),dims);
+                            bool empty = true;
+                            for (int z=lo.z; z<hi.z && empty; ++z) {
+                                for (int y=lo.y; y<hi.y && empty; ++y) {
+                                    for (int x=lo.x; x<hi.x; ++x) {
+                                        size_t idx = (size_t(z)*dims.y+y)*dims.x+x;
+                                        if (data[idx] != emptyValue) {
+                                            empty = false;
+                                            break;
+                                        }
+                                    }
+                                }
+                            }
+                            occupied[b] = !empty;
+                        }
+                    });
+
+                brickIDs.resize(totalBricks);
+                int numOccupied = 0;
+                for (int b=0; b<totalBricks; ++b) {
+                    brickIDs[b] = occupied[b] ? numOccupied++ : -1;
+                }
+
+                // 2nd pass: copy the non-empty bricks, voxels outside
+                // the domain are padded with the empty value
+                const size_t voxelsPerBrick = BrickSize*BrickSize*BrickSize;
+                bricks.resize(numOccupied*voxelsPerBrick);
+
+                parallel_for(pool,tiled_range1d<int>(0,totalBricks,64),
+                    [&](range1d<int> r) {
+                        for (int b=r.begin(); b!=r.end(); ++b) {
+                            if (brickIDs[b] < 0)
+                                continue;
+
+                            vec3i lo = brickCoord(b)*BrickSize;
+                            float* dst = bricks.data()+brickIDs[b]*voxelsPerBrick;
+                            for (int z=0; z<BrickSize; ++z) {
+                                for (int y=0; y<BrickSize; ++y) {
+                                    for (int x=0; x<BrickSize; ++x) {
+                                        vec3i v = lo+vec3i(x,y,z);
+                                        float val = emptyValue;
+                                        if (v.x < dims.x && v.y < dims.y && v.z < dims.z)
+                                            val = data[(size_t(v.z)*dims.y+v.y)*dims.x+v.x];
+                                        dst[(z*BrickSize+y)*BrickSize+x] = val;
+                                    }
+                                }
+                            }
+                        }
+                    });
+            }
+
+            // Take over already bricked input; brick IDs that are out of
+            // range are treated as empty
+            void reset(const int* ids, vec3i nb, const float* brickData, size_t numInputBricks,
+                       vec3i d, float empty)
+            {
+                dims = d;
+                numBricks = nb;
+                emptyValue = empty;
+
+                size_t totalBricks = size_t(numBricks.x)*numBricks.y*numBricks.z;
+                brickIDs.assign(ids,ids+totalBricks);
+
+                size_t numInvalid = 0;
+                for (size_t b=0; b<totalBricks; ++b) {
+                    if (brickIDs[b] >= 0 && size_t(brickIDs[b]) >= numInputBricks) {
+                        brickIDs[b] = -1;
+                        ++numInvalid;
+                    }
+                }
+
+                if (numInvalid > 0) {
+                    LOG(logging::Level::Error) << "SpatialField.SparseRegular: " << numInvalid
+                        << " brick indices out of range, treating them as empty";
+                }
+
+                const size_t voxelsPerBrick = BrickSize*BrickSize*BrickSize;
+                bricks.assign(brickData,brickData+numInputBricks*voxelsPerBrick);
+            }
+
+            SparseFieldRef ref() const
+            {
+                SparseFieldRef result;
+                result.brickIDs = brickIDs.data();
+                result.bricks = bricks.data();
+                result.dims = dims;
+                result.numBricks = numBricks;
+                result.emptyValue = emptyValue;
+                result.nearest = nearest;
+                return result;
+            }
+
+            vec3i dims;
+            vec3i numBricks;
+            float emptyValue = 0.f;
+            bool nearest = false;
+
+            aligned_vector<int> brickIDs;
+            aligned_vector<float> bricks;
+        };
+
+        struct AMRField : SpatialField
+        {
+            using SP = std::shared_ptr<AMRField>;
+
+            using Node = AMRFieldRef::Node;
+
+            enum { MaxLeafSize = 2 };
+
+            // Macro cell edge length, in cells of the finest level
+            enum { MacroCellSize = 16 };
+
+            void reset(const aabbi* blockBounds, const int* blockLevels,
+                       const Array3D* const* blockData, size_t numBlocks,
+                       const float* cellWidths, size_t numCellWidths,
+                       thread_pool& pool)
+            {
+                blocks.resize(numBlocks);
+                bounds.invalidate();
+                numLevels = 0;
+
+                float finestCellWidth = std::numeric_limits<float>::max();
+
+                size_t numScalars = 0;
+                for (size_t i=0; i<numBlocks; ++i) {
+                    AMRBlock& block = blocks[i];
+                    block.bounds = blockBounds[i];
+                    block.level = blockLevels[i];
+                    block.cellWidth = size_t(block.level) < numCellWidths
+                                    ? cellWidths[block.level]
+                                    : ldexpf(1.f,-block.level);
+                    block.offset = numScalars;
+                    block.worldBounds = aabb(vec3f(block.bounds.min)*block.cellWidth,
+                                             vec3f(block.bounds.max+vec3i(1))*block.cellWidth);
+
+                    vec3i dims = block.bounds.max-block.bounds.min+vec3i(1);
+                    numScalars += size_t(dims.x)*dims.y*dims.z;
+
+                    bounds.insert(block.worldBounds);
+                    numLevels = std::max(numLevels,block.level+1);
+                    finestCellWidth = std::min(finestCellWidth,block.cellWidth);
+                }
+
+                scalars.resize(numScalars);
+
+                // Copy the scalars and compute per-block value ranges
+                std::vector<vec2f> blockRanges(numBlocks);
+
+                parallel_for(pool,tiled_range1d<size_t>(0,numBlocks,16),
+                    [&](range1d<size_t> r) {
+                        for (size_t i=r.begin(); i!=r.end(); ++i) {
+                            const AMRBlock& block = blocks[i];
+                            vec3i dims = block.bounds.max-block.bounds.min+vec3i(1);
+                            size_t n = size_t(dims.x)*dims.y*dims.z;
+                            aligned_vector<float> scratch;
+                            const float* src = getArrayData(blockData[i],ANARI_FLOAT32,scratch);
+
+                            vec2f range(std::numeric_limits<float>::max(),
+                                        -std::numeric_limits<float>::max());
+                            for (size_t j=0; j<n; ++j) {
+                                scalars[block.offset+j] = src[j];
+                                range.x = fminf(range.x,src[j]);
+                                range.y = fmaxf(range.y,src[j]);
+                            }
+                            blockRanges[i] = range;
+                        }
+                    });
+
+                buildBVHs();
+                buildGrid(blockRanges,MacroCellSize*finestCellWidth);
+            }
+
+            void buildBVHs()
+            {
+                nodes.clear();
+                indices.clear();
+                levelRoots.assign(numLevels,~0u);
+
+                for (int level=0; level<numLevels; ++level) {
+                    unsigned first = (unsigned)indices.size();
+                    for (size_t i=0; i<blocks.size(); ++i) {
+                        if (blocks[i].level == level)
+                            indices.push_back((unsigned)i);
+                    }
+                    unsigned last = (unsigned)indices.size();
+
+                    if (first == last)
+                        continue;
+
+                    levelRoots[level] = (unsigned)nodes.size();
+                    nodes.emplace_back();
+                    buildRec(levelRoots[level],first,last);
+                }
+            }
+
+            void buildRec(unsigned nodeID, unsigned first, unsigned last)
+            {
+                aabb nodeBounds, centroidBounds;
+                nodeBounds.invalidate();
+                centroidBounds.invalidate();
+
+                for (unsigned i=first; i<last; ++i) {
+                    nodeBounds.insert(blocks[indices[i]].worldBounds);
+                    centroidBounds.insert(blocks[indices[i]].worldBounds.center());
+                }
+
+                nodes[nodeID].bounds = nodeBounds;
+
+                if (last-first <= MaxLeafSize) {
+                    nodes[nodeID].first = first;
+                    nodes[nodeID].count = last-first;
+                    return;
+                }
+
+                // Median split along the longest centroid axis
+                vec3f ext = centroidBounds.size();
+                int axis = ext.x > ext.y ? (ext.x > ext.z ? 0 : 2) : (ext.y > ext.z ? 1 : 2);
+                unsigned mid = (first+last)/2;
+                std::nth_element(indices.begin()+first,indices.begin()+mid,indices.begin()+last,
+                                 [this,axis](unsigned a, unsigned b) {
+                                     return blocks[a].worldBounds.center()[axis]
+                                          < blocks[b].worldBounds.center()[axis];
+                                 });
+
+                unsigned left = (unsigned)nodes.size();
+                nodes.emplace_back();
+                nodes.emplace_back();
+                nodes[nodeID].first = left;
+                nodes[nodeID].count = 0;
+
+                buildRec(left,first,mid);
+                buildRec(left+1,mid,last);
+            }
+
+            // Splat the block value ranges into the macro cells they overlap
+            void buildGrid(const std::vector<vec2f>& blockRanges, float macroCellSize)
+            {
+                grid.reset(bounds,macroCellSize);
+
+                for (size_t i=0; i<blocks.size(); ++i) {
+                    grid.insert(blocks[i].worldBounds,blockRanges[i]);
+                }
+            }
+
+            AMRFieldRef ref() const
+            {
+                AMRFieldRef result;
+                result.blocks = blocks.data();
+                result.scalars = scalars.data();
+                result.nodes = nodes.data();
+                result.indices = indices.data();
+                result.levelRoots = levelRoots.data();
+                result.numLevels = numLevels;
+                result.bounds = bounds;
+                return result;
+            }
+
+            aligned_vector<AMRBlock> blocks;
+            aligned_vector<float> scalars;
+
+            aligned_vector<Node> nodes;
+            aligned_vector<unsigned> indices;
+            aligned_vector<unsigned> levelRoots;
+            int numLevels = 0;
+
+            aabb bounds;
+
+            MacroCellGrid grid;
+        };
+
+        struct UnstructuredField : SpatialField
+        {
+            using SP = std::shared_ptr<UnstructuredField>;
+
+            using Node = UnstructuredFieldRef::Node;
+
+            // Cell type IDs as in VTK
+            enum CellType
+            {
+                Tetrahedron = 10,
+                Hexahedron  = 12,
+                Wedge       = 13,
+                Pyramid     = 14,
+            };
+
+            enum { MaxLeafSize = 4 };
+
+            // Macro cells along the longest axis of the mesh
+            enum { MacroCellsPerAxis = 64 };
+
+            void reset(thread_pool& pool)
+            {
+                bounds.invalidate();
+                for (size_t i=0; i<vertices.size(); ++i) {
+                    bounds.insert(vertices[i]);
+                }
+
+                indices.resize(tets.size());
+                for (size_t i=0; i<tets.size(); ++i) {
+                    indices[i] = (unsigned)i;
+                }
+
+                nodes.clear();
+                if (!tets.empty()) {
+                    nodes.emplace_back();
+                    buildRec(0,0,(unsigned)tets.size());
+                }
+
+                buildGrid(pool);
+            }
+
+            aabb tetBounds(unsigned tetID) const
+            {
+                const vec4ui& tet = tets[tetID];
+                aabb result;
+                result.invalidate();
+                result.insert(vertices[tet.x]);
+                result.insert(vertices[tet.y]);
+                result.insert(vertices[tet.z]);
+                result.insert(vertices[tet.w]);
+                return result;
+            }
+
+            vec2f tetRange(unsigned tetID) const
+            {
+                const vec4ui& tet = tets[tetID];
+                return vec2f(fminf(fminf(values[tet.x],values[tet.y]),fminf(values[tet.z],values[tet.w])),
+                             fmaxf(fmaxf(values[tet.x],values[tet.y]),fmaxf(values[tet.z],values[tet.w])));
+            }
+
+            void buildRec(unsigned nodeID, unsigned first, unsigned last)
+            {
+                aabb nodeBounds, centroidBounds;
+                nodeBounds.invalidate();
+                centroidBounds.invalidate();
+
+                vec2f range(std::numeric_limits<float>::max(),
+                            -std::numeric_limits<float>::max());
+
+                for (unsigned i=first; i<last; ++i) {
+                    aabb tb = tetBounds(indices[i]);
+                    nodeBounds.insert(tb);
+                    centroidBounds.insert(tb.center());
+
+                    vec2f tr = tetRange(indices[i]);
+                    range.x = fminf(range.x,tr.x);
+                    range.y = fmaxf(range.y,tr.y);
+                }
+
+                nodes[nodeID].bounds = nodeBounds;
+                nodes[nodeID].valueRange = range;
+
+                if (last-first <= MaxLeafSize) {
+                    nodes[nodeID].first = first;
+                    nodes[nodeID].count = last-first;
+                    return;
+                }
+
+                // Median split along the longest centroid axis
+                vec3f ext = centroidBounds.size();
+                int axis = ext.x > ext.y ? (ext.x > ext.z ? 0 : 2) : (ext.y > ext.z ? 1 : 2);
+                unsigned mid = (first+last)/2;
+                std::nth_element(indices.begin()+first,indices.begin()+mid,indices.begin()+last,
+                                 [this,axis](unsigned a, unsigned b) {
+                                     return tetBounds(a).center()[axis]
+                                          < tetBounds(b).center()[axis];
+                                 });
+
+                unsigned left = (unsigned)nodes.size();
+                nodes.emplace_back();
+                nodes.emplace_back();
+                nodes[nodeID].first = left;
+                nodes[nodeID].count = 0;
+
+                buildRec(left,first,mid);
+                buildRec(left+1,mid,last);
+            }
+
+            // Value range per macro cell from the BVH node ranges: descend
+            // until a node lies completely inside the macro cell
+            void buildGrid(thread_pool& pool)
+            {
+                vec3f size = bounds.size();
+                float maxExtent = fmaxf(size.x,fmaxf(size.y,size.z));
+                grid.reset(bounds,fmaxf(maxExtent/MacroCellsPerAxis,1e-6f));
+
+                if (nodes.empty())
+                    return;
+
+                vec3i dims = grid.dims;
+                int numCells = dims.x*dims.y*dims.z;
+
+                parallel_for(pool,tiled_range1d<int>(0,numCells,64),
+                    [&](range1d<int> r) {
+                        for (int c=r.begin(); c!=r.end(); ++c) {
+                            aabb cell = grid.cellBounds(c%dims.x,(c/dims.x)%dims.y,c/(dims.x*dims.y));
+                            vec2f& range = grid.valueRanges[c];
+
+                            unsigned stack[64];
+                            int ptr = 0;
+                            stack[ptr++] = 0;
+
+                            while (ptr > 0) {
+                                const Node& node = nodes[stack[--ptr]];
+
+                                aabb isect = intersect(node.bounds,cell);
+                                if (isect.invalid())
+                                    continue;
+
+                                bool contained = node.bounds.min.x >= cell.min.x && node.bounds.max.x <= cell.max.x
+                                              && node.bounds.min.y >= cell.min.y && node.bounds.max.y <= cell.max.y
+                                              && node.bounds.min.z >= cell.min.z && node.bounds.max.z <= cell.max.z;
+
+                                if (contained || node.count > 0) {
+                                    range.x = fminf(range.x,node.valueRange.x);
+                                    range.y = fmaxf(range.y,node.valueRange.y);
+                                } else {
+                                    stack[ptr++] = node.first;
+                                    stack[ptr++] = node.first+1;
+                                }
+                            }
+                        }
+                    });
+            }
+
+            UnstructuredFieldRef ref() const
+            {
+                UnstructuredFieldRef result;
+                result.vertices = vertices.data();
+                result.values = values.data();
+                result.tets = tets.data();
+                result.nodes = nodes.empty() ? nullptr : nodes.data();
+                result.indices = indices.data();
+                result.bounds = bounds;
+                return result;
+            }
+
+            aligned_vector<vec3f> vertices;
+            aligned_vector<float> values;
+            aligned_vector<vec4ui> tets;
+
+            aligned_vector<Node> nodes;
+            aligned_vector<unsigned> indices;
+
+            aabb bounds;
+
+            MacroCellGrid grid;
+        };
+
+        struct Volume
+        {
+            using SP = std::shared_ptr<Volume>;
+
+            // Re-derive the field pointers in ref after the field was
+            // (re)committed; returns false for structured fields, whose
+            // data is copied into the volume's own texture instead
+            bool updateFieldRef()
+            {
+                if (auto sf = std::dynamic_pointer_cast<SparseField>(field)) {
+                    ref.fieldType = FieldType::Sparse;
+                    ref.sparse = sf->ref();
+                    ref.bbox = aabb({0.f,0.f,0.f},vec3f(sf->dims));
+                } else if (auto af = std::dynamic_pointer_cast<AMRField>(field)) {
+                    ref.fieldType = FieldType::AMR;
+                    ref.amr = af->ref();
+                    ref.grid = af->grid.ref();
+                    ref.bbox = af->bounds;
+                } else if (auto uf = std::dynamic_pointer_cast<UnstructuredField>(field)) {
+                    ref.fieldType = FieldType::Unstructured;
+                    ref.unstructured = uf->ref();
+                    ref.grid = uf->grid.ref();
+                    ref.bbox = uf->bounds;
+                } else {
+                    return false;
+                }
+
+                if (!rgba.empty()
+                 && (ref.fieldType == FieldType::AMR || ref.fieldType == FieldType::Unstructured))
+                    computeMajorants();
+                else
+                    ref.majorants = nullptr;
+
+                return true;
+            }
+
+            // Structured fields have no backend counterpart, their data
+            // array is passed in as it was when the volume was committed
+            void reset(const Snapshot<VolumeParams>& volume, SpatialField::SP f,
+                       ANARIArray3D structuredData)
+            {
+                handle = (ANARIVolume)volume.getResourceHandle();
+
+                // Keep the field alive for as long as ref points into it
+                field = f;
+
+                if (updateFieldRef()) {
+                    storage3f = texture<float, 3>();
+                    handle3f = nullptr;
+                } else {
+                    if (structuredData == nullptr) {
+                        LOG(logging::Level::Error) << "Volume: spatial field not committed "
+                            << "or of unsupported type";
+                        return;
+                    }
+
+                    if (structuredData != handle3f) { // new volume data!
+                        Array3D* data = (Array3D*)GetResource(structuredData);
+
+                        storage3f = texture<float, 3>((unsigned)data->numItems[0],
+                                                      (unsigned)data->numItems[1],
+                                                      (unsigned)data->numItems[2]);
+                        aligned_vector<float> scratch;
+                        storage3f.reset(getArrayData(data,ANARI_FLOAT32,scratch));
+                        storage3f.set_filter_mode(Linear);
+                        storage3f.set_address_mode(Clamp);
+
+                        ref.fieldType = FieldType::StructuredRegular;
+                        ref.texture3f = texture_ref<float, 3>(storage3f);
+
+                        ref.bbox = aabb({0.f,0.f,0.f},{(float)data->numItems[0],(float)data->numItems[1],(float)data->numItems[2]});
+
+                        handle3f = structuredData;
+                    }
+                }
+
+                ANARIArray1D color = volume.color;
+                ANARIArray1D opacity = volume.opacity;
+
+                bool tfChanged = color != handleRGB || opacity != handleA;
+
+                if (tfChanged) {
+                    Array1D* rgb = (Array1D*)GetResource(color);
+                    Array1D* a = (Array1D*)GetResource(opacity);
+
+                    aligned_vector<vec3f> rgbScratch;
+                    aligned_vector<float> aScratch;
+                    const vec3f* rgbData = getArrayData(rgb,ANARI_FLOAT32_VEC3,rgbScratch);
+                    const float* aData = getArrayData(a,ANARI_FLOAT32,aScratch);
+                    if (rgbData == nullptr || aData == nullptr) {
+                        LOG(logging::Level::Error) << "Volume: color must be convertible "
+                            << "to FLOAT32_VEC3 and opacity to FLOAT32";
+                        return;
+                    }
+
+                    size_t numEntries = std::min(rgb->numItems[0],a->numItems[0]);
+
+                    rgba.resize(numEntries);
+                    for (size_t i = 0; i < numEntries; ++i) {
+                        vec4f val(rgbData[i],aData[i]);
+                        rgba[i] = val;
+                    }
+
+                    storageRGBA = texture<vec4f, 1>(numEntries);
+                    storageRGBA.reset(rgba.data());
+                    storageRGBA.set_filter_mode(Linear);
+                    storageRGBA.set_address_mode(Clamp);
+
+                    ref.textureRGBA = texture_ref<vec4f, 1>(storageRGBA);
+
+                    handleRGB = color;
+                    handleA = opacity;
+                }
+
+                bool preIntegrate = volume.preIntegration;
+
+                if (preIntegrate && (tfChanged || !ref.preIntegrated))
+                    computePreIntegrationTable();
+
+                ref.preIntegrated = preIntegrate;
+
+                if (ref.fieldType == FieldType::AMR
+                 || ref.fieldType == FieldType::Unstructured)
+                    computeMajorants();
+                else
+                    ref.majorants = nullptr;
+            }
+
+            // Majorant per macro cell: max. TF opacity over the cell's value
+            // range, conservative w.r.t. linear TF filtering
+            void computeMajorants()
+            {
+                const MacroCellGridRef& grid = ref.grid;
+                size_t numCells = size_t(grid.dims.x)*grid.dims.y*grid.dims.z;
+                int N = (int)rgba.size();
+
+                majorants.resize(numCells);
+
+                for (size_t i=0; i<numCells; ++i) {
+                    vec2f range = grid.valueRanges[i];
+
+                    if (range.x > range.y) { // field is empty inside the cell
+                        majorants[i] = 0.f;
+                        continue;
+                    }
+
+                    int lo = clamp((int)floorf(range.x*N-.5f),0,N-1);
+                    int hi = clamp((int)ceilf(range.y*N-.5f),0,N-1);
+
+                    float majorant = 0.f;
+                    for (int j=lo; j<=hi; ++j) {
+                        majorant = fmaxf(majorant,rgba[j].w);
+                    }
+                    majorants[i] = majorant;
+                }
+
+                ref.majorants = majorants.data();
+            }
+
+            // Build the 2D pre-integration table from the TF (cf. Engel et
+            // al. 2001). The TF opacity is taken per unit length, it is
+            // integrated as extinction between the front and back scalar
+            void computePreIntegrationTable()
+            {
+                const int N = PreIntegrationTableSize;
+
+                // Sample the TF at the texel centers of the table
+                auto lookup = [this](float s) {
+                    float x = clamp(s*rgba.size()-.5f,0.f,float(rgba.size()-1));
+                    size_t i0 = (size_t)x;
+                    size_t i1 = std::min(i0+1,rgba.size()-1);
+                    float frac = x-i0;
+                    return lerp(rgba[i0],rgba[i1],frac);
+                };
+
+                // Prefix integrals of extinction and extinction weighted color
+                std::vector<float> sigma(N);
+                std::vector<vec3f> color(N);
+                std::vector<float> T(N);
+                std::vector<vec3f> K(N);
+
+                for (int i=0; i<N; ++i) {
+                    vec4f c = lookup((i+.5f)/N);
+                    sigma[i] = -logf(std::max(1.f-c.w,1e-6f));
+                    color[i] = c.xyz();
+
+                    if (i==0) {
+                        T[i] = 0.f;
+                        K[i] = vec3f(0.f);
+                    } else {
+                        T[i] = T[i-1] + .5f*(sigma[i-1]+sigma[i]);
+                        K[i] = K[i-1] + .5f*(sigma[i-1]*color[i-1]+sigma[i]*color[i]);
+                    }
+                }
+
+                aligned_vector<vec4f> table(N*N);
+
+                for (int b=0; b<N; ++b) {
+                    for (int f=0; f<N; ++f) {
+                        vec4f& dst = table[b*N+f];
+
+                        if (f==b) {
+                            dst = vec4f(color[f],1.f-expf(-sigma[f]));
+                            continue;
+                        }
+
+                        float dT = fabsf(T[b]-T[f]);
+                        vec3f dK = K[b]-K[f];
+
+                        // average extinction along the segment
+                        float sigmaAvg = dT/fabsf(float(b-f));
+
+                        vec3f c = dT > 0.f ? dK/(T[b]-T[f]) : .5f*(color[f]+color[b]);
+
+                        dst = vec4f(c,1.f-expf(-sigmaAvg));
+                    }
+                }
+
+                storagePreIntegrated = texture<vec4f, 2>(N,N);
+                storagePreIntegrated.reset(table.data());
+                storagePreIntegrated.set_filter_mode(Linear);
+                storagePreIntegrated.set_address_mode(Clamp);
+
+                ref.texturePreIntegrated = texture_ref<vec4f, 2>(storagePreIntegrated);
+            }
+
+            enum { PreIntegrationTableSize = 256 };
+
+            aligned_vector<vec4f> rgba;
+            aligned_vector<float> majorants;
+
+            texture<float, 3> storage3f;
+            texture<vec4f, 1> storageRGBA;
+            texture<vec4f, 2> storagePreIntegrated;
+
+            VolumeRef ref;
+
+            SpatialField::SP field;
+
+            ANARIVolume handle = nullptr;
+            ANARIArray3D handle3f = nullptr;
+            ANARIArray1D handleRGB = nullptr;
+            ANARIArray1D handleA = nullptr;
+        };
+
+        // Volume placed in the world, either directly or through an instance
+        struct VolumeInstance
+        {
+            VolumeRef* volume = nullptr;
+
+            // Inverse transform, same convention as bvh_inst
+            mat3 affineInv = mat3::identity();
+            vec3f transInv{0.f,0.f,0.f};
+
+            // World space bounds of the transformed volume
+            aabb bounds;
+
+            // Forward transform, kept to recompute the bounds when the
+            // volume's field changes
+            mat4x3 transform;
+
+            void updateBounds()
+            {
+                mat3 affine(transform.col0,transform.col1,transform.col2);
+
+                const aabb& bbox = volume->bbox;
+                bounds.invalidate();
+                for (int i=0; i<8; ++i) {
+                    vec3f v(i&1 ? bbox.max.x : bbox.min.x,
+                            i&2 ? bbox.max.y : bbox.min.y,
+                            i&4 ? bbox.max.z : bbox.min.z);
+                    bounds.insert(affine * v + transform.col3);
+                }
+            }
+
+            // Transform ray to volume space. The direction is not
+            // renormalized so that ray parameters are the same in
+            // world and volume space
+            VSNRAY_FUNC
+            ray localRay(ray r) const
+            {
+                r.ori = affineInv * (r.ori + transInv);
+                r.dir = affineInv * r.dir;
+                return r;
+            }
+        };
+
+        inline VolumeInstance makeVolumeInstance(VolumeRef* volume,
+                                                 const mat4x3& trans)
+        {
+            mat3 affine(trans.col0,trans.col1,trans.col2);
+
+            VolumeInstance inst;
+            inst.volume = volume;
+            inst.affineInv = inverse(affine);
+            inst.transInv = -trans.col3;
+            inst.transform = trans;
+            inst.updateBounds();
+            return inst;
+        }
+
+        // BVH over the world space bounds of the volume instances.
+        // Leaves are visited near-first, the traversal callback can
+        // shrink the ray interval to prune subtrees behind it
+        struct VolumeBVH
+        {
+            struct Node
+            {
+                aabb bounds;
+                unsigned first = 0; // left child (inner) or first index (leaf)
+                unsigned count = 0; // 0 for inner nodes
+            };
+
+            enum { MaxLeafSize = 2 };
+
+            void build(const VolumeInstance* insts, size_t numInsts)
+            {
+                instances = insts;
+                nodes.clear();
+                indices.resize(numInsts);
+
+                for (size_t i=0; i<numInsts; ++i) {
+                    indices[i] = (unsigned)i;
+                }
+
+                if (numInsts > 0) {
+                    nodes.emplace_back();
+                    buildRec(0,0,(unsigned)numInsts);
+                }
+            }
+
+            void buildRec(unsigned nodeID, unsigned first, unsigned last)
+            {
+                aabb bounds, centroidBounds;
+                bounds.invalidate();
+                centroidBounds.invalidate();
+
+                for (unsigned i=first; i<last; ++i) {
+                    bounds.insert(instances[indices[i]].bounds);
+                    centroidBounds.insert(instances[indices[i]].bounds.center());
+                }
+
+                nodes[nodeID].bounds = bounds;
+
+                if (last-first <= MaxLeafSize) {
+                    nodes[nodeID].first = first;
+                    nodes[nodeID].count = last-first;
+                    return;
+                }
+
+                // Median split along the longest centroid axis
+                vec3f ext = centroidBounds.size();
+                int axis = ext.x > ext.y ? (ext.x > ext.z ? 0 : 2) : (ext.y > ext.z ? 1 : 2);
+                unsigned mid = (first+last)/2;
+                std::nth_element(indices.begin()+first,indices.begin()+mid,indices.begin()+last,
+                                 [this,axis](unsigned a, unsigned b) {
+                                     return instances[a].bounds.center()[axis]
+                                          < instances[b].bounds.center()[axis];
+                                 });
+
+                unsigned left = (unsigned)nodes.size();
+                nodes.emplace_back();
+                nodes.emplace_back();
+                nodes[nodeID].first = left;
+                nodes[nodeID].count = 0;
+
+                buildRec(left,first,mid);
+                buildRec(left+1,mid,last);
+            }
+
+            // func(instID, localRay, tnear, tfar, tmax) is called for each
+            // volume overlapping [tmin,tmax) and returns the new tmax
+            template <typename Func>
+            void traverse(const ray& r, float tmin, float tmax, Func func) const
+            {
+                if (nodes.empty())
+                    return;
+
+                unsigned stack[64];
+                int ptr = 0;
+                stack[ptr++] = 0;
+
+                while (ptr > 0) {
+                    const Node& node = nodes[stack[--ptr]];
+
+                    auto hr = intersect(r,node.bounds);
+                    if (!hr.hit || hr.tnear >= tmax || hr.tfar < tmin)
+                        continue;
+
+                    if (node.count == 0) {
+                        auto hr1 = intersect(r,nodes[node.first].bounds);
+                        auto hr2 = intersect(r,nodes[node.first+1].bounds);
+
+                        // push far child first
+                        if (hr1.tnear <= hr2.tnear) {
+                            stack[ptr++] = node.first+1;
+                            stack[ptr++] = node.first;
+                        } else {
+                            stack[ptr++] = node.first;
+                            stack[ptr++] = node.first+1;
+                        }
+                    } else {
+                        for (unsigned i=node.first; i<node.first+node.count; ++i) {
+                            unsigned instID = indices[i];
+                            ray lr = instances[instID].localRay(r);
+                            auto lhr = intersect(lr,instances[instID].volume->bbox);
+                            float tnear = max(tmin,lhr.tnear);
+                            if (lhr.hit && tnear < tmax && tnear < lhr.tfar)
+                                tmax = func(instID,lr,tnear,lhr.tfar,tmax);
+                        }
+                    }
+                }
+            }
+
+            // Closest interaction over all (possibly overlapping) volumes;
+            // the minimum of the per-volume free-flight distances samples
+            // the combined medium
+            bool sample_interaction(const ray& r, float tmax, float& t, unsigned& instID,
+                                    vec3f& localPos, random_generator<float>& gen) const
+            {
+                bool hit = false;
+
+                traverse(r,0.f,tmax,
+                         [&](unsigned i, const ray& lr, float tnear, float tfar, float tmax) {
+                             float ti;
+                             if (instances[i].volume->sample_interaction(lr,tnear,min(tfar,tmax),ti,gen)) {
+                                 hit = true;
+                                 t = ti;
+                                 instID = i;
+                                 localPos = lr.ori + lr.dir * ti;
+                                 return ti;
+                             }
+                             return tmax;
+                         });
+
+                return hit;
+            }
+
+            // Next volume segment entered after tmin, front-to-back
+            bool next_segment(const ray& r, float tmin, unsigned& instID, ray& localRay,
+                              float& tnear, float& tfar) const
+            {
+                bool found = false;
+
+                traverse(r,tmin,std::numeric_limits<float>::max(),
+                         [&](unsigned i, const ray& lr, float t0, float t1, float) {
+                             found = true;
+                             instID = i;
+                             localRay = lr;
+                             tnear = t0;
+                             tfar = t1;
+                             return t0;
+                         });
+
+                return found;
+            }
+
+            const VolumeInstance* instances = nullptr;
+            aligned_vector<Node> nodes;
+            std::vector<unsigned> indices;
+        };
+
+        inline float luminance(const vec3f& rgb)
+        {
+            return .2126f*rgb.x + .7152f*rgb.y + .0722f*rgb.z;
+        }
+
+        // BVH over the emitters, nodes store bounds and total power. Lights
+        // are sampled by descending the tree and picking children with
+        // probability proportional to their estimated contribution
+        struct LightBVH
+        {
+            struct Node
+            {
+                aabb bounds;
+                float power = 0.f;
+                unsigned first = 0; // left child (inner) or light index (leaf)
+                unsigned count = 0; // 0 for inner nodes
+            };
+
+            // bounds[i] and power[i] belong to light lightIDs[i]
+            void build(const unsigned* ids, const aabb* bounds, const float* power, size_t numLights)
+            {
+                lightIDs = ids;
+                lightBounds = bounds;
+                lightPower = power;
+                nodes.clear();
+                indices.resize(numLights);
+
+                for (size_t i=0; i<numLights; ++i) {
+                    indices[i] = (unsigned)i;
+                }
+
+                if (numLights > 0) {
+                    nodes.emplace_back();
+                    buildRec(0,0,(unsigned)numLights);
+                }
+            }
+
+            void buildRec(unsigned nodeID, unsigned first, unsigned last)
+            {
+                aabb bounds, centroidBounds;
+                bounds.invalidate();
+                centroidBounds.invalidate();
+                float power = 0.f;
+
+                for (unsigned i=first; i<last; ++i) {
+                    bounds.insert(lightBounds[indices[i]]);
+                    centroidBounds.insert(lightBounds[indices[i]].center());
+                    power += lightPower[indices[i]];
+                }
+
+                nodes[nodeID].bounds = bounds;
+                nodes[nodeID].power = power;
+
+                if (last-first == 1) {
+                    nodes[nodeID].first = lightIDs[indices[first]];
+                    nodes[nodeID].count = 1;
+                    return;
+                }
+
+                // Median split along the longest centroid axis
+                vec3f ext = centroidBounds.size();
+                int axis = ext.x > ext.y ? (ext.x > ext.z ? 0 : 2) : (ext.y > ext.z ? 1 : 2);
+                unsigned mid = (first+last)/2;
+                std::nth_element(indices.begin()+first,indices.begin()+mid,indices.begin()+last,
+                                 [this,axis](unsigned a, unsigned b) {
+                                     return lightBounds[a].center()[axis]
+                                          < lightBounds[b].center()[axis];
+                                 });
+
+                unsigned left = (unsigned)nodes.size();
+                nodes.emplace_back();
+                nodes.emplace_back();
+                nodes[nodeID].first = left;
+                nodes[nodeID].count = 0;
+
+                buildRec(left,first,mid);
+                buildRec(left+1,mid,last);
+            }
+
+            // Power over squared distance, the distance is clamped to the
+            // node radius so that nodes containing pos are not overrated
+            static float importance(const Node& node, const vec3f& pos)
+            {
+                vec3f halfSize = node.bounds.size()*.5f;
+                float r2 = dot(halfSize,halfSize);
+                vec3f d = node.bounds.center()-pos;
+                float d2 = fmaxf(dot(d,d),r2);
+                return d2 > 0.f ? node.power/d2 : node.power;
+            }
+
+            // Returns false if there are no lights or none contributes
+            bool sample(const vec3f& pos, random_generator<float>& gen,
+                        unsigned& lightID, float& pdf) const
+            {
+                if (nodes.empty() || nodes[0].power <= 0.f)
+                    return false;
+
+                unsigned nodeID = 0;
+                pdf = 1.f;
+
+                while (nodes[nodeID].count == 0) {
+                    const Node& left = nodes[nodes[nodeID].first];
+                    const Node& right = nodes[nodes[nodeID].first+1];
+
+                    float il = importance(left,pos);
+                    float ir = importance(right,pos);
+
+                    float pl = il+ir > 0.f ? il/(il+ir) : .5f;
+
+                    if (gen.next() < pl) {
+                        nodeID = nodes[nodeID].first;
+                        pdf *= pl;
+                    } else {
+                        nodeID = nodes[nodeID].first+1;
+                        pdf *= 1.f-pl;
+                    }
+                }
+
+                lightID = nodes[nodeID].first;
+                return pdf > 0.f;
+            }
+
+            const unsigned* lightIDs = nullptr;
+            const aabb* lightBounds = nullptr;
+            const float* lightPower = nullptr;
+            aligned_vector<Node> nodes;
+            std::vector<unsigned> indices;
+        };
+
+        typedef index_bvh<basic_triangle<3,float>> TriangleBVH;
+        typedef index_bvh<typename TriangleBVH::bvh_inst> TriangleTLAS;
+
+        typedef index_bvh<basic_sphere<float>> SphereBVH;
+        typedef index_bvh<typename SphereBVH::bvh_inst> SphereTLAS;
+
+        // Cylinder with optional flat caps at either end; the body is
+        // intersected by visionaray, the caps are discs perpendicular to
+        // the axis
+        struct capped_cylinder : basic_cylinder<float>
+        {
+            enum { CapFirst = 1, CapSecond = 2 };
+            unsigned caps = 0;
+        };
+
+        inline auto intersect(const ray& r, const capped_cylinder& cyl)
+        {
+            auto hr = intersect(r,static_cast<const basic_cylinder<float>&>(cyl));
+
+            if (cyl.caps == 0)
+                return hr;
+
+            vec3f axis = normalize(cyl.v2-cyl.v1);
+            float denom = dot(r.dir,axis);
+            if (fabsf(denom) < 1e-12f)
+                return hr;
+
+            auto testCap = [&](const vec3f& center) {
+                float t = dot(center-r.ori,axis)/denom;
+                if (t <= r.tmin || t >= r.tmax || (hr.hit && t >= hr.t))
+                    return;
+
+                vec3f pos = r.ori+r.dir*t;
+                vec3f d = pos-center;
+                if (dot(d,d) <= cyl.radius*cyl.radius) {
+                    hr.hit = true;
+                    hr.t = t;
+                    hr.prim_id = cyl.prim_id;
+                    hr.geom_id = cyl.geom_id;
+                    hr.isect_pos = pos;
+                }
+            };
+
+            if (cyl.caps & capped_cylinder::CapFirst)
+                testCap(cyl.v1);
+
+            if (cyl.caps & capped_cylinder::CapSecond)
+                testCap(cyl.v2);
+
+            return hr;
+        }
+
+        inline aabb get_bounds(const capped_cylinder& cyl)
+        {
+            return get_bounds(static_cast<const basic_cylinder<float>&>(cyl));
+        }
+
+        template <typename HR>
+        inline vec3f get_normal(const HR& hr, const capped_cylinder& cyl)
+        {
+            // Hits on a cap plane (within a small tolerance) are cap hits
+            vec3f axis = cyl.v2-cyl.v1;
+            float len = length(axis);
+            float s = dot(hr.isect_pos-cyl.v1,axis)/(len*len);
+            float eps = 1e-4f;
+
+            if ((cyl.caps & capped_cylinder::CapFirst) && s <= eps)
+                return -axis/len;
+
+            if ((cyl.caps & capped_cylinder::CapSecond) && s >= 1.f-eps)
+                return axis/len;
+
+            return get_normal(hr,static_cast<const basic_cylinder<float>&>(cyl));
+        }
+
+        typedef index_bvh<capped_cylinder> CylinderBVH;
+        typedef index_bvh<typename CylinderBVH::bvh_inst> CylinderTLAS;
+
+        // Compact triangle storage for large meshes: instead of the vertices
+        // and edges (44 bytes per triangle), a primitive only references its
+        // mesh (16 bytes); vertices and indices are read from the geometry's
+        // arrays when intersecting. The arrays are used in place if their
+        // memory stays put until they are destroyed and they hold FLOAT32_VEC3
+        // vertices and UINT32_VEC3 or UINT16_VEC3 indices, else converted
+        struct CompactMesh
+        {
+            CompactMesh() = default;
+            CompactMesh(const CompactMesh&) = delete;
+            CompactMesh& operator=(const CompactMesh&) = delete;
+
+           ~CompactMesh()
+            {
+                clear();
+            }
+
+            void clear()
+            {
+                ReleaseResource(vertexArray);
+                ReleaseResource(indexArray);
+                vertexArray = nullptr;
+                indexArray = nullptr;
+                vertices = indices = nullptr;
+                vertexStride = indexStride = 0;
+                indices16 = false;
+                vertexCopy = aligned_vector<vec3f>();
+                indexCopy = aligned_vector<vec3ui>();
+            }
+
+            // Reference or convert the arrays, and keep them alive
+            void reset(ArrayStorage* vertex, ArrayStorage* index)
+            {
+                clear();
+
+                if (vertex->isDataStable() && vertex->elementType == ANARI_FLOAT32_VEC3) {
+                    vertices = vertex->internalData;
+                    vertexStride = vertex->getElementStride();
+                    vertexArray = vertex->getResourceHandle();
+                    RetainResource(vertexArray);
+                } else {
+                    vertexCopy.resize(vertex->getNumElements());
+                    vertex->convert(ANARI_FLOAT32_VEC3,vertexCopy.data());
+                    vertices = (const uint8_t*)vertexCopy.data();
+                    vertexStride = sizeof(vec3f);
+                }
+
+                if (index == nullptr)
+                    return;
+
+                if (index->isDataStable() && (index->elementType == ANARI_UINT32_VEC3
+                                           || index->elementType == ANARI_UINT16_VEC3)) {
+                    indices = index->internalData;
+                    indexStride = index->getElementStride();
+                    indices16 = index->elementType == ANARI_UINT16_VEC3;
+                    indexArray = index->getResourceHandle();
+                    RetainResource(indexArray);
+                } else {
+                    indexCopy.resize(index->getNumElements());
+                    index->convert(ANARI_UINT32_VEC3,indexCopy.data());
+                    indices = (const uint8_t*)indexCopy.data();
+                    indexStride = sizeof(vec3ui);
+                }
+            }
+
+            vec3ui triangle(unsigned i) const
+            {
+                if (indices == nullptr)
+                    return vec3ui(i*3,i*3+1,i*3+2);
+
+                const uint8_t* idx = indices+size_t(i)*indexStride;
+                if (indices16)
+                    return vec3ui(((const uint16_t*)idx)[0],((const uint16_t*)idx)[1],((const uint16_t*)idx)[2]);
+                else
+                    return vec3ui(((const uint32_t*)idx)[0],((const uint32_t*)idx)[1],((const uint32_t*)idx)[2]);
+            }
+
+            vec3f vertex(unsigned i) const
+            {
+                return *(const vec3f*)(vertices+size_t(i)*vertexStride);
+            }
+
+            // Bytes owned by the mesh (not by the arrays)
+            size_t getSizeInBytes() const
+            {
+                return vertexCopy.size()*sizeof(vec3f)+indexCopy.size()*sizeof(vec3ui);
+            }
+
+            const uint8_t* vertices = nullptr;
+            size_t vertexStride = 0;
+            const uint8_t* indices = nullptr; // null: consecutive vertices
+            size_t indexStride = 0;
+            bool indices16 = false;
+
+            ResourceHandle vertexArray = nullptr; // retained if used in place
+            ResourceHandle indexArray = nullptr;
+            aligned_vector<vec3f> vertexCopy;
+            aligned_vector<vec3ui> indexCopy;
+        };
+
+        struct compact_triangle : primitive<unsigned>
+        {
+            const CompactMesh* mesh;
+        };
+
+        inline basic_triangle<3,float> decompress(const compact_triangle& tri)
+        {
+            vec3ui idx = tri.mesh->triangle(tri.prim_id);
+
+            vec3f v1 = tri.mesh->vertex(idx.x);
+            vec3f v2 = tri.mesh->vertex(idx.y);
+            vec3f v3 = tri.mesh->vertex(idx.z);
+
+            basic_triangle<3,float> result(v1,v2-v1,v3-v1);
+            result.prim_id = tri.prim_id;
+            result.geom_id = tri.geom_id;
+            return result;
+        }
+
+        inline hit_record<ray,primitive<unsigned>> intersect(const ray& r, const compact_triangle& tri)
+        {
+            return intersect(r,decompress(tri));
+        }
+
+        inline aabb get_bounds(const compact_triangle& tri)
+        {
+            return get_bounds(decompress(tri));
+        }
+
+        template <typename HR>
+        inline vec3f get_normal(const HR& hr, const compact_triangle& tri)
+        {
+            basic_triangle<3,float> t = decompress(tri);
+            return normalize(cross(t.e1,t.e2));
+        }
+
+        typedef index_bvh<compact_triangle> CompactTriangleBVH;
+        typedef index_bvh<typename CompactTriangleBVH::bvh_inst> CompactTriangleTLAS;
+
+        // Parallelogram at v1, spanned by e1 and e2
+        struct basic_quad : primitive<unsigned>
+        {
+            vec3f v1;
+            vec3f e1;
+            vec3f e2;
+        };
+
+        inline hit_record<ray,primitive<unsigned>> intersect(const ray& r, const basic_quad& quad)
+        {
+            hit_record<ray,primitive<unsigned>> result;
+            result.hit = false;
+
+            vec3f s1 = cross(r.dir,quad.e2);
+            float div = dot(s1,quad.e1);
+
+            if (div == 0.f)
+                return result;
+
+            float invDiv = 1.f/div;
+
+            vec3f d = r.ori-quad.v1;
+            float b1 = dot(d,s1)*invDiv;
+
+            vec3f s2 = cross(d,quad.e1);
+            float b2 = dot(r.dir,s2)*invDiv;
+
+            result.hit = b1 >= 0.f && b1 <= 1.f && b2 >= 0.f && b2 <= 1.f;
+            result.t = dot(quad.e2,s2)*invDiv;
+            result.prim_id = quad.prim_id;
+            result.geom_id = quad.geom_id;
+            result.u = b1;
+            result.v = b2;
+
+            return result;
+        }
+
+        inline aabb get_bounds(const basic_quad& quad)
+        {
+            aabb result;
+            result.invalidate();
+            result.insert(quad.v1);
+            result.insert(quad.v1+quad.e1);
+            result.insert(quad.v1+quad.e2);
+            result.insert(quad.v1+quad.e1+quad.e2);
+            return result;
+        }
+
+        typedef index_bvh<basic_quad> QuadBVH;
+        typedef index_bvh<typename QuadBVH::bvh_inst> QuadTLAS;
+
+        // Area light for quads; sampled uniformly by area, pdf is returned
+        // w.r.t. solid angle as seen from the reference point
+        struct QuadLight
+        {
+            QuadLight() = default;
+
+            explicit QuadLight(const basic_quad& q)
+                : quad(q)
+            {
+            }
+
+            VSNRAY_FUNC
+            vec3f intensity(const vec3f& pos) const
+            {
+                return cl*kl;
+            }
+
+            template <typename Generator>
+            VSNRAY_FUNC
+            light_sample<float> sample(const vec3f& refPoint, Generator& gen) const
+            {
+                light_sample<float> result;
+
+                float u1 = gen.next();
+                float u2 = gen.next();
+                vec3f pos = quad.v1 + quad.e1 * u1 + quad.e2 * u2;
+
+                vec3f n = cross(quad.e1,quad.e2);
+                float area = length(n);
+                n /= area;
+
+                result.dir = pos-refPoint;
+                result.dist = length(result.dir);
+                result.delta_light = false;
+
+                float cosl = dot(n,-result.dir/result.dist);
+
+                if (side == Light::Side::Both)
+                    cosl = fabsf(cosl);
+                else if (side == Light::Side::Back)
+                    cosl = -cosl;
+
+                if (cosl <= 0.f || area <= 0.f) {
+                    result.intensity = vec3f(0.f);
+                    result.pdf = 0.f;
+                    return result;
+                }
+
+                result.intensity = intensity(pos);
+                result.pdf = (result.dist*result.dist)/(cosl*area);
+                return result;
+            }
+
+            // Emitted radiance along a ray with direction dir that hits
+            // the quad; zero when the ray hits a non-emitting side
+            VSNRAY_FUNC
+            vec3f radiance(const vec3f& dir) const
+            {
+                float cosl = dot(cross(quad.e1,quad.e2),-dir);
+
+                if (side == Light::Side::Both)
+                    cosl = fabsf(cosl);
+                else if (side == Light::Side::Back)
+                    cosl = -cosl;
+
+                return cosl > 0.f ? intensity(quad.v1) : vec3f(0.f);
+            }
+
+            VSNRAY_FUNC
+            vec3f position() const
+            {
+                return quad.v1 + (quad.e1+quad.e2) * .5f;
+            }
+
+            basic_quad geometry() const
+            {
+                return quad;
+            }
+
+            void set_cl(const vec3f& c)
+            {
+                cl = c;
+            }
+
+            void set_kl(float k)
+            {
+                kl = k;
+            }
+
+            basic_quad quad;
+            vec3f cl{1.f,1.f,1.f};
+            float kl = 1.f;
+            Light::Side side = Light::Side::Front;
+        };
+
+        // Delta light at infinity: one shadow ray, no attenuation
+        struct DirectionalLight
+        {
+            void reset(const Light& light)
+            {
+                dir = normalize(light.asDirectionalLight.direction);
+                irradiance = light.color*light.asDirectionalLight.irradiance;
+            }
+
+            VSNRAY_FUNC
+            vec3f intensity(const vec3f& pos) const
+            {
+                return irradiance;
+            }
+
+            template <typename Generator>
+            VSNRAY_FUNC
+            light_sample<float> sample(const vec3f& refPoint, Generator& gen) const
+            {
+                light_sample<float> result;
+                result.dir = -dir;
+                result.dist = std::numeric_limits<float>::max();
+                result.intensity = irradiance;
+                result.pdf = 1.f;
+                result.delta_light = true;
+                return result;
+            }
+
+            VSNRAY_FUNC
+            vec3f position() const
+            {
+                return vec3f(0.f);
+            }
+
+            vec3f dir{0.f,0.f,-1.f}; // direction the light travels
+            vec3f irradiance{1.f,1.f,1.f};
         };
 
-        struct StructuredVolumeRef
+        // Environment light with an equirectangular map; row 0 is at the
+        // up direction, the center of the map at direction. Directions are
+        // importance sampled proportional to luminance times sin(theta)
+        struct HDRILight
         {
-            texture_ref<float, 3> texture3f;
-            texture_ref<vec4f, 1> textureRGBA;
-
-            aabb bbox;
-            float mu_ = 1.f;
+            void reset(const Light& light)
+            {
+                up = normalize(light.asHDRILight.up);
+                dir = light.asHDRILight.direction;
+                dir = normalize(dir-up*dot(dir,up));
+                side = cross(up,dir);
+                scale = light.color*light.asHDRILight.scale;
+                width = light.asHDRILight.width;
+                height = light.asHDRILight.height;
+                texels = light.asHDRILight.radiance.data();
+                marginal = light.asHDRILight.marginal.data();
+                conditional = light.asHDRILight.conditional.data();
+            }
 
             VSNRAY_FUNC
-            vec3 albedo(vec3 const& pos)
+            vec3f radiance(const vec3f& d) const
             {
-                float voxel = (float)tex3D(texture3f, pos / bbox.size());
-
-                // normalize to [0..1]
-                //voxel = normalize(volume, voxel);
+                float cosTheta = clamp(dot(d,up),-1.f,1.f);
+                float phi = atan2f(dot(d,side),dot(d,dir));
+                float u = phi/(2.f*constants::pi<float>())+.5f;
+                float v = acosf(cosTheta)/constants::pi<float>();
+                int x = clamp((int)(u*width),0,width-1);
+                int y = clamp((int)(v*height),0,height-1);
+                return texels[y*width+x]*scale;
+            }
 
-                vec4f rgba = tex1D(textureRGBA, voxel);
-                return rgba.xyz();
+            // Not meaningful for environment lights
+            VSNRAY_FUNC
+            vec3f intensity(const vec3f& pos) const
+            {
+                return scale;
             }
 
+            template <typename Generator>
             VSNRAY_FUNC
-            float mu(vec3 const& pos)
+            light_sample<float> sample(const vec3f& refPoint, Generator& gen) const
             {
-                float voxel = (float)tex3D(texture3f, pos / bbox.size());
+                light_sample<float> result;
 
-                // normalize to [0..1]
-                //voxel = normalize(volume, voxel);
+                unsigned y = sampleAliasTable(marginal,height,gen.next());
+                unsigned x = sampleAliasTable(conditional+y*width,width,gen.next());
+
+                float u = (x+gen.next())/width;
+                float v = (y+gen.next())/height;
+
+                float theta = v*constants::pi<float>();
+                float phi = (u-.5f)*2.f*constants::pi<float>();
+                float sinTheta = sinf(theta);
 
-                vec4f rgba = tex1D(textureRGBA, voxel);
-                return rgba.w;
+                result.dir = dir*(sinTheta*cosf(phi)) + side*(sinTheta*sinf(phi)) + up*cosf(theta);
+                result.dist = std::numeric_limits<float>::max();
+                result.delta_light = false;
+
+                if (sinTheta <= 0.f) {
+                    result.intensity = vec3f(0.f);
+                    result.pdf = 0.f;
+                    return result;
+                }
+
+                // pdf on the unit square, converted to solid angle
+                float pdfUV = marginal[y].pdf*height * conditional[y*width+x].pdf*width;
+                result.pdf = pdfUV/(2.f*constants::pi<float>()*constants::pi<float>()*sinTheta);
+                result.intensity = texels[y*width+x]*scale;
+                return result;
             }
 
-            template <typename Ray>
             VSNRAY_FUNC
-            bool sample_interaction(Ray& r, float d, random_generator<float>& gen)
+            vec3f position() const
             {
-                float t = 0.0f;
-                vec3 pos;
+                return vec3f(0.f);
+            }
 
-                do
-                {
-                    t -= log(1.0f - gen.next()) / mu_;
+            vec3f up;
+            vec3f dir;
+            vec3f side;
+            vec3f scale;
+            int width = 0;
+            int height = 0;
+            const vec3f* texels = nullptr;
+            const AliasEntry* marginal = nullptr;
+            const AliasEntry* conditional = nullptr;
+        };
 
-                    pos = r.ori + r.dir * t;
-                    if (t >= d)
-                    {
-                        return false;
+        template <typename P, typename = void>
+        struct IsBVHInst : std::false_type {};
+
+        template <typename P>
+        struct IsBVHInst<P,std::void_t<decltype(std::declval<P>().get_ref())>> : std::true_type {};
+
+        // 4-wide BVH collapsed from a binary one after building. The child
+        // boxes of a node are stored as SoA and tested against the ray with
+        // one SIMD operation. Leaves keep the primitive ranges of the binary
+        // leaves, so primitive_list_index means the same for both. Collapsed
+        // TLASes descend into the collapsed BLASes of their instances from
+        // their own leaf loop, so both levels are traversed four-wide
+        struct WideBVH
+        {
+            enum { Width = 4 };
+
+            // Every level pushes at most Width-1 more nodes than it pops
+            enum { StackSize = 128 };
+
+            struct Children
+            {
+                unsigned first[Width]; // wide child (inner) or first primitive (leaf)
+                unsigned count[Width]; // 0 for inner children
+                unsigned numChildren = 0;
+            };
+
+            struct Node
+            {
+                VSNRAY_ALIGN(16) float minX[Width];
+                VSNRAY_ALIGN(16) float minY[Width];
+                VSNRAY_ALIGN(16) float minZ[Width];
+                VSNRAY_ALIGN(16) float maxX[Width];
+                VSNRAY_ALIGN(16) float maxY[Width];
+                VSNRAY_ALIGN(16) float maxZ[Width];
+                Children children;
+            };
+
+            // Child boxes in 8 bits per plane, relative to the union of the
+            // children and in units of a power of two per axis, rounded
+            // outwards (like compressed wide BVHs); 76 instead of 144 bytes
+            struct QuantizedNode
+            {
+                vec3f origin;
+                int8_t exponent[3];
+                uint8_t qmin[3][Width];
+                uint8_t qmax[3][Width];
+                Children children;
+            };
+
+            // Returns false (and stays empty) if the BVH is too deep for the
+            // traversal stack; the binary BVH must then be used instead
+            template <typename BVHRef>
+            bool build(const BVHRef& bvh, bool quantize = false)
+            {
+                nodes.clear();
+                quantizedNodes.clear();
+                blases.clear();
+                depth = 0;
+
+                if (bvh.num_nodes() > 0) {
+                    nodes.emplace_back();
+                    collapseRec(bvh,0,0,1);
+                }
+
+                if ((Width-1)*depth+1 > StackSize) {
+                    nodes.clear();
+                    depth = 0;
+                    return false;
+                }
+
+                if (quantize) {
+                    quantizedNodes.resize(nodes.size());
+                    for (size_t i=0; i<nodes.size(); ++i) {
+                        quantizedNodes[i] = quantizeNode(nodes[i]);
                     }
+                    nodes = aligned_vector<Node>();
                 }
-                while (mu(pos) < gen.next() * mu_);
 
-                r.ori = pos;
                 return true;
             }
 
-            VSNRAY_FUNC
-            inline vec3f gradient(vec3f texCoord, vec3f delta)
+            static QuantizedNode quantizeNode(const Node& node)
+            {
+                QuantizedNode result;
+                result.children = node.children;
+
+                const float* mins[3] = { node.minX, node.minY, node.minZ };
+                const float* maxs[3] = { node.maxX, node.maxY, node.maxZ };
+
+                for (int a=0; a<3; ++a) {
+                    float lo = std::numeric_limits<float>::max();
+                    float hi = -std::numeric_limits<float>::max();
+                    for (unsigned i=0; i<node.children.numChildren; ++i) {
+                        lo = std::min(lo,mins[a][i]);
+                        hi = std::max(hi,maxs[a][i]);
+                    }
+
+                    // Smallest power of two that covers the extent in 255 steps
+                    int e = -126;
+                    if (hi > lo)
+                        e = std::max(e,(int)ceilf(log2f((hi-lo)/255.f)));
+                    e = std::min(e,127);
+                    while (e < 127 && lo+255.f*exponentToScale(e) < hi)
+                        ++e;
+
+                    float scale = exponentToScale(e);
+                    result.origin[a] = lo;
+                    result.exponent[a] = (int8_t)e;
+
+                    for (unsigned i=0; i<Width; ++i) {
+                        if (i >= node.children.numChildren) {
+                            result.qmin[a][i] = result.qmax[a][i] = 0;
+                            continue;
+                        }
+
+                        int qlo = (int)floorf((mins[a][i]-lo)/scale);
+                        int qhi = (int)ceilf((maxs[a][i]-lo)/scale);
+                        qlo = std::max(0,std::min(255,qlo));
+                        qhi = std::max(0,std::min(255,qhi));
+
+                        // Make sure rounding in the dequantization never
+                        // shrinks the box
+                        while (qlo > 0 && lo+qlo*scale > mins[a][i])
+                            --qlo;
+                        while (qhi < 255 && lo+qhi*scale < maxs[a][i])
+                            ++qhi;
+
+                        result.qmin[a][i] = (uint8_t)qlo;
+                        result.qmax[a][i] = (uint8_t)qhi;
+                    }
+                }
+
+                return result;
+            }
+
+            // 2^e for e in [-126,127], built from the float's bits
+            static float exponentToScale(int e)
             {
-                return vec3f(+tex3D(texture3f,vec3f(texCoord.x+delta.x,texCoord.y,texCoord.z))
-                             -tex3D(texture3f,vec3f(texCoord.x-delta.x,texCoord.y,texCoord.z)),
-                             +tex3D(texture3f,vec3f(texCoord.x,texCoord.y+delta.y,texCoord.z))
-                             -tex3D(texture3f,vec3f(texCoord.x,texCoord.y-delta.y,texCoord.z)),
-                             +tex3D(texture3f,vec3f(texCoord.x,texCoord.y,texCoord.z+delta.z))
-                             -tex3D(texture3f,vec3f(texCoord.x,texCoord.y,texCoord.z-delta.z)));
+                uint32_t bits = uint32_t(e+127)<<23;
+                float scale;
+                memcpy(&scale,&bits,sizeof(scale));
+                return scale;
             }
-        };
 
-        struct StructuredVolume
-        {
-            using SP = std::shared_ptr<StructuredVolume>;
+            static simd::float4 dequantize(float origin, int8_t exponent, const uint8_t (&q)[Width])
+            {
+                return simd::float4(origin)
+                     + simd::float4((float)q[0],(float)q[1],(float)q[2],(float)q[3])
+                     * simd::float4(exponentToScale(exponent));
+            }
 
-            void reset(generic::Volume& volume)
+            // For TLASes: look up the collapsed BLAS of each instance, by
+            // primitive index; instances without one use the binary BLAS
+            template <typename TLASRef, typename Lookup>
+            void attachBLASes(const TLASRef& tlas, Lookup lookup)
             {
-                handle = (ANARIVolume)volume.getResourceHandle();
+                blases.resize(tlas.num_primitives());
+                for (size_t i=0; i<blases.size(); ++i) {
+                    blases[i] = lookup(tlas.primitive(i));
+                }
+            }
+
+            template <typename BVHRef>
+            void collapseRec(const BVHRef& bvh, unsigned wideID, unsigned binaryID, unsigned level)
+            {
+                depth = std::max(depth,level);
+
+                unsigned children[Width];
+                unsigned numChildren = 0;
 
-                ANARISpatialField f = volume.field;
-                StructuredRegular* sr = (StructuredRegular*)GetResource(f);
-                ANARIArray3D d = sr->data;
-                if (d != handle3f) { // new volume data!
-                    Array3D* data = (Array3D*)GetResource(d);
+                if (bvh.node(binaryID).is_leaf()) {
+                    children[numChildren++] = binaryID;
+                } else {
+                    children[numChildren++] = bvh.node(binaryID).get_first_child();
+                    children[numChildren++] = bvh.node(binaryID).get_first_child()+1;
+                }
 
-                    storage3f = texture<float, 3>((unsigned)data->numItems[0],
-                                                  (unsigned)data->numItems[1],
-                                                  (unsigned)data->numItems[2]);
-                    storage3f.reset((const float*)data->internalData);
-                    storage3f.set_filter_mode(Linear);
-                    storage3f.set_address_mode(Clamp);
+                // Pull grandchildren up, always opening the inner child with
+                // the largest surface area, until the node is full
+                while (numChildren < Width) {
+                    int best = -1;
+                    float bestArea = -1.f;
+
+                    for (unsigned i=0; i<numChildren; ++i) {
+                        const auto& n = bvh.node(children[i]);
+                        if (n.is_leaf())
+                            continue;
 
-                    ref.texture3f = texture_ref<float, 3>(storage3f);
+                        vec3f s = n.get_bounds().size();
+                        float area = s.x*s.y+s.y*s.z+s.z*s.x;
+                        if (area > bestArea) {
+                            best = (int)i;
+                            bestArea = area;
+                        }
+                    }
 
-                    ref.bbox = aabb({0.f,0.f,0.f},{(float)data->numItems[0],(float)data->numItems[1],(float)data->numItems[2]});
+                    if (best < 0)
+                        break;
 
-                    handle3f = d;
+                    unsigned first = bvh.node(children[best]).get_first_child();
+                    children[best] = first;
+                    children[numChildren++] = first+1;
                 }
 
-                ANARIArray1D color = volume.color;
-                ANARIArray1D opacity = volume.opacity;
+                nodes[wideID].children.numChildren = numChildren;
 
-                if (color != handleRGB || opacity != handleA) { // TF changed
-                    Array1D* rgb = (Array1D*)GetResource(color);
-                    Array1D* a = (Array1D*)GetResource(opacity);
+                for (unsigned i=0; i<Width; ++i) {
+                    // Empty slots get inverted boxes that are never hit
+                    aabb bounds(vec3f(std::numeric_limits<float>::max()),
+                                vec3f(-std::numeric_limits<float>::max()));
 
-                    aligned_vector<vec4f> rgba(rgb->numItems[0]);
-                    for (uint64_t i = 0; i < rgb->numItems[0]; ++i) {
-                        vec4f val(((vec3f*)rgb->internalData)[i],((float*)a->internalData)[i]);
-                        rgba[i] = val;
+                    if (i < numChildren)
+                        bounds = bvh.node(children[i]).get_bounds();
+
+                    nodes[wideID].minX[i] = bounds.min.x;
+                    nodes[wideID].minY[i] = bounds.min.y;
+                    nodes[wideID].minZ[i] = bounds.min.z;
+                    nodes[wideID].maxX[i] = bounds.max.x;
+                    nodes[wideID].maxY[i] = bounds.max.y;
+                    nodes[wideID].maxZ[i] = bounds.max.z;
+                    nodes[wideID].children.first[i] = 0;
+                    nodes[wideID].children.count[i] = 0;
+                }
+
+                for (unsigned i=0; i<numChildren; ++i) {
+                    const auto& n = bvh.node(children[i]);
+
+                    if (n.is_leaf()) {
+                        nodes[wideID].children.first[i] = n.get_first_primitive();
+                        nodes[wideID].children.count[i] = n.get_num_primitives();
+                    } else {
+                        unsigned childID = (unsigned)nodes.size();
+                        nodes.emplace_back();
+                        nodes[wideID].children.first[i] = childID;
+                        collapseRec(bvh,childID,children[i],level+1);
+                    }
+                }
+            }
+
+            // Closest hit over the primitives of bvh, which must be the BVH
+            // the nodes were collapsed from
+            template <typename HR, typename BVHRef>
+            HR closest_hit(const ray& r, const BVHRef& bvh) const
+            {
+                HR result;
+                result.hit = false;
+                result.t = std::numeric_limits<float>::max();
+
+                if (nodes.empty() && quantizedNodes.empty())
+                    return result;
+
+                bool quantized = !quantizedNodes.empty();
+
+                vec3f invDir = vec3f(1.f)/r.dir;
+
+                simd::float4 oriX(r.ori.x), oriY(r.ori.y), oriZ(r.ori.z);
+                simd::float4 invX(invDir.x), invY(invDir.y), invZ(invDir.z);
+
+                unsigned stack[StackSize];
+                int ptr = 0;
+                stack[ptr++] = 0;
+
+                while (ptr > 0) {
+                    assert(ptr <= StackSize);
+
+                    unsigned nodeID = stack[--ptr];
+
+                    simd::float4 minX, minY, minZ, maxX, maxY, maxZ;
+
+                    if (quantized) {
+                        const QuantizedNode& qn = quantizedNodes[nodeID];
+                        minX = dequantize(qn.origin.x,qn.exponent[0],qn.qmin[0]);
+                        minY = dequantize(qn.origin.y,qn.exponent[1],qn.qmin[1]);
+                        minZ = dequantize(qn.origin.z,qn.exponent[2],qn.qmin[2]);
+                        maxX = dequantize(qn.origin.x,qn.exponent[0],qn.qmax[0]);
+                        maxY = dequantize(qn.origin.y,qn.exponent[1],qn.qmax[1]);
+                        maxZ = dequantize(qn.origin.z,qn.exponent[2],qn.qmax[2]);
+                    } else {
+                        const Node& n = nodes[nodeID];
+                        minX = simd::float4(n.minX);
+                        minY = simd::float4(n.minY);
+                        minZ = simd::float4(n.minZ);
+                        maxX = simd::float4(n.maxX);
+                        maxY = simd::float4(n.maxY);
+                        maxZ = simd::float4(n.maxZ);
                     }
 
-                    storageRGBA = texture<vec4f, 1>(rgb->numItems[0]);
-                    storageRGBA.reset(rgba.data());
-                    storageRGBA.set_filter_mode(Linear);
-                    storageRGBA.set_address_mode(Clamp);
+                    const Children& node = quantized ? quantizedNodes[nodeID].children
+                                                     : nodes[nodeID].children;
 
-                    ref.textureRGBA = texture_ref<vec4f, 1>(storageRGBA);
+                    simd::float4 tx1 = (minX-oriX)*invX;
+                    simd::float4 tx2 = (maxX-oriX)*invX;
+                    simd::float4 ty1 = (minY-oriY)*invY;
+                    simd::float4 ty2 = (maxY-oriY)*invY;
+                    simd::float4 tz1 = (minZ-oriZ)*invZ;
+                    simd::float4 tz2 = (maxZ-oriZ)*invZ;
 
-                    handleRGB = color;
-                    handleA = opacity;
+                    simd::float4 tnear = max(max(min(tx1,tx2),min(ty1,ty2)),
+                                             max(min(tz1,tz2),simd::float4(r.tmin)));
+                    simd::float4 tfar = min(min(max(tx1,tx2),max(ty1,ty2)),
+                                            min(max(tz1,tz2),simd::float4(min(r.tmax,result.t))));
+
+                    VSNRAY_ALIGN(16) float dist[Width];
+                    store(dist,select(tnear <= tfar,tnear,simd::float4(std::numeric_limits<float>::max())));
+
+                    // Children that were hit, near to far
+                    unsigned order[Width];
+                    unsigned numHit = 0;
+
+                    for (unsigned i=0; i<node.numChildren; ++i) {
+                        if (dist[i] == std::numeric_limits<float>::max())
+                            continue;
+
+                        unsigned j = numHit++;
+                        for (; j>0 && dist[order[j-1]] > dist[i]; --j)
+                            order[j] = order[j-1];
+                        order[j] = i;
+                    }
+
+                    // Push inner children far first, intersect leaves right
+                    // away; their hits prune the pushed nodes when popped
+                    for (unsigned k=numHit; k>0; --k) {
+                        unsigned i = order[k-1];
+                        if (node.count[i] == 0)
+                            stack[ptr++] = node.first[i];
+                    }
+
+                    for (unsigned k=0; k<numHit; ++k) {
+                        unsigned i = order[k];
+                        for (unsigned p=node.first[i]; p<node.first[i]+node.count[i]; ++p) {
+                            auto hr = intersectPrimitive(r,bvh,p,result.t);
+                            if (hr.hit && hr.t > r.tmin && hr.t < r.tmax && hr.t < result.t) {
+                                static_cast<decltype(hr)&>(result) = hr;
+                                result.primitive_list_index = p;
+                            }
+                        }
+                    }
                 }
+
+                return result;
             }
 
-            texture<float, 3> storage3f;
-            texture<vec4f, 1> storageRGBA;
+            template <typename BVHRef>
+            auto intersectPrimitive(const ray& r, const BVHRef& bvh, unsigned p, float tmax) const
+            {
+                const auto& prim = bvh.primitive(p);
 
-            StructuredVolumeRef ref;
+                if constexpr (IsBVHInst<std::decay_t<decltype(prim)>>::value) {
+                    if (p < blases.size() && blases[p] != nullptr)
+                        return blases[p]->closest_hit_inst(r,prim,tmax);
+                }
 
-            ANARIVolume handle = nullptr;
-            ANARIArray3D handle3f = nullptr;
-            ANARIArray1D handleRGB = nullptr;
-            ANARIArray1D handleA = nullptr;
-        };
+                return intersect(r,prim);
+            }
 
-        typedef index_bvh<basic_triangle<3,float>> TriangleBVH;
-        typedef index_bvh<typename TriangleBVH::bvh_inst> TriangleTLAS;
+            // Closest hit with an instance of the BVH the nodes were
+            // collapsed from, closer than tmax; same as intersect(r,inst),
+            // which traverses the binary BVH
+            template <typename Inst>
+            auto closest_hit_inst(const ray& r, const Inst& inst, float tmax) const
+            {
+                using BLASHitRecord = hit_record_bvh<ray,hit_record<ray,primitive<unsigned>>>;
+
+                ray lr = r;
+                lr.ori = inst.affine_inv()*(r.ori+inst.trans_inv());
+                lr.dir = inst.affine_inv()*r.dir;
+                lr.tmax = min(r.tmax,tmax);
+
+                BLASHitRecord bhr = closest_hit<BLASHitRecord>(lr,inst.get_ref());
+
+                // The transformation is affine, so t is the same in world
+                // and object space
+                decltype(intersect(r,inst)) result;
+                static_cast<BLASHitRecord&>(result) = bhr;
+                result.inst_id = inst.get_inst_id();
+                result.isect_pos = r.ori+r.dir*bhr.t;
+                return result;
+            }
 
-        typedef index_bvh<basic_sphere<float>> SphereBVH;
-        typedef index_bvh<typename SphereBVH::bvh_inst> SphereTLAS;
+            size_t getSizeInBytes() const
+            {
+                return nodes.size()*sizeof(Node)
+                     + quantizedNodes.size()*sizeof(QuantizedNode)
+                     + blases.size()*sizeof(const WideBVH*);
+            }
 
-        typedef index_bvh<basic_cylinder<float>> CylinderBVH;
-        typedef index_bvh<typename CylinderBVH::bvh_inst> CylinderTLAS;
+            // Either nodes or quantizedNodes is used
+            aligned_vector<Node> nodes;
+            aligned_vector<QuantizedNode> quantizedNodes;
+            aligned_vector<const WideBVH*> blases; // TLASes only, may be empty
+            unsigned depth = 0;
+        };
+
+        // Collapse the TLASes of worlds into wide BVHs; set on the device
+        static std::atomic<bool> useWideBVH{false};
 
         // Primitive type that wraps BVH instances
         struct TLASes
         {
             TriangleTLAS::bvh_ref triangleTLAS;
+            CompactTriangleTLAS::bvh_ref compactTriangleTLAS;
             SphereTLAS::bvh_ref sphereTLAS;
             CylinderTLAS::bvh_ref cylinderTLAS;
             SphereTLAS::bvh_ref sphericalLightTLAS;
-            TriangleTLAS::bvh_ref triangleLightTLAS;
+            QuadTLAS::bvh_ref quadLightTLAS;
+
+            // Wide versions of the surface TLASes, or null
+            const WideBVH* wideTriangleTLAS = nullptr;
+            const WideBVH* wideCompactTriangleTLAS = nullptr;
+            const WideBVH* wideSphereTLAS = nullptr;
+            const WideBVH* wideCylinderTLAS = nullptr;
         };
 
         typedef generic_material<emissive<float>,matte<float>> GenericMaterial;
         typedef area_light<float,basic_sphere<float>> SphericalLight;
-        typedef area_light<float,basic_triangle<3,float>> TriangleLight;
-        typedef generic_light<point_light<float>,spot_light<float>,SphericalLight,TriangleLight> GenericLight;
+        typedef generic_light<point_light<float>,spot_light<float>,SphericalLight,QuadLight,DirectionalLight,HDRILight> GenericLight;
 
         typedef kernel_params<
             unspecified_binding,
@@ -339,7 +3197,7 @@ namespace generic {
 
         typedef hit_record_bvh<ray,hit_record_bvh_inst<ray,hit_record<ray,primitive<unsigned>>>> BaseHitRecord;
 
-        enum class BVHType { Triangles, Spheres, Cylinders, SphericalLights, TriangleLights, };
+        enum class BVHType { Triangles, CompactTriangles, Spheres, Cylinders, SphericalLights, QuadLights, };
         struct HitRecord : BaseHitRecord
         {
             BVHType bvhType;
@@ -377,6 +3235,8 @@ namespace generic {
 
             if (hr.bvhType == BVHType::Triangles)
                 n = get_normal(baseHR,tlases.triangleTLAS);
+            else if (hr.bvhType == BVHType::CompactTriangles)
+                n = get_normal(baseHR,tlases.compactTriangleTLAS);
             else if (hr.bvhType == BVHType::Spheres)
                 n = get_normal(baseHR,tlases.sphereTLAS);
             else if (hr.bvhType == BVHType::Cylinders) {
@@ -412,27 +3272,43 @@ namespace generic {
             return surface<vec3f,vec3f,GenericMaterial>{n,n,texColor,material};
         }
 
+        template <typename TLAS>
+        inline BaseHitRecord closestHit(const ray& r, const TLAS& tlas, const WideBVH* wide)
+        {
+            if (wide != nullptr)
+                return wide->closest_hit<BaseHitRecord>(r,tlas);
+
+            return closest_hit(r,&tlas,&tlas+1);
+        }
+
         inline HitRecord intersect(ray r, const TLASes& tlases)
         {
             HitRecord hr;
 
             if (tlases.triangleTLAS.num_primitives() > 0) {
                 HitRecord triangleHR;
-                *((BaseHitRecord*)&triangleHR) = closest_hit(r,&tlases.triangleTLAS,&tlases.triangleTLAS+1);
+                *((BaseHitRecord*)&triangleHR) = closestHit(r,tlases.triangleTLAS,tlases.wideTriangleTLAS);
                 triangleHR.bvhType = BVHType::Triangles;
                 update_if(hr,triangleHR,is_closer(triangleHR,hr));
             }
 
+            if (tlases.compactTriangleTLAS.num_primitives() > 0) {
+                HitRecord compactTriangleHR;
+                *((BaseHitRecord*)&compactTriangleHR) = closestHit(r,tlases.compactTriangleTLAS,tlases.wideCompactTriangleTLAS);
+                compactTriangleHR.bvhType = BVHType::CompactTriangles;
+                update_if(hr,compactTriangleHR,is_closer(compactTriangleHR,hr));
+            }
+
             if (tlases.sphereTLAS.num_primitives() > 0) {
                 HitRecord sphereHR;
-                *((BaseHitRecord*)&sphereHR) = closest_hit(r,&tlases.sphereTLAS,&tlases.sphereTLAS+1);
+                *((BaseHitRecord*)&sphereHR) = closestHit(r,tlases.sphereTLAS,tlases.wideSphereTLAS);
                 sphereHR.bvhType = BVHType::Spheres;
                 update_if(hr,sphereHR,is_closer(sphereHR,hr));
             }
 
             if (tlases.cylinderTLAS.num_primitives() > 0) {
                 HitRecord cylinderHR;
-                *((BaseHitRecord*)&cylinderHR) = closest_hit(r,&tlases.cylinderTLAS,&tlases.cylinderTLAS+1);
+                *((BaseHitRecord*)&cylinderHR) = closestHit(r,tlases.cylinderTLAS,tlases.wideCylinderTLAS);
                 cylinderHR.bvhType = BVHType::Cylinders;
                 update_if(hr,cylinderHR,is_closer(cylinderHR,hr));
             }
@@ -445,11 +3321,11 @@ namespace generic {
                 //update_if(hr,sphericalLightHR,is_closer(sphericalLightHR,hr));
             }
 
-            if (tlases.triangleLightTLAS.num_primitives() > 0) {
-                HitRecord triangleLightHR;
-                *((BaseHitRecord*)&triangleLightHR) = closest_hit(r,&tlases.triangleLightTLAS,&tlases.triangleLightTLAS+1);
-                triangleLightHR.bvhType = BVHType::TriangleLights;
-                update_if(hr,triangleLightHR,is_closer(triangleLightHR,hr));
+            if (tlases.quadLightTLAS.num_primitives() > 0) {
+                HitRecord quadLightHR;
+                *((BaseHitRecord*)&quadLightHR) = closest_hit(r,&tlases.quadLightTLAS,&tlases.quadLightTLAS+1);
+                quadLightHR.bvhType = BVHType::QuadLights;
+                update_if(hr,quadLightHR,is_closer(quadLightHR,hr));
             }
 
             return hr;
@@ -466,21 +3342,94 @@ namespace generic {
 
             virtual ~Geometry() {}
 
+            // Root of the BVH instances refer to, null if there is none
+            virtual const bvh_node* getRoot() const = 0;
+
+            // BVH collapsed for wide traversal, built on first use and reset
+            // when the geometry is committed; null if too deep
+            virtual const WideBVH* getWideBVH() = 0;
+
+            void resetWideBVH()
+            {
+                wideBVH = WideBVH{};
+                wideBVHBuilt = false;
+            }
+
+            size_t getWideBVHSizeInBytes() const
+            {
+                return wideBVH.getSizeInBytes();
+            }
+
             ANARIGeometry handle = nullptr;
-            unsigned geomID = unsigned(-1);
+
+            // Assigned on creation and kept for the geometry's lifetime,
+            // unlike its position in backend::geoms, which changes when
+            // other geometries are released; written to channel.objectId
+            const unsigned geomID = nextGeomID++;
+
+        protected:
+            template <typename BVH>
+            const WideBVH* getWideBVH(const BVH& bvh, bool quantize = false)
+            {
+                if (!wideBVHBuilt) {
+                    wideBVHOK = wideBVH.build(bvh.ref(),quantize);
+                    wideBVHBuilt = true;
+                }
+                return wideBVHOK ? &wideBVH : nullptr;
+            }
+
+            template <typename BVH>
+            static const bvh_node* getRoot(const BVH& bvh)
+            {
+                return bvh.num_nodes() > 0 ? &bvh.node(0) : nullptr;
+            }
+
+            WideBVH wideBVH;
+            bool wideBVHBuilt = false;
+            bool wideBVHOK = false;
+
+        private:
+            // Geometries are only created by commits, which are serialized
+            static inline unsigned nextGeomID = 0;
         };
 
         struct TriangleGeom : Geometry
         {
             using SP = std::shared_ptr<TriangleGeom>;
 
+            const bvh_node* getRoot() const
+            {
+                return compact ? Geometry::getRoot(compactBVH) : Geometry::getRoot(bvh);
+            }
+
+            // Compact meshes also get the smaller, quantized nodes
+            const WideBVH* getWideBVH()
+            {
+                return compact ? Geometry::getWideBVH(compactBVH,true) : Geometry::getWideBVH(bvh);
+            }
+
             TriangleBVH bvh;
+
+            // Either bvh or compactBVH is used
+            bool compact = false;
+            CompactMesh mesh;
+            CompactTriangleBVH compactBVH;
         };
 
         struct SphereGeom : Geometry
         {
             using SP = std::shared_ptr<SphereGeom>;
 
+            const bvh_node* getRoot() const
+            {
+                return Geometry::getRoot(bvh);
+            }
+
+            const WideBVH* getWideBVH()
+            {
+                return Geometry::getWideBVH(bvh);
+            }
+
             SphereBVH bvh;
         };
 
@@ -488,6 +3437,16 @@ namespace generic {
         {
             using SP = std::shared_ptr<CylinderGeom>;
 
+            const bvh_node* getRoot() const
+            {
+                return Geometry::getRoot(bvh);
+            }
+
+            const WideBVH* getWideBVH()
+            {
+                return Geometry::getWideBVH(bvh);
+            }
+
             CylinderBVH bvh;
         };
 
@@ -506,6 +3465,7 @@ namespace generic {
             Geometry::SP geom;
             Material::SP material = nullptr;
             TriangleBVH::bvh_inst triangleBVHInst;
+            CompactTriangleBVH::bvh_inst compactTriangleBVHInst;
             SphereBVH::bvh_inst sphereBVHInst;
             CylinderBVH::bvh_inst cylinderBVHInst;
 
@@ -520,6 +3480,8 @@ namespace generic {
 
             std::vector<Surface::SP> surfaces;
 
+            std::vector<Volume::SP> volumes;
+
             ANARIInstance handle = nullptr;
         };
 
@@ -530,29 +3492,170 @@ namespace generic {
             struct {
                 TriangleTLAS triangleTLAS;
                 aligned_vector<TriangleBVH::bvh_inst> triangleBVHInsts;
+                CompactTriangleTLAS compactTriangleTLAS;
+                aligned_vector<CompactTriangleBVH::bvh_inst> compactTriangleBVHInsts;
                 SphereTLAS sphereTLAS;
                 aligned_vector<SphereBVH::bvh_inst> sphereBVHInsts;
                 CylinderTLAS cylinderTLAS;
                 aligned_vector<CylinderBVH::bvh_inst> cylinderBVHInsts;
+                WideBVH wideTriangleTLAS;
+                WideBVH wideCompactTriangleTLAS;
+                WideBVH wideSphereTLAS;
+                WideBVH wideCylinderTLAS;
+                std::vector<Geometry::SP> geoms; // instanced by the TLASes
                 aligned_vector<GenericMaterial> materials;
+                std::vector<Material::SP> materialRefs; // per material
             } surfaceImpl;
 
             struct {
-                aligned_vector<StructuredVolumeRef*> structuredVolumes;
+                aligned_vector<VolumeInstance> instances;
+                VolumeBVH bvh;
+                std::vector<Volume::SP> volumes; // referenced by the instances
             } volumeImpl;
 
             struct {
                 aligned_vector<GenericLight> lights;
+                aligned_vector<ANARILight> lightHandles; // per light
+                std::vector<Light::SP> lightRefs; // own the HDRI tables
+                aligned_vector<unsigned> finiteLights; // lights in the light BVH
+                aligned_vector<aabb> lightBounds;
+                aligned_vector<float> lightPower;
+                LightBVH lightBVH;
+                aligned_vector<unsigned> infiniteLights; // sampled separately
+                int envLightID = -1; // visible environment light
                 SphereTLAS sphereTLAS;
                 SphereBVH sphereBVH;
-                TriangleTLAS triangleTLAS;
-                TriangleBVH triangleBVH;
+                QuadTLAS quadTLAS;
+                QuadBVH quadBVH;
                 aligned_vector<GenericMaterial> areaLightMaterials; // only emissive
             } lightImpl;
 
+            // Merged material table (surfaces, then area lights) and kernel
+            // params, rebuilt on commit rather than every frame. Background
+            // and ambient are taken from the renderer, get_surface() only
+            // uses the primitives and materials
+            struct {
+                TLASes tlases;
+                aligned_vector<GenericMaterial> materials;
+                float epsilon = 1e-3f;
+                KernelParams params;
+            } kernelImpl;
+
+            void updateKernelParams()
+            {
+                TLASes& tlases = kernelImpl.tlases;
+                tlases.triangleTLAS = surfaceImpl.triangleTLAS.ref();
+                tlases.compactTriangleTLAS = surfaceImpl.compactTriangleTLAS.ref();
+                tlases.sphereTLAS = surfaceImpl.sphereTLAS.ref();
+                tlases.cylinderTLAS = surfaceImpl.cylinderTLAS.ref();
+                tlases.sphericalLightTLAS = lightImpl.sphereTLAS.ref();
+                tlases.quadLightTLAS = lightImpl.quadTLAS.ref();
+
+                if (useWideBVH) {
+                    // Instances are matched with their geometry through the
+                    // root node of the BLAS they reference
+                    std::map<const bvh_node*,const WideBVH*> blases;
+                    for (auto& g : surfaceImpl.geoms) {
+                        if (const bvh_node* root = g->getRoot())
+                            blases[root] = g->getWideBVH();
+                    }
+
+                    auto lookup = [&blases](const auto& inst) -> const WideBVH* {
+                        if (inst.get_ref().num_nodes() == 0)
+                            return nullptr;
+                        auto it = blases.find(&inst.get_ref().node(0));
+                        return it != blases.end() ? it->second : nullptr;
+                    };
+
+                    auto collapse = [&lookup](WideBVH& wide, const auto& tlas) -> const WideBVH* {
+                        if (!wide.build(tlas))
+                            return nullptr;
+                        wide.attachBLASes(tlas,lookup);
+                        return &wide;
+                    };
+
+                    tlases.wideTriangleTLAS = collapse(surfaceImpl.wideTriangleTLAS,tlases.triangleTLAS);
+                    tlases.wideCompactTriangleTLAS = collapse(surfaceImpl.wideCompactTriangleTLAS,tlases.compactTriangleTLAS);
+                    tlases.wideSphereTLAS = collapse(surfaceImpl.wideSphereTLAS,tlases.sphereTLAS);
+                    tlases.wideCylinderTLAS = collapse(surfaceImpl.wideCylinderTLAS,tlases.cylinderTLAS);
+                } else {
+                    surfaceImpl.wideTriangleTLAS = WideBVH{};
+                    surfaceImpl.wideCompactTriangleTLAS = WideBVH{};
+                    surfaceImpl.wideSphereTLAS = WideBVH{};
+                    surfaceImpl.wideCylinderTLAS = WideBVH{};
+                    tlases.wideTriangleTLAS = nullptr;
+                    tlases.wideCompactTriangleTLAS = nullptr;
+                    tlases.wideSphereTLAS = nullptr;
+                    tlases.wideCylinderTLAS = nullptr;
+                }
+
+                aabb bounds;
+                bounds.invalidate();
+
+                if (tlases.triangleTLAS.num_nodes() > 0)
+                    bounds.insert(tlases.triangleTLAS.node(0).get_bounds());
+
+                if (tlases.compactTriangleTLAS.num_nodes() > 0)
+                    bounds.insert(tlases.compactTriangleTLAS.node(0).get_bounds());
+
+                if (tlases.sphereTLAS.num_nodes() > 0)
+                    bounds.insert(tlases.sphereTLAS.node(0).get_bounds());
+
+                if (tlases.cylinderTLAS.num_nodes() > 0)
+                    bounds.insert(tlases.cylinderTLAS.node(0).get_bounds());
+
+                if (!volumeImpl.bvh.nodes.empty())
+                    bounds.insert(volumeImpl.bvh.nodes[0].bounds);
+
+                vec3f diagonal = bounds.max-bounds.min;
+                kernelImpl.epsilon = bounds.invalid() ? 1e-3f
+                                   : std::max(1e-3f, length(diagonal)*1e-5f);
+
+                updateMaterials();
+            }
+
+            // Only refresh the merged material table, e.g. after a material
+            // was recommitted; the TLASes are left alone
+            void updateMaterials()
+            {
+                aligned_vector<GenericMaterial>& materials = kernelImpl.materials;
+                materials.resize(surfaceImpl.materials.size()+lightImpl.areaLightMaterials.size());
+
+                std::copy(surfaceImpl.materials.begin(),
+                          surfaceImpl.materials.end(),
+                          materials.begin());
+
+                std::copy(lightImpl.areaLightMaterials.begin(),
+                          lightImpl.areaLightMaterials.end(),
+                          materials.begin()+surfaceImpl.materials.size());
+
+                TLASes& tlases = kernelImpl.tlases;
+                kernelImpl.params = make_kernel_params(
+                    &tlases,
+                    &tlases+1,
+                    materials.data(),
+                    lightImpl.lights.data(),
+                    lightImpl.lights.data()+lightImpl.lights.size(),
+                    10,
+                    kernelImpl.epsilon,
+                    vec4f(0.f),
+                    vec4f(0.f)
+                );
+            }
+
             ANARIWorld handle = nullptr;
         };
 
+        inline GenericMaterial makeMaterial(const Material& m)
+        {
+            matte<float> mat;
+            mat.ca() = from_rgb(vec3f{1.f,1.f,1.f});
+            mat.cd() = from_rgb(m.color);
+            mat.ka() = 1.f;
+            mat.kd() = 1.f;
+            return mat;
+        }
+
         struct Renderer
         {
             using SP = std::shared_ptr<Renderer>;
@@ -569,164 +3672,266 @@ namespace generic {
                 auto sparams = make_sched_params(blend_params,cam,frame);
 
                 if (algorithm==Algorithm::Pathtracing) {
+                    vec4f ambient{0.f,0.f,0.f,0.f};
+
+                    if (world.lightImpl.lights.empty())
+                        ambient = vec4f(1.f,1.f,1.f,1.f);
+
+                    const TLASes& tlases = world.kernelImpl.tlases;
+                    const KernelParams& kparams = world.kernelImpl.params;
+                    float epsilon = world.kernelImpl.epsilon;
+
+                    const VolumeBVH& volumes = world.volumeImpl.bvh;
+
+                    const GenericLight* lights = world.lightImpl.lights.data();
+                    const LightBVH& lightBVH = world.lightImpl.lightBVH;
+                    const unsigned* infiniteLights = world.lightImpl.infiniteLights.data();
+                    unsigned numInfiniteLights = (unsigned)world.lightImpl.infiniteLights.size();
+
+                    // Infinite lights are not in the light BVH, they are
+                    // chosen with this probability if there are any
+                    float infiniteLightProb = numInfiniteLights == 0 ? 0.f
+                                            : lightBVH.nodes.empty() ? 1.f : .5f;
+
+                    const HDRILight* envLight = nullptr;
+                    if (world.lightImpl.envLightID >= 0)
+                        envLight = world.lightImpl.lights[world.lightImpl.envLightID].as<HDRILight>();
+
+                    // Surfaces and volumes are handled by the same integrator:
+                    // the surface TLASes are intersected first and delta
+                    // tracking is limited to [0,t_surface]. Emitters are
+                    // accounted for by next event estimation at surface and
+                    // volume interactions, and only directly on primary hits
+                    // Auxiliary channels come from the first interaction
+                    // of the same path, no extra rays are traced for them
+                    FrameAOVs aovs = frame.aovs();
+                    aovs.blend = alpha;
+
+                    sched.frame([&](ray r, random_generator<float>& gen, int x, int y) {
+                        result_record<float> result;
+                        result.hit = false;
+                        result.color = backgroundColor;
+
+                        size_t pixel = size_t(y)*aovs.width+x;
+                        AOVSample aov;
+
+                        henyey_greenstein<float> f;
+                        f.g = 0.f; // isotropic
+
+                        vec3f throughput(1.f);
+                        vec3f radiance(0.f);
+
+                        // Sample one light, trace a shadow ray that is blocked
+                        // by surfaces and (stochastically) by volumes
+                        auto directLight = [&](const vec3f& pos, auto eval) {
+                            unsigned lightID;
+                            float selectPdf;
+                            if (gen.next() < infiniteLightProb) {
+                                unsigned i = min(unsigned(gen.next()*numInfiniteLights),numInfiniteLights-1);
+                                lightID = infiniteLights[i];
+                                selectPdf = infiniteLightProb/numInfiniteLights;
+                            } else {
+                                if (!lightBVH.sample(pos,gen,lightID,selectPdf))
+                                    return vec3f(0.f);
+                                selectPdf *= 1.f-infiniteLightProb;
+                            }
 
-                    if (world.volumeImpl.structuredVolumes.size()==1) { // single volume only
-                        StructuredVolumeRef& volume = *world.volumeImpl.structuredVolumes[0];
+                            auto ls = lights[lightID].sample(pos,gen);
 
-                        float heightf = (float)frame.height();
+                            if (ls.pdf <= 0.f)
+                                return vec3f(0.f);
 
-                        sched.frame([&](ray r, random_generator<float>& gen, int x, int y) {
-                            result_record<float> result;
-                            
-                            henyey_greenstein<float> f;
-                            f.g = 0.f; // isotropic
+                            vec3f L = normalize(ls.dir);
+                            float ld = ls.dist-2.f*epsilon;
 
-                            vec3f throughput(1.f);
+                            ray shadowRay;
+                            shadowRay.ori = pos + L * epsilon;
+                            shadowRay.dir = L;
 
-                            auto hit_rec = intersect(r, volume.bbox);
+                            HitRecord shr = intersect(shadowRay,tlases);
+                            if (shr.hit && shr.t < ld)
+                                return vec3f(0.f);
 
-                            unsigned bounce = 0;
+                            float dist;
+                            unsigned instID;
+                            vec3f localPos;
+                            if (volumes.sample_interaction(shadowRay,ld,dist,instID,localPos,gen))
+                                return vec3f(0.f);
 
-                            if (hit_rec.hit)
-                            {
-                                r.ori += r.dir * hit_rec.tnear;
-                                hit_rec.tfar -= hit_rec.tnear;
-
-                                while (volume.sample_interaction(r, hit_rec.tfar, gen))
-                                {
-                                    // Is the path length exceeded?
-                                    if (bounce++ >= 1024)
-                                    {
-                                        throughput = vec3(0.0f);
-                                        break;
-                                    }
+                            return eval(L,ls.intensity) / (selectPdf * ls.pdf);
+                        };
 
-                                    throughput *= volume.albedo(r.ori);
+                        // Volume scattering events are cheap and plentiful in
+                        // dense media, so only surface bounces count against
+                        // the path length; the outer cap is a safety net
+                        unsigned surfaceBounces = 0;
+                        for (unsigned bounce=0; bounce<1024 && surfaceBounces<10; ++bounce) {
+                            HitRecord hr = intersect(r,tlases);
+                            float tsurf = hr.hit ? hr.t : std::numeric_limits<float>::max();
 
-                                    // Russian roulette absorption
-                                    float prob = max_element(throughput);
-                                    if (prob < 0.2f)
-                                    {
-                                        if (gen.next() > prob)
-                                        {
-                                            throughput = vec3(0.0f);
-                                            break;
-                                        }
-                                        throughput /= prob;
+                            float dist;
+                            unsigned instID;
+                            vec3f localPos;
+                            bool scatter = volumes.sample_interaction(r,tsurf,dist,instID,localPos,gen);
+
+                            if (!scatter && !hr.hit) {
+                                if (bounce == 0 && envLight != nullptr) {
+                                    radiance += throughput * envLight->radiance(r.dir);
+                                    result.hit = true;
+                                }
+                                if (bounce > 0)
+                                    radiance += throughput * ambient.xyz();
+                                break;
+                            }
+
+                            if (bounce == 0)
+                                result.hit = true;
+
+                            vec3f viewDir = -r.dir;
+                            vec3f pos;
+                            vec3f nextDir;
+
+                            if (scatter) {
+                                pos = r.ori + r.dir * dist;
+
+                                throughput *= volumes.instances[instID].volume->albedo(localPos);
+
+                                if (bounce == 0) {
+                                    aov.firstHit(dist,vec3f(0.f),~0u,~0u,instID);
+                                    aov.firstAlbedo(throughput);
+                                }
+
+                                radiance += throughput * directLight(pos,
+                                    [&](const vec3f& L, const vec3f& intensity) {
+                                        return intensity * f.tr(viewDir,L);
+                                    });
+
+                                // Sample phase function, weight is one
+                                float pdf;
+                                f.sample(viewDir, nextDir, pdf, gen);
+                            } else {
+                                hr.isect_pos = r.ori + r.dir * hr.t;
+                                pos = hr.isect_pos;
+
+                                if (hr.bvhType == BVHType::QuadLights
+                                 || hr.bvhType == BVHType::SphericalLights) {
+                                    if (bounce == 0) {
+                                        if (auto ql = lights[hr.prim_id].as<QuadLight>())
+                                            radiance += throughput * ql->radiance(r.dir);
+                                        else
+                                            radiance += throughput * lights[hr.prim_id].intensity(pos);
+                                        aov.firstHit(hr.t,vec3f(0.f),hr.prim_id,~0u,~0u);
+                                        aov.firstAlbedo(vec3f(1.f));
                                     }
+                                    break;
+                                }
 
-                                    // Sample phase function
-                                    vec3 scatter_dir;
-                                    float pdf;
-                                    f.sample(-r.dir, scatter_dir, pdf, gen);
-                                    r.dir = scatter_dir;
+                                auto surf = get_surface(hr,kparams);
 
-                                    hit_rec = intersect(r, volume.bbox);
+                                if (bounce == 0) {
+                                    aov.firstHit(hr.t,surf.shading_normal,hr.prim_id,
+                                                 hr.geom_id,(unsigned)hr.inst_id);
                                 }
+
+                                radiance += throughput * directLight(pos,
+                                    [&](const vec3f& L, const vec3f& intensity) {
+                                        return to_rgb(surf.shade(viewDir,L,intensity));
+                                    });
+
+                                float pdf;
+                                int inter = 0;
+                                auto src = surf.sample(viewDir, nextDir, pdf, inter, gen);
+
+                                if (pdf <= 0.f)
+                                    break;
+
+                                throughput *= to_rgb(src) * (abs(dot(surf.shading_normal,nextDir)) / pdf);
+                                ++surfaceBounces;
+
+                                // For diffuse surfaces sampled by the cosine
+                                // lobe the first path weight is the albedo
+                                if (bounce == 0)
+                                    aov.firstAlbedo(throughput);
                             }
 
-                            // Look up the environment
-                            float t = y / heightf;
-                            vec3 Ld = (1.0f - t)*vec3f(1.0f, 1.0f, 1.0f) + t * vec3f(0.5f, 0.7f, 1.0f);
-                            vec3 L = throughput;
+                            // Russian roulette
+                            float prob = max_element(throughput);
+                            if (prob < 0.2f)
+                            {
+                                if (gen.next() > prob)
+                                    break;
+                                throughput /= prob;
+                            }
 
-                            result.hit = hit_rec.hit;
-                            result.color = bounce ? vec4f(L, 1.f) : backgroundColor;
-                            return result;
-                        }, sparams);
-                    } else if (!world.surfaceImpl.triangleBVHInsts.empty()) {
-                        vec4f ambient{0.f,0.f,0.f,0.f};
-
-                        if (world.lightImpl.lights.empty())
-                            ambient = vec4f(1.f,1.f,1.f,1.f);
-
-                        TLASes tlases;
-                        tlases.triangleTLAS = world.surfaceImpl.triangleTLAS.ref();
-                        tlases.sphereTLAS = world.surfaceImpl.sphereTLAS.ref();
-                        tlases.cylinderTLAS = world.surfaceImpl.cylinderTLAS.ref();
-                        tlases.sphericalLightTLAS = world.lightImpl.sphereTLAS.ref();
-                        tlases.triangleLightTLAS = world.lightImpl.triangleTLAS.ref();
-
-                        aligned_vector<GenericMaterial> materials(
-                            world.surfaceImpl.materials.size()+world.lightImpl.areaLightMaterials.size());
-
-                        std::copy(world.surfaceImpl.materials.data(),
-                                  world.surfaceImpl.materials.data()+world.surfaceImpl.materials.size(),
-                                  materials.data());
-
-                        std::copy(world.lightImpl.areaLightMaterials.data(),
-                                  world.lightImpl.areaLightMaterials.data()+world.lightImpl.areaLightMaterials.size(),
-                                  materials.data()+world.surfaceImpl.materials.size());
-
-                        aabb bounds;
-                        bounds.invalidate();
-
-                        if (tlases.triangleTLAS.num_nodes() > 0)
-                            bounds.insert(tlases.triangleTLAS.node(0).get_bounds());
-
-                        if (tlases.sphereTLAS.num_nodes() > 0)
-                            bounds.insert(tlases.sphereTLAS.node(0).get_bounds());
-
-                        if (tlases.cylinderTLAS.num_nodes() > 0)
-                            bounds.insert(tlases.cylinderTLAS.node(0).get_bounds());
-
-                        vec3f diagonal = bounds.max-bounds.min;
-                        float epsilon = std::max(1e-3f, length(diagonal)*1e-5f);
-                        KernelParams kparams = make_kernel_params(
-                            &tlases,
-                            &tlases+1,
-                            materials.data(),
-                            world.lightImpl.lights.data(),
-                            world.lightImpl.lights.data()+world.lightImpl.lights.size(),
-                            10,
-                            epsilon,
-                            backgroundColor,
-                            ambient
-                        );
-                        pathtracing::kernel<decltype(kparams)> kernel;
-                        kernel.params = kparams;
-                        sched.frame(kernel,sparams);
-                    }
+                            r.ori = pos + nextDir * epsilon;
+                            r.dir = nextDir;
+                        }
+
+                        if (result.hit)
+                            result.color = vec4f(radiance,1.f);
+
+                        aovs.write(pixel,aov);
+
+                        return result;
+                    }, sparams);
                 } else if (algorithm==Algorithm::AmbientOcclusion) {
+                    // The pass also runs without volumes, it then fills in
+                    // the background and clears the auxiliary channels
+                    const VolumeBVH& volumes = world.volumeImpl.bvh;
 
-                    if (1) { // single volume only
-                        StructuredVolumeRef& volume = *world.volumeImpl.structuredVolumes[0];
+                    float dt = 2.f;
+                    bool volumetricAO = true;
 
-                        float dt = 2.f;
-                        vec3f gradientDelta = 1.f/volume.bbox.size();
-                        bool volumetricAO = true;
+                    FrameAOVs aovs = frame.aovs();
+                    aovs.blend = alpha;
 
-                        sched.frame([&](ray r, random_generator<float>& gen, int x, int y) {
-                            result_record<float> result;
+                    sched.frame([&](ray r, random_generator<float>& gen, int x, int y) {
+                        result_record<float> result;
+                        result.hit = false;
+                        result.color = vec4f(0.f);
 
-                            auto hit_rec = intersect(r, volume.bbox);
-                            result.hit = hit_rec.hit;
+                        size_t pixel = size_t(y)*aovs.width+x;
+                        AOVSample aov;
 
-                            if (!hit_rec.hit) {
-                                result.color = backgroundColor;
-                                return result;
-                            }
+                        float tseg = 0.f;
+                        unsigned instID;
+                        ray lr;
+                        float tnear, tfar;
+
+                        // Visit the volumes front-to-back
+                        while (result.color.w < 0.999f
+                            && volumes.next_segment(r, tseg, instID, lr, tnear, tfar)) {
+                            VolumeRef& volume = *volumes.instances[instID].volume;
+
+                            if (!result.hit)
+                                aov.firstHit(tnear,vec3f(0.f),~0u,~0u,instID);
 
-                            result.color = vec4f(0.f);
+                            result.hit = true;
 
-                            float t = max(0.f,hit_rec.tnear);
-                            float tmax = hit_rec.tfar;
-                            vec3f pos = r.ori + r.dir * t;
+                            float t = tnear;
+                            float tmax = tfar;
+                            vec3f pos = lr.ori + lr.dir * t;
 
-                            // TODO: vertex-centric!
-                            vec3f texCoord = pos/volume.bbox.size();
+                            vec3f inc = lr.dir*dt;
 
-                            vec3f inc = r.dir*dt/volume.bbox.size();
+                            float voxel = volume.sampleField(pos);
 
                             while (t < tmax) {
-                                float voxel = tex3D(volume.texture3f,texCoord);
-                                vec4f color = tex1D(volume.textureRGBA,voxel);
+                                vec4f color;
+                                if (volume.preIntegrated) {
+                                    // classify the whole segment [t,t+dt]
+                                    float voxelBack = volume.sampleField(pos+inc);
+                                    color = tex2D(volume.texturePreIntegrated,vec2f(voxel,voxelBack));
+                                    voxel = voxelBack;
+                                } else {
+                                    color = volume.classify(voxel);
+                                }
 
                                 // shading
-                                vec3f grad = volume.gradient(texCoord,gradientDelta);
+                                vec3f grad = volume.gradient(pos);
                                 if (volumetricAO && length(grad) > .15f) {
                                     vec3f n = normalize(grad);
-                                    n = faceforward(n,-r.dir,n);
+                                    n = faceforward(n,-lr.dir,n);
                                     vec3f u, v, w=n;
                                     make_orthonormal_basis(u,v,w);
 
@@ -737,24 +3942,23 @@ namespace generic {
                                         vec3f dir = normalize(sp.x*u+sp.y*v+sp.z+w);
 
                                         ray aoRay;
-                                        aoRay.ori = texCoord + dir * 1e-3f;
+                                        aoRay.ori = pos + dir * 1e-3f;
                                         aoRay.dir = dir;
                                         aoRay.tmin = 0.f;
                                         aoRay.tmax = radius;
                                         auto ao_rec = intersect(aoRay,volume.bbox);
                                         aoRay.tmax = fminf(aoRay.tmax,ao_rec.tfar);
 
-                                        vec3f texCoordAO = aoRay.ori/volume.bbox.size();
-                                        vec3f incAO = aoRay.dir*dt/volume.bbox.size();
+                                        vec3f posAO = aoRay.ori;
+                                        vec3f incAO = aoRay.dir*dt;
 
                                         float tAO = 0.f;
                                         while (tAO < aoRay.tmax) {
-                                            float voxelAO = tex3D(volume.texture3f,texCoordAO);
-                                            vec4f colorAO = tex1D(volume.textureRGBA,voxelAO);
+                                            vec4f colorAO = volume.classify(volume.sampleField(posAO));
 
                                             color *= colorAO.w;
 
-                                            texCoordAO += incAO;
+                                            posAO += incAO;
                                             tAO += dt;
                                         }
                                     }
@@ -770,16 +3974,28 @@ namespace generic {
                                 result.color += color * (1.f-result.color.w);
 
                                 // step on
-                                texCoord += inc;
+                                pos += inc;
                                 t += dt;
+
+                                if (!volume.preIntegrated)
+                                    voxel = volume.sampleField(pos);
                             }
 
-                            result.color.xyz() += (1.f-result.color.w) * backgroundColor.xyz();
-                            result.color.w += (1.f-result.color.w) * backgroundColor.w;
+                            tseg = tfar;
+                        }
+
+                        aovs.write(pixel,aov);
 
+                        if (!result.hit) {
+                            result.color = backgroundColor;
                             return result;
-                        }, sparams);
-                    }
+                        }
+
+                        result.color.xyz() += (1.f-result.color.w) * backgroundColor.xyz();
+                        result.color.w += (1.f-result.color.w) * backgroundColor.w;
+
+                        return result;
+                    }, sparams);
                 }
             }
 
@@ -796,7 +4012,8 @@ namespace generic {
         std::vector<Material::SP> materials;
         std::vector<Instance::SP> instances;
         std::vector<Surface::SP> surfaces;
-        std::vector<StructuredVolume::SP> structuredVolumes;
+        std::vector<SpatialField::SP> spatialFields;
+        std::vector<Volume::SP> volumes;
         std::vector<Light::SP> lights;
 
         std::vector<Renderer::SP> renderers;
@@ -804,6 +4021,14 @@ namespace generic {
         std::vector<Frame::SP> frames;
         std::vector<World::SP> worlds;
 
+        // Shared by the commit functions that set up data in parallel; they
+        // are run one at a time, under the flush's exclusive state lock
+        static thread_pool& commitPool()
+        {
+            static thread_pool pool(std::thread::hardware_concurrency());
+            return pool;
+        }
+
         void createDefaultMaterial()
         {
             Material::SP dflt = std::make_shared<Material>();
@@ -813,6 +4038,9 @@ namespace generic {
         enum class ExecutionOrder {
             Object = 9999, // catch error messages first
             StructuredRegular = 7,
+            SparseRegular = 7,
+            AMRField = 7,
+            UnstructuredField = 7,
             Geometry = 7,
             Matte = 7,
             Volume = 6,
@@ -820,6 +4048,8 @@ namespace generic {
             Light = 6,
             PointLight = 6,
             QuadLight = 6,
+            DirectionalLight = 6,
+            HDRILight = 6,
             Instance = 5,
             World = 4,
             Camera = 3,
@@ -828,6 +4058,7 @@ namespace generic {
             AO = 1,
             Pathtracer = 1,
             Frame = 0,
+            Release = -1, // after all commits that might still refer to the object
         };
 
         typedef std::function<void()> CommitFunc;
@@ -839,23 +4070,122 @@ namespace generic {
 
         std::vector<Commit> outstandingCommits;
 
+        // Commits may be enqueued from any application thread; the object
+        // lists above are only modified while flushing, under an exclusive
+        // lock, and rendering holds the lock shared so it never sees a
+        // half-updated scene
+        std::mutex commitMutex;
+        std::shared_mutex stateMutex;
+
+        // Frontend objects released during a flush; they are destroyed once
+        // the exclusive lock is dropped, as destroying a frame waits for its
+        // render task, which in turn needs the lock shared
+        std::vector<ResourceHandle> releasedHandles;
+
         static void flushCommitBuffer() {
-            std::sort(outstandingCommits.begin(),outstandingCommits.end(),
-                      [](const Commit& a, const Commit& b)
-                      {
-                          return a.order > b.order;
-                      });
+            // Destroying objects may release the objects they reference,
+            // which enqueues more work; flush until nothing is left
+            for (;;) {
+                std::vector<ResourceHandle> released;
 
-            for (auto commit : outstandingCommits) {
-                commit.func();
-            }
+                {
+                    std::unique_lock<std::shared_mutex> l(stateMutex);
+
+                    // Report array data that had to be copied since the last flush
+                    static size_t copiedBytes = 0;
+                    size_t totalCopied = ArrayStorage::getCopiedBytes();
+                    if (totalCopied > copiedBytes) {
+                        LOG(logging::Level::Info) << "Backend: copied " << totalCopied-copiedBytes
+                            << " bytes of shared array data";
+                    }
+                    copiedBytes = totalCopied;
+
+                    std::vector<Commit> commits;
+                    {
+                        std::unique_lock<std::mutex> l(commitMutex);
+                        std::swap(commits,outstandingCommits);
+                    }
 
-            outstandingCommits.clear();
+                    std::stable_sort(commits.begin(),commits.end(),
+                                     [](const Commit& a, const Commit& b)
+                                     {
+                                         return a.order > b.order;
+                                     });
+
+                    for (auto commit : commits) {
+                        commit.func();
+                    }
+
+                    std::swap(released,releasedHandles);
+                }
+
+                if (released.empty())
+                    break;
+
+                for (ResourceHandle handle : released) {
+                    DestroyResource(handle);
+                }
+            }
         }
 
         void enqueueCommit(CommitFunc func, ExecutionOrder order) {
+            std::unique_lock<std::mutex> l(commitMutex);
             outstandingCommits.push_back({func,order});
         }
+
+        template <typename Container>
+        static void eraseHandle(Container& objs, ResourceHandle handle)
+        {
+            objs.erase(std::remove_if(objs.begin(),objs.end(),
+                                      [handle](const typename Container::value_type& obj) {
+                                          return (ResourceHandle)obj->handle == handle;
+                                      }),
+                       objs.end());
+        }
+
+        // Volumes and worlds keep raw pointers into the field storage;
+        // re-derive them when a field was recommitted in place
+        static void patchVolumes(const SpatialField::SP& field)
+        {
+            std::vector<const VolumeRef*> changed;
+            auto patch = [&](const Volume::SP& v) {
+                if (v->field == field
+                 && std::find(changed.begin(),changed.end(),&v->ref) == changed.end()) {
+                    v->updateFieldRef();
+                    changed.push_back(&v->ref);
+                }
+            };
+
+            for (auto& v : volumes) {
+                patch(v);
+            }
+
+            // Released volumes may still be held by the worlds
+            for (auto& w : worlds) {
+                for (auto& v : w->volumeImpl.volumes) {
+                    patch(v);
+                }
+            }
+
+            if (changed.empty())
+                return;
+
+            for (auto& w : worlds) {
+                auto& insts = w->volumeImpl.instances;
+                bool refit = false;
+                for (auto& inst : insts) {
+                    if (std::find(changed.begin(),changed.end(),inst.volume) != changed.end()) {
+                        inst.updateBounds();
+                        refit = true;
+                    }
+                }
+
+                if (refit) {
+                    w->volumeImpl.bvh.build(insts.data(),insts.size());
+                    w->updateKernelParams();
+                }
+            }
+        }
     } // backend
 
     //--- API ---------------------------------------------
@@ -870,7 +4200,7 @@ namespace generic {
 
         void commit(generic::World& world)
         {
-            enqueueCommit([&world]() {
+            enqueueCommit([world = Snapshot<WorldParams>(world)]() {
                 if (backend::materials.empty()) {
                     backend::createDefaultMaterial();
                 }
@@ -889,10 +4219,22 @@ namespace generic {
                 }
 
                 (*it)->surfaceImpl.triangleBVHInsts.clear();
+                (*it)->surfaceImpl.compactTriangleBVHInsts.clear();
                 (*it)->surfaceImpl.sphereBVHInsts.clear();
                 (*it)->surfaceImpl.cylinderBVHInsts.clear();
+                (*it)->surfaceImpl.geoms.clear();
                 (*it)->surfaceImpl.materials.clear();
+                (*it)->surfaceImpl.materialRefs.clear();
+                (*it)->volumeImpl.instances.clear();
+                (*it)->volumeImpl.volumes.clear();
                 (*it)->lightImpl.lights.clear();
+                (*it)->lightImpl.lightHandles.clear();
+                (*it)->lightImpl.lightRefs.clear();
+                (*it)->lightImpl.finiteLights.clear();
+                (*it)->lightImpl.lightBounds.clear();
+                (*it)->lightImpl.lightPower.clear();
+                (*it)->lightImpl.infiniteLights.clear();
+                (*it)->lightImpl.envLightID = -1;
 
                 unsigned instID = 0;
 
@@ -905,7 +4247,7 @@ namespace generic {
                     Array1D* instances = (Array1D*)GetResource(world.instance);
 
                     for (uint32_t i=0; i<instances->numItems[0]; ++i) {
-                        ANARIInstance inst = ((ANARIInstance*)(instances->internalData))[i];
+                        ANARIInstance inst = getArrayElement<ANARIInstance>(instances,i);
                         auto iit = std::find_if(backend::instances.begin(),backend::instances.end(),
                                                 [inst](const Instance::SP& i) {
                                                     return i->handle == inst;
@@ -937,7 +4279,15 @@ namespace generic {
 
                             float* trans = (*iit)->transform;
 
-                            if (auto tg = std::dynamic_pointer_cast<TriangleGeom>((*iit)->surfaces[i]->geom)) {
+                            if ((*iit)->surfaces[i]->geom != nullptr)
+                                (*it)->surfaceImpl.geoms.push_back((*iit)->surfaces[i]->geom);
+
+                            auto tg = std::dynamic_pointer_cast<TriangleGeom>((*iit)->surfaces[i]->geom);
+                            if (tg != nullptr && tg->compact) {
+                                CompactTriangleBVH::bvh_inst inst = tg->compactBVH.inst(mat4x3(trans));
+                                inst.set_inst_id(instID);
+                                (*it)->surfaceImpl.compactTriangleBVHInsts.push_back(inst);
+                            } else if (tg != nullptr) {
                                 TriangleBVH::bvh_inst inst = tg->bvh.inst(mat4x3(trans));
                                 inst.set_inst_id(instID);
                                 (*it)->surfaceImpl.triangleBVHInsts.push_back(inst);
@@ -952,7 +4302,13 @@ namespace generic {
                             }
                         }
 
-                        // TODO: Volumes
+                        // Volumes
+                        for (size_t i=0; i<(*iit)->volumes.size(); ++i) {
+                            mat4x3 trans((*iit)->transform);
+                            (*it)->volumeImpl.instances.push_back(
+                                makeVolumeInstance(&(*iit)->volumes[i]->ref,trans));
+                            (*it)->volumeImpl.volumes.push_back((*iit)->volumes[i]);
+                        }
 
                         // TODO: Lights
                     }
@@ -967,7 +4323,7 @@ namespace generic {
                         if (mats.empty())
                             mats.push_back(backend::materials[defaultMatID]);
 
-                        ANARISurface surf = ((ANARISurface*)(surfaces->internalData))[i];
+                        ANARISurface surf = getArrayElement<ANARISurface>(surfaces,i);
                         auto sit = std::find_if(backend::surfaces.begin(),backend::surfaces.end(),
                                                 [surf](const Surface::SP& srf) {
                                                     return srf->handle == surf;
@@ -982,6 +4338,8 @@ namespace generic {
                         if (tg == nullptr && sg == nullptr && cg == nullptr)
                             continue;
 
+                        (*it)->surfaceImpl.geoms.push_back((*sit)->geom);
+
                         if ((*sit)->material != nullptr) {
                             ANARIMaterial m = (*sit)->material->handle;
 
@@ -998,7 +4356,11 @@ namespace generic {
                             }
                         }
 
-                        if (tg != nullptr) {
+                        if (tg != nullptr && tg->compact) {
+                            CompactTriangleBVH::bvh_inst inst = (*sit)->compactTriangleBVHInst;
+                            inst.set_inst_id(instID);
+                            (*it)->surfaceImpl.compactTriangleBVHInsts.push_back(inst);
+                        } else if (tg != nullptr) {
                             TriangleBVH::bvh_inst inst = (*sit)->triangleBVHInst;
                             inst.set_inst_id(instID);
                             (*it)->surfaceImpl.triangleBVHInsts.push_back(inst);
@@ -1022,6 +4384,14 @@ namespace generic {
                                                                     (*it)->surfaceImpl.triangleBVHInsts.size());
                 }
 
+                if (!(*it)->surfaceImpl.compactTriangleBVHInsts.empty()) {
+                    lbvh_builder builder;
+
+                    (*it)->surfaceImpl.compactTriangleTLAS = builder.build(CompactTriangleTLAS{},
+                                                                           (*it)->surfaceImpl.compactTriangleBVHInsts.data(),
+                                                                           (*it)->surfaceImpl.compactTriangleBVHInsts.size());
+                }
+
                 if (!(*it)->surfaceImpl.sphereBVHInsts.empty()) {
                     lbvh_builder builder;
 
@@ -1042,32 +4412,28 @@ namespace generic {
                 if (world.volume != nullptr) { // TODO: should check if there were any changes at all
                     Array1D* volumes = (Array1D*)GetResource(world.volume);
 
-                    (*it)->volumeImpl.structuredVolumes.clear();
-
                     for (uint32_t i=0; i<volumes->numItems[0]; ++i) {
-                        ANARIVolume vol = ((ANARIVolume*)(volumes->internalData))[i];
-                        auto vit = std::find_if(backend::structuredVolumes.begin(),backend::structuredVolumes.end(),
-                                                [vol](const StructuredVolume::SP& sv) {
+                        ANARIVolume vol = getArrayElement<ANARIVolume>(volumes,i);
+                        auto vit = std::find_if(backend::volumes.begin(),backend::volumes.end(),
+                                                [vol](const Volume::SP& sv) {
                                                     return sv->handle == vol;
                                                 });
 
-                        assert(vit != backend::structuredVolumes.end());
+                        assert(vit != backend::volumes.end());
 
-                        (*it)->volumeImpl.structuredVolumes.push_back(&(*vit)->ref);
+                        (*it)->volumeImpl.instances.push_back(
+                            makeVolumeInstance(&(*vit)->ref,{mat3x3::identity(),vec3f(0.f)}));
+                        (*it)->volumeImpl.volumes.push_back(*vit);
                     }
                 }
 
+                (*it)->volumeImpl.bvh.build((*it)->volumeImpl.instances.data(),
+                                            (*it)->volumeImpl.instances.size());
+
                 // Materials
                 for (size_t i=0; i<mats.size(); ++i) {
-                    Material::SP m = mats[i];
-
-                    matte<float> mat;
-                    mat.ca() = from_rgb(vec3f{1.f,1.f,1.f});
-                    mat.cd() = from_rgb(m->color);
-                    mat.ka() = 1.f;
-                    mat.kd() = 1.f;
-
-                    (*it)->surfaceImpl.materials.push_back(mat);
+                    (*it)->surfaceImpl.materials.push_back(makeMaterial(*mats[i]));
+                    (*it)->surfaceImpl.materialRefs.push_back(mats[i]);
                 }
 
                 // Lights
@@ -1077,7 +4443,7 @@ namespace generic {
                     (*it)->lightImpl.areaLightMaterials.clear();
 
                     for (uint32_t i=0; i<lights->numItems[0]; ++i) {
-                        ANARILight light = ((ANARILight*)(lights->internalData))[i];
+                        ANARILight light = getArrayElement<ANARILight>(lights,i);
                         auto lit = std::find_if(backend::lights.begin(),backend::lights.end(),
                                                 [light](const Light::SP& l) {
                                                     return l->handle == light;
@@ -1085,6 +4451,8 @@ namespace generic {
 
                         assert(lit != backend::lights.end());
 
+                        (*it)->lightImpl.lightRefs.push_back(*lit);
+
                         if ((*lit)->type == Light::Type::Point) {
                             if ((*lit)->asPointLight.radius > 0.f) {
                                 float intensityScale = (*lit)->asPointLight.radiance;
@@ -1101,6 +4469,14 @@ namespace generic {
                                 sl.set_cl((*lit)->color);
                                 sl.set_kl(intensityScale);
                                 (*it)->lightImpl.lights.push_back(sl);
+                                (*it)->lightImpl.lightHandles.push_back(light);
+
+                                vec3f r(sphere.radius);
+                                (*it)->lightImpl.finiteLights.push_back((unsigned)(*it)->lightImpl.lights.size()-1);
+                                (*it)->lightImpl.lightBounds.push_back(aabb(sphere.center-r,sphere.center+r));
+                                (*it)->lightImpl.lightPower.push_back(
+                                    constants::pi<float>() * luminance((*lit)->color) * intensityScale
+                                        * 4.f * constants::pi<float>() * sphere.radius * sphere.radius);
 
                                 emissive<float> mat;
                                 mat.ce() = from_rgb((*lit)->color);
@@ -1118,6 +4494,13 @@ namespace generic {
                                 pl.set_linear_attenuation(0.f);
                                 pl.set_quadratic_attenuation(0.f);
                                 (*it)->lightImpl.lights.push_back(pl);
+                                (*it)->lightImpl.lightHandles.push_back(light);
+
+                                vec3f p = (*lit)->asPointLight.position;
+                                (*it)->lightImpl.finiteLights.push_back((unsigned)(*it)->lightImpl.lights.size()-1);
+                                (*it)->lightImpl.lightBounds.push_back(aabb(p,p));
+                                (*it)->lightImpl.lightPower.push_back(
+                                    4.f * constants::pi<float>() * luminance((*lit)->color) * intensityScale);
                             }
                         } else if ((*lit)->type == Light::Type::Quad) {
                             float intensityScale = (*lit)->asQuadLight.radiance; // TODO: consolidate with sperical light
@@ -1125,42 +4508,74 @@ namespace generic {
                                 intensityScale = (*lit)->asQuadLight.power;
                             if ((*lit)->asQuadLight.intensityWasSet)
                                 intensityScale = (*lit)->asQuadLight.intensity;
-                            for (int i=0; i<2; ++i) { // Add as two triangles (TODO!)
-                                basic_triangle<3,float> tri;
-                                tri.v1 = (*lit)->asQuadLight.position;
-                                if (i==0) {
-                                    tri.e1 = (*lit)->asQuadLight.edge1;
-                                    tri.e2 = (*lit)->asQuadLight.edge1 + (*lit)->asQuadLight.edge2;
-                                } else {
-                                    tri.e1 = (*lit)->asQuadLight.edge1 + (*lit)->asQuadLight.edge2;
-                                    tri.e2 = (*lit)->asQuadLight.edge2;
-                                }
-                                tri.prim_id = (unsigned)(*it)->lightImpl.lights.size();
-                                tri.geom_id = (unsigned)(*it)->surfaceImpl.materials.size()+(unsigned)(*it)->lightImpl.lights.size();
-                                TriangleLight tl(tri);
-                                tl.set_cl((*lit)->color);
-                                tl.set_kl(intensityScale);
-                                (*it)->lightImpl.lights.push_back(tl);
-
-                                emissive<float> mat;
-                                mat.ce() = from_rgb((*lit)->color);
-                                mat.ls() = intensityScale;
-                                (*it)->lightImpl.areaLightMaterials.push_back(mat);
-                            }
+                            basic_quad quad;
+                            quad.v1 = (*lit)->asQuadLight.position;
+                            quad.e1 = (*lit)->asQuadLight.edge1;
+                            quad.e2 = (*lit)->asQuadLight.edge2;
+                            quad.prim_id = (unsigned)(*it)->lightImpl.lights.size();
+                            quad.geom_id = (unsigned)(*it)->surfaceImpl.materials.size()+(unsigned)(*it)->lightImpl.lights.size();
+                            QuadLight ql(quad);
+                            ql.set_cl((*lit)->color);
+                            ql.set_kl(intensityScale);
+                            ql.side = (*lit)->asQuadLight.side;
+                            (*it)->lightImpl.lights.push_back(ql);
+                            (*it)->lightImpl.lightHandles.push_back(light);
+
+                            float sides = ql.side == Light::Side::Both ? 2.f : 1.f;
+                            (*it)->lightImpl.finiteLights.push_back((unsigned)(*it)->lightImpl.lights.size()-1);
+                            (*it)->lightImpl.lightBounds.push_back(get_bounds(quad));
+                            (*it)->lightImpl.lightPower.push_back(
+                                sides * constants::pi<float>() * luminance((*lit)->color) * intensityScale
+                                    * length(cross(quad.e1,quad.e2)));
+
+                            emissive<float> mat;
+                            mat.ce() = from_rgb((*lit)->color);
+                            mat.ls() = intensityScale;
+                            (*it)->lightImpl.areaLightMaterials.push_back(mat);
+                        } else if ((*lit)->type == Light::Type::Directional) {
+                            DirectionalLight dl;
+                            dl.reset(**lit);
+
+                            (*it)->lightImpl.infiniteLights.push_back((unsigned)(*it)->lightImpl.lights.size());
+                            (*it)->lightImpl.lights.push_back(dl);
+                            (*it)->lightImpl.lightHandles.push_back(light);
+                        } else if ((*lit)->type == Light::Type::HDRI) {
+                            HDRILight hl;
+                            hl.reset(**lit);
+
+                            int lightID = (int)(*it)->lightImpl.lights.size();
+                            (*it)->lightImpl.lights.push_back(hl);
+                            (*it)->lightImpl.lightHandles.push_back(light);
+                            (*it)->lightImpl.infiniteLights.push_back((unsigned)lightID);
+
+                            if ((*lit)->visible && (*it)->lightImpl.envLightID < 0)
+                                (*it)->lightImpl.envLightID = lightID;
                         }
                     }
                 }
 
+                (*it)->lightImpl.lightBVH.build((*it)->lightImpl.finiteLights.data(),
+                                                (*it)->lightImpl.lightBounds.data(),
+                                                (*it)->lightImpl.lightPower.data(),
+                                                (*it)->lightImpl.lightBounds.size());
+
+                // Drop the emitter BVHs of the previous commit, the world
+                // may no longer have lights of either kind
+                (*it)->lightImpl.sphereBVH = SphereBVH{};
+                (*it)->lightImpl.sphereTLAS = SphereTLAS{};
+                (*it)->lightImpl.quadBVH = QuadBVH{};
+                (*it)->lightImpl.quadTLAS = QuadTLAS{};
+
                 if (!(*it)->lightImpl.lights.empty()) {
                     lbvh_builder builder;
                     aligned_vector<basic_sphere<float>> spheres;
-                    aligned_vector<basic_triangle<3,float>> triangles;
+                    aligned_vector<basic_quad> quads;
 
                     for (size_t i=0; i<(*it)->lightImpl.lights.size(); ++i) {
                         if ((*it)->lightImpl.lights[i].as<SphericalLight>())
                             spheres.push_back((*it)->lightImpl.lights[i].as<SphericalLight>()->geometry());
-                        else if ((*it)->lightImpl.lights[i].as<TriangleLight>())
-                            triangles.push_back((*it)->lightImpl.lights[i].as<TriangleLight>()->geometry());
+                        else if ((*it)->lightImpl.lights[i].as<QuadLight>())
+                            quads.push_back((*it)->lightImpl.lights[i].as<QuadLight>()->geometry());
                     }
 
                     if (!spheres.empty()) {
@@ -1169,13 +4584,14 @@ namespace generic {
                         (*it)->lightImpl.sphereTLAS = builder.build(SphereTLAS{},&inst,1);
                     }
 
-                    if (!triangles.empty()) {
-                        (*it)->lightImpl.triangleBVH = builder.build(TriangleBVH{},triangles.data(),triangles.size());
-                        auto inst = (*it)->lightImpl.triangleBVH.inst({mat3x3::identity(),vec3f(0.f)});
-                        (*it)->lightImpl.triangleTLAS = builder.build(TriangleTLAS{},&inst,1);
+                    if (!quads.empty()) {
+                        (*it)->lightImpl.quadBVH = builder.build(QuadBVH{},quads.data(),quads.size());
+                        auto inst = (*it)->lightImpl.quadBVH.inst({mat3x3::identity(),vec3f(0.f)});
+                        (*it)->lightImpl.quadTLAS = builder.build(QuadTLAS{},&inst,1);
                     }
                 }
 
+                (*it)->updateKernelParams();
             }, ExecutionOrder::World);
         }
 
@@ -1187,7 +4603,7 @@ namespace generic {
 
         void commit(generic::Camera& cam)
         {
-            enqueueCommit([&cam]() {
+            enqueueCommit([cam = Snapshot<CameraParams>(cam)]() {
                 auto it = std::find_if(backend::cameras.begin(),backend::cameras.end(),
                                        [&cam](const Camera::SP& c) {
                                            return c->handle == cam.getResourceHandle();
@@ -1215,7 +4631,7 @@ namespace generic {
 
         void commit(generic::PerspectiveCamera& cam)
         {
-            enqueueCommit([&cam]() {
+            enqueueCommit([cam = Snapshot<PerspectiveCameraParams>(cam)]() {
                 auto it = std::find_if(backend::cameras.begin(),backend::cameras.end(),
                                        [&cam](const Camera::SP& c) {
                                            return c->handle == cam.getResourceHandle();
@@ -1235,7 +4651,7 @@ namespace generic {
 
         void commit(generic::Light& light)
         {
-            enqueueCommit([&light]() {
+            enqueueCommit([light = Snapshot<LightParams>(light)]() {
                 auto it = std::find_if(backend::lights.begin(),backend::lights.end(),
                                        [&light](const Light::SP& l) {
                                            return l->handle == light.getResourceHandle();
@@ -1249,12 +4665,13 @@ namespace generic {
                 }
 
                 (*it)->color = vec3f(light.color);
+                (*it)->visible = light.visible;
             }, ExecutionOrder::Light);
         }
 
         void commit(generic::PointLight& light)
         {
-            enqueueCommit([&light]() {
+            enqueueCommit([light = Snapshot<PointLightParams>(light)]() {
                 auto it = std::find_if(backend::lights.begin(),backend::lights.end(),
                                        [&light](const Light::SP& l) {
                                            return l->handle == light.getResourceHandle();
@@ -1280,7 +4697,7 @@ namespace generic {
 
         void commit(generic::QuadLight& light)
         {
-            enqueueCommit([&light]() {
+            enqueueCommit([light = Snapshot<QuadLightParams>(light)]() {
                 auto it = std::find_if(backend::lights.begin(),backend::lights.end(),
                                        [&light](const Light::SP& l) {
                                            return l->handle == light.getResourceHandle();
@@ -1313,9 +4730,141 @@ namespace generic {
             }, ExecutionOrder::QuadLight);
         }
 
+        void commit(generic::DirectionalLight& light)
+        {
+            enqueueCommit([light = Snapshot<DirectionalLightParams>(light)]() {
+                auto it = std::find_if(backend::lights.begin(),backend::lights.end(),
+                                       [&light](const Light::SP& l) {
+                                           return l->handle == light.getResourceHandle();
+                                       });
+
+                if (it == backend::lights.end()) {
+                    Light::SP l = std::make_shared<Light>();
+                    l->handle = (ANARILight)light.getResourceHandle();
+                    backend::lights.push_back(l);
+                    it = backend::lights.end()-1;
+                }
+
+                (*it)->type = Light::Type::Directional;
+                (*it)->asDirectionalLight.direction = vec3f(light.direction);
+                (*it)->asDirectionalLight.irradiance = light.irradiance;
+            }, ExecutionOrder::DirectionalLight);
+
+            // Headlights are updated every frame without recommitting the
+            // world, so patch the worlds' copies of this light in place
+            enqueueCommit([light = Snapshot<DirectionalLightParams>(light)]() {
+                auto lit = std::find_if(backend::lights.begin(),backend::lights.end(),
+                                        [&light](const Light::SP& l) {
+                                            return l->handle == light.getResourceHandle();
+                                        });
+
+                if (lit == backend::lights.end())
+                    return;
+
+                for (auto& w : backend::worlds) {
+                    for (size_t i=0; i<w->lightImpl.lightHandles.size(); ++i) {
+                        if (w->lightImpl.lightHandles[i] != (*lit)->handle)
+                            continue;
+
+                        if (auto dl = w->lightImpl.lights[i].as<DirectionalLight>())
+                            dl->reset(**lit);
+                    }
+                }
+            }, ExecutionOrder::World);
+        }
+
+        void commit(generic::HDRILight& light)
+        {
+            enqueueCommit([light = Snapshot<HDRILightParams>(light)]() {
+                auto it = std::find_if(backend::lights.begin(),backend::lights.end(),
+                                       [&light](const Light::SP& l) {
+                                           return l->handle == light.getResourceHandle();
+                                       });
+
+                if (it == backend::lights.end()) {
+                    Light::SP l = std::make_shared<Light>();
+                    l->handle = (ANARILight)light.getResourceHandle();
+                    backend::lights.push_back(l);
+                    it = backend::lights.end()-1;
+                }
+
+                Array2D* radiance = (Array2D*)GetResource(light.radiance);
+                int width = (int)radiance->numItems[0];
+                int height = (int)radiance->numItems[1];
+
+                aligned_vector<vec3f> radianceScratch;
+                const vec3f* radianceData = getArrayData(radiance,ANARI_FLOAT32_VEC3,radianceScratch);
+                if (radianceData == nullptr) {
+                    LOG(logging::Level::Error) << "HDRILight: radiance must be convertible "
+                        << "to FLOAT32_VEC3";
+                    return;
+                }
+
+                auto& hdri = (*it)->asHDRILight;
+
+                (*it)->type = Light::Type::HDRI;
+                hdri.up = vec3f(light.up);
+                hdri.direction = vec3f(light.direction);
+                hdri.scale = light.scale;
+                hdri.width = width;
+                hdri.height = height;
+                hdri.radiance.resize(size_t(width)*height);
+                memcpy(hdri.radiance.data(),radianceData,
+                       hdri.radiance.size()*sizeof(vec3f));
+
+                // Conditional distributions per row and row sums for the
+                // marginal distribution, weighted by the solid angle a row
+                // covers
+                hdri.conditional.resize(size_t(width)*height);
+                std::vector<float> rowWeights(height);
+
+                thread_pool& pool = commitPool();
+                parallel_for(pool,tiled_range1d<int>(0,height,16),
+                    [&](range1d<int> r) {
+                        std::vector<float> weights(width);
+                        for (int y=r.begin(); y!=r.end(); ++y) {
+                            float sinTheta = sinf((y+.5f)/height*constants::pi<float>());
+                            float sum = 0.f;
+                            for (int x=0; x<width; ++x) {
+                                weights[x] = luminance(hdri.radiance[y*width+x])*sinTheta;
+                                sum += weights[x];
+                            }
+                            buildAliasTable(weights.data(),width,hdri.conditional.data()+y*width);
+                            rowWeights[y] = sum;
+                        }
+                    });
+
+                hdri.marginal.resize(height);
+                buildAliasTable(rowWeights.data(),height,hdri.marginal.data());
+            }, ExecutionOrder::HDRILight);
+
+            // The worlds' copies of this light point into the radiance and
+            // alias tables just reallocated, patch them like directional
+            // lights
+            enqueueCommit([light = Snapshot<HDRILightParams>(light)]() {
+                auto lit = std::find_if(backend::lights.begin(),backend::lights.end(),
+                                        [&light](const Light::SP& l) {
+                                            return l->handle == light.getResourceHandle();
+                                        });
+
+                if (lit == backend::lights.end() || (*lit)->type != Light::Type::HDRI)
+                    return;
+
+                for (auto& w : backend::worlds) {
+                    for (size_t i=0; i<w->lightImpl.lightHandles.size(); ++i) {
+                        if (w->lightImpl.lightHandles[i] != (*lit)->handle)
+                            continue;
+
+                        if (auto hl = w->lightImpl.lights[i].as<HDRILight>())
+                            hl->reset(**lit);
+                    }
+                }
+            }, ExecutionOrder::World);
+        }
+
         void commit(generic::Frame& frame)
         {
-            enqueueCommit([&frame]() {
+            enqueueCommit([frame = Snapshot<FrameParams>(frame)]() {
                 auto it = std::find_if(backend::frames.begin(),backend::frames.end(),
                                        [&frame](const Frame::SP& f) {
                                            return f->handle == frame.getResourceHandle();
@@ -1328,16 +4877,34 @@ namespace generic {
                     it = backend::frames.end()-1;
                 }
 
-                pixel_format color
-                    = frame.color==ANARI_UFIXED8_VEC4 || ANARI_UFIXED8_RGBA_SRGB
-                        ? PF_RGBA8 : PF_RGBA32F;
-
                 pixel_format depth
-                    = frame.color==ANARI_FLOAT32 ? PF_DEPTH32F : PF_UNSPECIFIED;
-
-                bool sRGB = frame.color==ANARI_UFIXED8_RGBA_SRGB;
-
-                (*it)->reset(frame.size[0],frame.size[1],color,depth,sRGB);
+                    = frame.depth==ANARI_FLOAT32 ? PF_DEPTH32F : PF_UNSPECIFIED;
+
+                Tonemap tonemap = Tonemap::None;
+                if (strcmp(frame.tonemap,"aces")==0)
+                    tonemap = Tonemap::ACES;
+                else if (strcmp(frame.tonemap,"acesApprox")==0)
+                    tonemap = Tonemap::ACESApprox;
+
+                // The denoiser is guided by depth, normal and albedo, so
+                // these are written even if the application didn't ask
+                if (frame.denoise)
+                    depth = PF_DEPTH32F;
+
+                unsigned aovMask = frame.denoise ? AOVNormal | AOVAlbedo : 0;
+                if (frame.normal==ANARI_FLOAT32_VEC3)
+                    aovMask |= AOVNormal;
+                if (frame.albedo==ANARI_FLOAT32_VEC3)
+                    aovMask |= AOVAlbedo;
+                if (frame.primitiveId==ANARI_UINT32)
+                    aovMask |= AOVPrimitiveID;
+                if (frame.objectId==ANARI_UINT32)
+                    aovMask |= AOVObjectID;
+                if (frame.instanceId==ANARI_UINT32)
+                    aovMask |= AOVInstanceID;
+
+                (*it)->reset(frame.size[0],frame.size[1],frame.color,depth,tonemap,aovMask);
+                (*it)->denoising = frame.denoise;
 
                 // Also resize camera viewport
                 auto cit = std::find_if(backend::cameras.begin(),backend::cameras.end(),
@@ -1356,150 +4923,286 @@ namespace generic {
 
         void commit(generic::TriangleGeom& geom)
         {
-            enqueueCommit([&geom]() {
+            enqueueCommit([geom = Snapshot<TriangleGeomParams>(geom)]() {
                 auto it = std::find_if(backend::geoms.begin(),backend::geoms.end(),
                                        [&geom](const Geometry::SP& tg) {
                                            return tg->handle != nullptr
                                                && tg->handle == geom.getResourceHandle();
                                        });
 
-                unsigned geomID(-1);
-
                 if (it == backend::geoms.end()) {
                     backend::geoms.push_back(std::make_shared<TriangleGeom>());
                     it = backend::geoms.end()-1;
-                    geomID = backend::geoms.size()-1;
-                } else {
-                    geomID = std::distance(it,backend::geoms.begin());
                 }
 
                 auto tg = std::dynamic_pointer_cast<TriangleGeom>(*it);
                 assert(tg != nullptr);
 
                 tg->handle = (ANARIGeometry)geom.getResourceHandle();
-                tg->geomID = geomID;
+                unsigned geomID = tg->geomID;
+                tg->resetWideBVH();
 
-                aligned_vector<basic_triangle<3,float>> triangles;
+                Array1D* vertex = (Array1D*)GetResource(geom.vertex_position);
 
-                if (geom.primitive_index != nullptr) {
-                    Array1D* vertex = (Array1D*)GetResource(geom.vertex_position);
-                    Array1D* index = (Array1D*)GetResource(geom.primitive_index);
+                tg->compact = geom.compact;
 
-                    vec3f* vertices = (vec3f*)vertex->internalData;
-                    vec3ui* indices = (vec3ui*)index->internalData;
+                if (geom.compact) {
+                    // The primitives reference the mesh, which in turn reads
+                    // the arrays in place; the leaves then cost 16 instead
+                    // of 44 bytes per triangle
+                    tg->bvh = TriangleBVH{};
 
-                    triangles.resize(index->numItems[0]);
+                    Array1D* index = geom.primitive_index != nullptr
+                        ? (Array1D*)GetResource(geom.primitive_index) : nullptr;
+
+                    tg->mesh.reset(vertex,index);
 
-                    for (uint32_t i=0; i<index->numItems[0]; ++i) {
-                        vec3f v1 = vertices[indices[i].x];
-                        vec3f v2 = vertices[indices[i].y];
-                        vec3f v3 = vertices[indices[i].z];
+                    size_t numTriangles = index != nullptr ? index->numItems[0]
+                                                           : vertex->numItems[0]/3;
 
+                    aligned_vector<compact_triangle> triangles(numTriangles);
+
+                    for (uint32_t i=0; i<numTriangles; ++i) {
                         triangles[i].prim_id = i;
                         triangles[i].geom_id = geomID;
-                        triangles[i].v1 = v1;
-                        triangles[i].e1 = v2-v1;
-                        triangles[i].e2 = v3-v1;
+                        triangles[i].mesh = &tg->mesh;
                     }
 
+                    // Spatial splits would duplicate references and defeat
+                    // the purpose of compact storage
                     binned_sah_builder builder;
-                    builder.enable_spatial_splits(true);
+                    builder.enable_spatial_splits(false);
+
+                    tg->compactBVH = builder.build(CompactTriangleBVH{},triangles.data(),triangles.size());
+
+                    LOG(logging::Level::Info) << "Backend: compact triangle BVH uses "
+                        << tg->compactBVH.nodes().size()*sizeof(bvh_node)
+                         + tg->compactBVH.primitives().size()*sizeof(compact_triangle)
+                        << " bytes for " << numTriangles << " triangles, plus "
+                        << tg->mesh.getSizeInBytes() << " bytes of converted "
+                        << "vertices and indices";
+                    return;
+                }
+
+                tg->compactBVH = CompactTriangleBVH{};
+                tg->mesh.clear();
+
+                aligned_vector<vec3f> vertexScratch;
+                const vec3f* vertices = getArrayData(vertex,ANARI_FLOAT32_VEC3,vertexScratch);
+
+                aligned_vector<basic_triangle<3,float>> triangles;
+
+                auto makeTriangle = [&](uint32_t i, unsigned i1, unsigned i2, unsigned i3) {
+                    vec3f v1 = vertices[i1];
+                    vec3f v2 = vertices[i2];
+                    vec3f v3 = vertices[i3];
+
+                    triangles[i].prim_id = i;
+                    triangles[i].geom_id = geomID;
+                    triangles[i].v1 = v1;
+                    triangles[i].e1 = v2-v1;
+                    triangles[i].e2 = v3-v1;
+                };
+
+                if (geom.primitive_index != nullptr) {
+                    Array1D* index = (Array1D*)GetResource(geom.primitive_index);
+
+                    triangles.resize(index->numItems[0]);
 
-                    tg->bvh = builder.build(TriangleBVH{},triangles.data(),triangles.size());
+                    // 16 and 32 bit indices are read in place, without
+                    // widening them into an intermediate index buffer
+                    auto fromIndices = [&](auto indexType) {
+                        using I = decltype(indexType);
+                        const uint8_t* indices = index->internalData;
+                        size_t stride = index->getElementStride();
+                        for (uint32_t i=0; i<index->numItems[0]; ++i) {
+                            const I* idx = (const I*)(indices+i*stride);
+                            makeTriangle(i,idx[0],idx[1],idx[2]);
+                        }
+                    };
+
+                    if (index->elementType == ANARI_UINT16_VEC3) {
+                        fromIndices(uint16_t{});
+                    } else if (index->elementType == ANARI_UINT32_VEC3) {
+                        fromIndices(uint32_t{});
+                    } else {
+                        aligned_vector<vec3ui> indexScratch;
+                        const vec3ui* indices = getArrayData(index,ANARI_UINT32_VEC3,indexScratch);
+                        for (uint32_t i=0; i<index->numItems[0]; ++i) {
+                            makeTriangle(i,indices[i].x,indices[i].y,indices[i].z);
+                        }
+                    }
                 } else {
-                    assert(0 && "not implemented yet!!");
+                    // Triangle soup, every three consecutive vertices
+                    // form a triangle
+                    triangles.resize(vertex->numItems[0]/3);
+
+                    for (uint32_t i=0; i<triangles.size(); ++i) {
+                        makeTriangle(i,i*3,i*3+1,i*3+2);
+                    }
                 }
+
+                binned_sah_builder builder;
+                builder.enable_spatial_splits(true);
+
+                tg->bvh = builder.build(TriangleBVH{},triangles.data(),triangles.size());
             }, ExecutionOrder::Geometry);
         }
 
         void commit(generic::CylinderGeom& geom)
         {
-            enqueueCommit([&geom]() {
+            enqueueCommit([geom = Snapshot<CylinderGeomParams>(geom)]() {
                 auto it = std::find_if(backend::geoms.begin(),backend::geoms.end(),
                                        [&geom](const Geometry::SP& tg) {
                                            return tg->handle != nullptr
                                                && tg->handle == geom.getResourceHandle();
                                        });
 
-                unsigned geomID(-1);
-
                 if (it == backend::geoms.end()) {
                     backend::geoms.push_back(std::make_shared<CylinderGeom>());
                     it = backend::geoms.end()-1;
-                    geomID = backend::geoms.size()-1;
-                } else {
-                    geomID = std::distance(it,backend::geoms.begin());
                 }
 
                 auto cg = std::dynamic_pointer_cast<CylinderGeom>(*it);
                 assert(cg != nullptr);
 
                 cg->handle = (ANARIGeometry)geom.getResourceHandle();
-                cg->geomID = geomID;
-
-                aligned_vector<basic_cylinder<float>> cylinders;
+                unsigned geomID = cg->geomID;
+                cg->resetWideBVH();
+
+                Array1D* vertex = (Array1D*)GetResource(geom.vertex_position);
+                Array1D* index = (Array1D*)GetResource(geom.primitive_index);
+                Array1D* radius = (Array1D*)GetResource(geom.primitive_radius);
+                Array1D* cap = (Array1D*)GetResource(geom.vertex_cap);
+
+                aligned_vector<vec3f> vertexScratch;
+                aligned_vector<vec2ui> indexScratch;
+                aligned_vector<float> radiusScratch;
+                aligned_vector<uint32_t> capScratch;
+                const vec3f* vertices = getArrayData(vertex,ANARI_FLOAT32_VEC3,vertexScratch);
+                const vec2ui* indices = index != nullptr
+                        ? getArrayData(index,ANARI_UINT32_VEC2,indexScratch) : nullptr;
+                const float* radii = radius != nullptr
+                        ? getArrayData(radius,ANARI_FLOAT32,radiusScratch) : nullptr;
+                const uint32_t* vertexCaps = cap != nullptr
+                        ? getArrayData(cap,ANARI_UINT32,capScratch) : nullptr;
+
+                // Without an index array, every two consecutive vertices
+                // form a cylinder
+                size_t numCylinders = index != nullptr ? index->numItems[0] : vertex->numItems[0]/2;
+                float globalRadius = geom.radius;
+
+                // vertex.cap takes precedence over the global caps mode
+                unsigned globalCaps = 0;
+                if (strcmp(geom.caps,"first")==0)
+                    globalCaps = capped_cylinder::CapFirst;
+                else if (strcmp(geom.caps,"second")==0)
+                    globalCaps = capped_cylinder::CapSecond;
+                else if (strcmp(geom.caps,"both")==0)
+                    globalCaps = capped_cylinder::CapFirst | capped_cylinder::CapSecond;
+
+                aligned_vector<capped_cylinder> cylinders(numCylinders);
+
+                thread_pool& pool = commitPool();
+                parallel_for(pool,tiled_range1d<size_t>(0,numCylinders,4096),
+                    [&](range1d<size_t> r) {
+                        for (size_t i=r.begin(); i!=r.end(); ++i) {
+                            vec2ui idx = indices != nullptr ? indices[i]
+                                                            : vec2ui((unsigned)i*2,(unsigned)i*2+1);
+
+                            cylinders[i].prim_id = (unsigned)i;
+                            cylinders[i].geom_id = geomID;
+                            cylinders[i].v1 = vertices[idx.x];
+                            cylinders[i].v2 = vertices[idx.y];
+                            cylinders[i].radius = radii != nullptr ? radii[i] : globalRadius;
+
+                            if (vertexCaps != nullptr) {
+                                cylinders[i].caps = (vertexCaps[idx.x] ? capped_cylinder::CapFirst : 0)
+                                                  | (vertexCaps[idx.y] ? capped_cylinder::CapSecond : 0);
+                            } else {
+                                cylinders[i].caps = globalCaps;
+                            }
+                        }
+                    });
 
-                if (geom.primitive_index != nullptr) {
-                    Array1D* vertex = (Array1D*)GetResource(geom.vertex_position);
-                    Array1D* index = (Array1D*)GetResource(geom.primitive_index);
-                    Array1D* radius = (Array1D*)GetResource(geom.primitive_radius);
+                binned_sah_builder builder;
+                builder.enable_spatial_splits(false);
 
-                    vec3f* vertices = (vec3f*)vertex->internalData;
-                    vec2ui* indices = (vec2ui*)index->internalData;
-                    float* radii = (float*)radius->internalData;
+                cg->bvh = builder.build(CylinderBVH{},cylinders.data(),cylinders.size());
+            }, ExecutionOrder::Geometry);
+        }
 
-                    cylinders.resize(index->numItems[0]);
+        void commit(generic::SphereGeom& geom)
+        {
+            enqueueCommit([geom = Snapshot<SphereGeomParams>(geom)]() {
+                auto it = std::find_if(backend::geoms.begin(),backend::geoms.end(),
+                                       [&geom](const Geometry::SP& sg) {
+                                           return sg->handle != nullptr
+                                               && sg->handle == geom.getResourceHandle();
+                                       });
 
-                    for (uint32_t i=0; i<index->numItems[0]; ++i) {
-                        vec3f v1 = vertices[indices[i].x];
-                        vec3f v2 = vertices[indices[i].y];
-                        float r = radii[i];
+                if (it == backend::geoms.end()) {
+                    backend::geoms.push_back(std::make_shared<SphereGeom>());
+                    it = backend::geoms.end()-1;
+                }
 
-                        cylinders[i].prim_id = i;
-                        cylinders[i].geom_id = geomID;
-                        cylinders[i].v1 = v1;
-                        cylinders[i].v2 = v2;
-                        cylinders[i].radius = r;
-                    }
+                auto sg = std::dynamic_pointer_cast<SphereGeom>(*it);
+                assert(sg != nullptr);
+
+                sg->handle = (ANARIGeometry)geom.getResourceHandle();
+                unsigned geomID = sg->geomID;
+                sg->resetWideBVH();
+
+                Array1D* vertex = (Array1D*)GetResource(geom.vertex_position);
+                Array1D* radius = (Array1D*)GetResource(geom.vertex_radius);
+                Array1D* index = (Array1D*)GetResource(geom.primitive_index);
+
+                aligned_vector<vec3f> vertexScratch;
+                aligned_vector<float> radiusScratch;
+                aligned_vector<uint32_t> indexScratch;
+                const vec3f* vertices = getArrayData(vertex,ANARI_FLOAT32_VEC3,vertexScratch);
+                const float* radii = radius != nullptr
+                        ? getArrayData(radius,ANARI_FLOAT32,radiusScratch) : nullptr;
+                const uint32_t* indices = index != nullptr
+                        ? getArrayData(index,ANARI_UINT32,indexScratch) : nullptr;
+
+                size_t numSpheres = index != nullptr ? index->numItems[0] : vertex->numItems[0];
+                float globalRadius = geom.radius;
+
+                aligned_vector<basic_sphere<float>> spheres(numSpheres);
+
+                // Particle data sets can be huge, set up the primitives in parallel
+                thread_pool& pool = commitPool();
+                parallel_for(pool,tiled_range1d<size_t>(0,numSpheres,4096),
+                    [&](range1d<size_t> r) {
+                        for (size_t i=r.begin(); i!=r.end(); ++i) {
+                            uint32_t v = indices != nullptr ? indices[i] : (uint32_t)i;
+
+                            spheres[i].prim_id = (unsigned)i;
+                            spheres[i].geom_id = geomID;
+                            spheres[i].center = vertices[v];
+                            spheres[i].radius = radii != nullptr ? radii[v] : globalRadius;
+                        }
+                    });
 
-                    binned_sah_builder builder;
-                    builder.enable_spatial_splits(false);
+                // Binned SAH is too slow for millions of particles, use the
+                // (parallel) LBVH builder there
+                if (numSpheres > (1<<20)) {
+                    lbvh_builder builder;
 
-                    cg->bvh = builder.build(CylinderBVH{},cylinders.data(),cylinders.size());
+                    sg->bvh = builder.build(SphereBVH{},spheres.data(),spheres.size());
                 } else {
-                    Array1D* vertex = (Array1D*)GetResource(geom.vertex_position);
-                    Array1D* radius = (Array1D*)GetResource(geom.primitive_radius);
-
-                    vec3f* vertices = (vec3f*)vertex->internalData;
-                    float* radii = (float*)radius->internalData;
-
-                    cylinders.resize(vertex->numItems[0]/2);
-
-                    for (uint32_t i=0; i<vertex->numItems[0]; i+=2) {
-                        vec3f v1 = vertices[i];
-                        vec3f v2 = vertices[i+1];
-                        float r = radii[i/2];
-
-                        cylinders[i].prim_id = i/2;
-                        cylinders[i].geom_id = geomID;
-                        cylinders[i].v1 = v1;
-                        cylinders[i].v2 = v2;
-                        cylinders[i].radius = r;
-
-                        // std::cout << v1 << v2 << ' ' << r << '\n';
-                    }
-
                     binned_sah_builder builder;
                     builder.enable_spatial_splits(false);
 
-                    cg->bvh = builder.build(CylinderBVH{},cylinders.data(),cylinders.size());
+                    sg->bvh = builder.build(SphereBVH{},spheres.data(),spheres.size());
                 }
             }, ExecutionOrder::Geometry);
         }
 
         void commit(generic::Matte& mat)
         {
-            enqueueCommit([&mat]() {
+            enqueueCommit([mat = Snapshot<MatteParams>(mat)]() {
                 if (backend::materials.empty()) {
                     backend::createDefaultMaterial();
                 }
@@ -1517,13 +5220,27 @@ namespace generic {
                     backend::materials.push_back(m);
                 } else {
                     (*it)->color = vec3f{mat.color};
+
+                    // Update worlds referencing the material in place
+                    for (auto& w : backend::worlds) {
+                        bool changed = false;
+                        for (size_t i=0; i<w->surfaceImpl.materialRefs.size(); ++i) {
+                            if (w->surfaceImpl.materialRefs[i] == *it) {
+                                w->surfaceImpl.materials[i] = makeMaterial(**it);
+                                changed = true;
+                            }
+                        }
+
+                        if (changed)
+                            w->updateMaterials();
+                    }
                 }
             }, ExecutionOrder::Matte);
         }
 
         void commit(generic::Surface& surf)
         {
-            enqueueCommit([&surf]() {
+            enqueueCommit([surf = Snapshot<SurfaceParams>(surf)]() {
                 auto it = std::find_if(backend::surfaces.begin(),backend::surfaces.end(),
                                        [&surf](const Surface::SP& srf) {
                                            return srf->handle == surf.getResourceHandle();
@@ -1547,7 +5264,10 @@ namespace generic {
                 if (git != backend::geoms.end()) {
                     if (auto tg = std::dynamic_pointer_cast<TriangleGeom>(*git)) {
                         (*it)->geom = *git;
-                        (*it)->triangleBVHInst = tg->bvh.inst({mat3x3::identity(),vec3f(0.f)});
+                        if (tg->compact)
+                            (*it)->compactTriangleBVHInst = tg->compactBVH.inst({mat3x3::identity(),vec3f(0.f)});
+                        else
+                            (*it)->triangleBVHInst = tg->bvh.inst({mat3x3::identity(),vec3f(0.f)});
                     } else if (auto sg = std::dynamic_pointer_cast<SphereGeom>(*git)) {
                         (*it)->geom = *git;
                         (*it)->sphereBVHInst = sg->bvh.inst({mat3x3::identity(),vec3f(0.f)});
@@ -1572,7 +5292,15 @@ namespace generic {
 
         void commit(generic::Instance& inst)
         {
-            enqueueCommit([&inst]() {
+            // Groups have no backend counterpart, so their parameters are
+            // taken along with the instance's
+            GroupParams groupParams;
+            if (Group* g = (Group*)GetResource(inst.group)) {
+                std::unique_lock<std::mutex> l(g->paramMutex);
+                groupParams = *g;
+            }
+
+            enqueueCommit([inst = Snapshot<InstanceParams>(inst), group = groupParams]() {
                 auto it = std::find_if(backend::instances.begin(),backend::instances.end(),
                                        [&inst](const Instance::SP& i) {
                                            return i->handle == inst.getResourceHandle();
@@ -1587,17 +5315,17 @@ namespace generic {
 
                 memcpy((*it)->transform,inst.transform,sizeof((*it)->transform));
 
-                Group* group = (Group*)GetResource(inst.group);
-                //std::cout << inst.group << ' ' << group << '\n';
+                // Rebuilt from scratch, a group may have lost its surfaces
+                // or volumes since the last commit
+                (*it)->surfaces.clear();
+                (*it)->volumes.clear();
 
                 // Surfaces
-                if (group != nullptr && group->surface != nullptr) {
-                    (*it)->surfaces.clear();
-
-                    Array1D* surfaces = (Array1D*)GetResource(group->surface);
+                if (group.surface != nullptr) {
+                    Array1D* surfaces = (Array1D*)GetResource(group.surface);
 
                     for (uint32_t i=0; i<surfaces->numItems[0]; ++i) {
-                        ANARISurface surf = ((ANARISurface*)(surfaces->internalData))[i];
+                        ANARISurface surf = getArrayElement<ANARISurface>(surfaces,i);
                         auto sit = std::find_if(backend::surfaces.begin(),backend::surfaces.end(),
                                                 [surf](const Surface::SP& srf) {
                                                     return srf->handle == surf;
@@ -1609,7 +5337,22 @@ namespace generic {
                     }
                 }
 
-                // TODO: Volumes
+                // Volumes
+                if (group.volume != nullptr) {
+                    Array1D* volumes = (Array1D*)GetResource(group.volume);
+
+                    for (uint32_t i=0; i<volumes->numItems[0]; ++i) {
+                        ANARIVolume vol = getArrayElement<ANARIVolume>(volumes,i);
+                        auto vit = std::find_if(backend::volumes.begin(),backend::volumes.end(),
+                                                [vol](const Volume::SP& sv) {
+                                                    return sv->handle == vol;
+                                                });
+
+                        assert(vit != backend::volumes.end());
+
+                        (*it)->volumes.push_back(*vit);
+                    }
+                }
 
                 // TODO: Lights
             }, ExecutionOrder::Instance);
@@ -1619,29 +5362,228 @@ namespace generic {
         {
         }
 
+        void commit(generic::AMRField& amr)
+        {
+            enqueueCommit([amr = Snapshot<AMRFieldParams>(amr)]() {
+                auto it = std::find_if(backend::spatialFields.begin(),
+                                       backend::spatialFields.end(),
+                                       [&amr](const SpatialField::SP& sf) {
+                                           return sf->handle == amr.getResourceHandle();
+                                       });
+
+                if (it == backend::spatialFields.end()) {
+                    backend::spatialFields.push_back(std::make_shared<AMRField>());
+                    it = backend::spatialFields.end()-1;
+                }
+
+                auto field = std::dynamic_pointer_cast<AMRField>(*it);
+                assert(field);
+
+                Array1D* bounds = (Array1D*)GetResource(amr.blockBounds);
+                Array1D* levels = (Array1D*)GetResource(amr.blockLevel);
+                Array1D* data = (Array1D*)GetResource(amr.blockData);
+                Array1D* cellWidth = amr.cellWidth != nullptr
+                    ? (Array1D*)GetResource(amr.cellWidth) : nullptr;
+
+                size_t numBlocks = bounds->numItems[0];
+
+                std::vector<const Array3D*> blockData(numBlocks);
+                for (size_t i=0; i<numBlocks; ++i) {
+                    ANARIArray3D d = getArrayElement<ANARIArray3D>(data,i);
+                    blockData[i] = (const Array3D*)GetResource(d);
+                }
+
+                aligned_vector<aabbi> boundsScratch;
+                aligned_vector<int> levelsScratch;
+                aligned_vector<float> cellWidthScratch;
+
+                thread_pool& pool = commitPool();
+                field->handle = (ANARISpatialField)amr.getResourceHandle();
+                field->reset(getArrayData(bounds,ANARI_INT32_BOX3,boundsScratch),
+                             getArrayData(levels,ANARI_INT32,levelsScratch),
+                             blockData.data(),
+                             numBlocks,
+                             cellWidth ? getArrayData(cellWidth,ANARI_FLOAT32,cellWidthScratch) : nullptr,
+                             cellWidth ? cellWidth->numItems[0] : 0,
+                             pool);
+
+                patchVolumes(field);
+            }, ExecutionOrder::AMRField);
+        }
+
+        void commit(generic::UnstructuredField& uf)
+        {
+            enqueueCommit([uf = Snapshot<UnstructuredFieldParams>(uf)]() {
+                auto it = std::find_if(backend::spatialFields.begin(),
+                                       backend::spatialFields.end(),
+                                       [&uf](const SpatialField::SP& sf) {
+                                           return sf->handle == uf.getResourceHandle();
+                                       });
+
+                if (it == backend::spatialFields.end()) {
+                    backend::spatialFields.push_back(std::make_shared<UnstructuredField>());
+                    it = backend::spatialFields.end()-1;
+                }
+
+                auto field = std::dynamic_pointer_cast<UnstructuredField>(*it);
+                assert(field);
+
+                Array1D* position = (Array1D*)GetResource(uf.vertexPosition);
+                Array1D* data = (Array1D*)GetResource(uf.vertexData);
+                Array1D* index = (Array1D*)GetResource(uf.index);
+                Array1D* cellIndex = (Array1D*)GetResource(uf.cellIndex);
+                Array1D* cellType = (Array1D*)GetResource(uf.cellType);
+
+                auto indexAt = [](Array1D* arr, size_t i) -> uint64_t {
+                    const uint8_t* elem = arr->internalData+i*arr->getElementStride();
+                    if (arr->elementType == ANARI_UINT64)
+                        return *(const uint64_t*)elem;
+                    else
+                        return *(const uint32_t*)elem;
+                };
+
+                size_t numVerts = position->numItems[0];
+                field->vertices.resize(numVerts);
+                field->values.resize(numVerts);
+                position->convert(ANARI_FLOAT32_VEC3,field->vertices.data());
+                data->convert(ANARI_FLOAT32,field->values.data());
+
+                // Split cells into tets, vertex order as in VTK
+                static const unsigned hexTets[6][4] = {
+                    {0,1,2,6},{0,2,3,6},{0,3,7,6},{0,7,4,6},{0,4,5,6},{0,5,1,6}
+                };
+                static const unsigned wedgeTets[3][4] = {
+                    {0,1,2,3},{1,2,3,4},{2,3,4,5}
+                };
+                static const unsigned pyramidTets[2][4] = {
+                    {0,1,2,4},{0,2,3,4}
+                };
+
+                field->tets.clear();
+
+                size_t numCells = cellIndex->numItems[0];
+                for (size_t i=0; i<numCells; ++i) {
+                    uint64_t first = indexAt(cellIndex,i);
+                    uint8_t type = cellType->internalData[i*cellType->getElementStride()];
+
+                    auto addTets = [&](const unsigned (*pattern)[4], int count) {
+                        for (int j=0; j<count; ++j) {
+                            field->tets.push_back(vec4ui((unsigned)indexAt(index,first+pattern[j][0]),
+                                                         (unsigned)indexAt(index,first+pattern[j][1]),
+                                                         (unsigned)indexAt(index,first+pattern[j][2]),
+                                                         (unsigned)indexAt(index,first+pattern[j][3])));
+                        }
+                    };
+
+                    if (type == UnstructuredField::Tetrahedron) {
+                        static const unsigned tet[1][4] = {{0,1,2,3}};
+                        addTets(tet,1);
+                    } else if (type == UnstructuredField::Hexahedron) {
+                        addTets(hexTets,6);
+                    } else if (type == UnstructuredField::Wedge) {
+                        addTets(wedgeTets,3);
+                    } else if (type == UnstructuredField::Pyramid) {
+                        addTets(pyramidTets,2);
+                    } else {
+                        LOG(logging::Level::Warning) << "SpatialField.Unstructured: "
+                            << "unsupported cell type " << (int)type << ", skipping";
+                    }
+                }
+
+                thread_pool& pool = commitPool();
+                field->handle = (ANARISpatialField)uf.getResourceHandle();
+                field->reset(pool);
+
+                patchVolumes(field);
+            }, ExecutionOrder::UnstructuredField);
+        }
+
+        void commit(generic::SparseRegular& sr)
+        {
+            enqueueCommit([sr = Snapshot<SparseRegularParams>(sr)]() {
+                auto it = std::find_if(backend::spatialFields.begin(),
+                                       backend::spatialFields.end(),
+                                       [&sr](const SpatialField::SP& sf) {
+                                           return sf->handle == sr.getResourceHandle();
+                                       });
+
+                if (it == backend::spatialFields.end()) {
+                    backend::spatialFields.push_back(std::make_shared<SparseField>());
+                    it = backend::spatialFields.end()-1;
+                }
+
+                auto field = std::dynamic_pointer_cast<SparseField>(*it);
+                assert(field);
+
+                field->handle = (ANARISpatialField)sr.getResourceHandle();
+                field->nearest = strcmp(sr.filter,"nearest")==0;
+
+                if (sr.brickIndex != nullptr) {
+                    Array3D* index = (Array3D*)GetResource(sr.brickIndex);
+                    Array1D* bricks = (Array1D*)GetResource(sr.brickData);
+                    vec3i numBricks((int)index->numItems[0],(int)index->numItems[1],(int)index->numItems[2]);
+                    vec3i dims(sr.dimensions[0] > 0 ? (int)sr.dimensions[0] : numBricks.x*SparseField::BrickSize,
+                               sr.dimensions[1] > 0 ? (int)sr.dimensions[1] : numBricks.y*SparseField::BrickSize,
+                               sr.dimensions[2] > 0 ? (int)sr.dimensions[2] : numBricks.z*SparseField::BrickSize);
+
+                    const size_t voxelsPerBrick = SparseField::BrickSize*SparseField::BrickSize*SparseField::BrickSize;
+                    aligned_vector<int> indexScratch;
+                    aligned_vector<float> brickScratch;
+                    field->reset(getArrayData(index,ANARI_INT32,indexScratch),numBricks,
+                                 getArrayData(bricks,ANARI_FLOAT32,brickScratch),
+                                 bricks->numItems[0]/voxelsPerBrick,dims,sr.emptyValue);
+                } else {
+                    Array3D* data = (Array3D*)GetResource(sr.data);
+                    vec3i dims((int)data->numItems[0],(int)data->numItems[1],(int)data->numItems[2]);
+
+                    thread_pool& pool = commitPool();
+                    aligned_vector<float> scratch;
+                    field->reset(getArrayData(data,ANARI_FLOAT32,scratch),dims,sr.emptyValue,pool);
+                }
+
+                patchVolumes(field);
+            }, ExecutionOrder::SparseRegular);
+        }
+
         void commit(generic::Volume& vol)
         {
-            enqueueCommit([&vol]() {
-                auto it = std::find_if(backend::structuredVolumes.begin(),
-                                       backend::structuredVolumes.end(),
-                                       [&vol](const StructuredVolume::SP& sv) {
+            ANARIArray3D structuredData = nullptr;
+            if (auto sr = dynamic_cast<StructuredRegular*>(GetResource(vol.field))) {
+                std::unique_lock<std::mutex> l(sr->paramMutex);
+                structuredData = sr->data;
+            }
+
+            enqueueCommit([vol = Snapshot<VolumeParams>(vol), structuredData]() {
+                auto it = std::find_if(backend::volumes.begin(),
+                                       backend::volumes.end(),
+                                       [&vol](const Volume::SP& sv) {
                                            return sv->handle != nullptr
                                                && sv->handle == vol.getResourceHandle();
                                        });
 
-                if (it == backend::structuredVolumes.end()) {
-                    backend::structuredVolumes.push_back(std::make_shared<StructuredVolume>());
-                    it = backend::structuredVolumes.end()-1;
+                if (it == backend::volumes.end()) {
+                    backend::volumes.push_back(std::make_shared<Volume>());
+                    it = backend::volumes.end()-1;
                 }
 
+                SpatialField::SP field = nullptr;
+                auto fit = std::find_if(backend::spatialFields.begin(),
+                                        backend::spatialFields.end(),
+                                        [&vol](const SpatialField::SP& sf) {
+                                            return sf->handle == vol.field;
+                                        });
+
+                if (fit != backend::spatialFields.end())
+                    field = *fit;
+
                 (*it)->handle = (ANARIVolume)vol.getResourceHandle();
-                (*it)->reset(vol);
+                (*it)->reset(vol, field, structuredData);
             }, ExecutionOrder::Volume);
         }
 
         void commit(generic::Renderer& rend)
         {
-            enqueueCommit([&rend]() {
+            enqueueCommit([rend = Snapshot<RendererParams>(rend)]() {
                 auto it = std::find_if(backend::renderers.begin(),
                                        backend::renderers.end(),
                                        [&rend](const Renderer::SP& r) {
@@ -1661,7 +5603,7 @@ namespace generic {
 
         void commit(generic::Pathtracer& pt)
         {
-            enqueueCommit([&pt]() {
+            enqueueCommit([pt = Snapshot<>(pt)]() {
                 auto it = std::find_if(backend::renderers.begin(),
                                        backend::renderers.end(),
                                        [&pt](const Renderer::SP& r) {
@@ -1681,7 +5623,7 @@ namespace generic {
 
         void commit(generic::AO& ao)
         {
-            enqueueCommit([&ao]() {
+            enqueueCommit([ao = Snapshot<>(ao)]() {
                 auto it = std::find_if(backend::renderers.begin(),
                                        backend::renderers.end(),
                                        [&ao](const Renderer::SP& r) {
@@ -1699,16 +5641,85 @@ namespace generic {
             }, ExecutionOrder::AO);
         }
 
-        void* map(generic::Frame& frame)
+        void release(ResourceHandle handle)
+        {
+            enqueueCommit([handle]() {
+                // Dropping the backend objects frees their BVHs, volume data
+                // and framebuffers; objects still in use by others are kept
+                // alive through the shared pointers those hold
+                eraseHandle(backend::geoms,handle);
+                eraseHandle(backend::materials,handle);
+                eraseHandle(backend::instances,handle);
+                eraseHandle(backend::surfaces,handle);
+                eraseHandle(backend::spatialFields,handle);
+                eraseHandle(backend::volumes,handle);
+                eraseHandle(backend::lights,handle);
+                eraseHandle(backend::renderers,handle);
+                eraseHandle(backend::cameras,handle);
+                eraseHandle(backend::frames,handle);
+                eraseHandle(backend::worlds,handle);
+
+                releasedHandles.push_back(handle);
+            }, ExecutionOrder::Release);
+        }
+
+        size_t getSizeInBytes()
+        {
+            std::shared_lock<std::shared_mutex> l(stateMutex);
+
+            size_t bytes = 0;
+
+            for (auto& f : backend::frames) {
+                bytes += f->getSizeInBytes();
+            }
+
+            for (auto& g : backend::geoms) {
+                if (auto tg = std::dynamic_pointer_cast<TriangleGeom>(g)) {
+                    bytes += tg->bvh.nodes().size()*sizeof(bvh_node)
+                           + tg->bvh.primitives().size()*sizeof(basic_triangle<3,float>)
+                           + tg->compactBVH.nodes().size()*sizeof(bvh_node)
+                           + tg->compactBVH.primitives().size()*sizeof(compact_triangle)
+                           + tg->mesh.getSizeInBytes();
+                } else if (auto sg = std::dynamic_pointer_cast<SphereGeom>(g)) {
+                    bytes += sg->bvh.nodes().size()*sizeof(bvh_node)
+                           + sg->bvh.primitives().size()*sizeof(basic_sphere<float>);
+                } else if (auto cg = std::dynamic_pointer_cast<CylinderGeom>(g)) {
+                    bytes += cg->bvh.nodes().size()*sizeof(bvh_node)
+                           + cg->bvh.primitives().size()*sizeof(capped_cylinder);
+                }
+
+                bytes += g->getWideBVHSizeInBytes();
+            }
+
+            for (auto& w : backend::worlds) {
+                bytes += w->surfaceImpl.wideTriangleTLAS.getSizeInBytes()
+                       + w->surfaceImpl.wideCompactTriangleTLAS.getSizeInBytes()
+                       + w->surfaceImpl.wideSphereTLAS.getSizeInBytes()
+                       + w->surfaceImpl.wideCylinderTLAS.getSizeInBytes();
+            }
+
+            return bytes;
+        }
+
+        void setWideBVH(bool wide)
+        {
+            useWideBVH = wide;
+        }
+
+        void* map(generic::Frame& frame, const char* channel)
         {
+            std::shared_lock<std::shared_mutex> l(stateMutex);
+
             auto it = std::find_if(backend::frames.begin(),backend::frames.end(),
                                    [&frame](const Frame::SP& f) {
                                        return f->handle == frame.getResourceHandle();
                                    });
 
-            assert(it != backend::frames.end());
+            // Not committed yet, nothing was rendered
+            if (it == backend::frames.end())
+                return nullptr;
 
-            return (*it)->colorPtr;
+            return (*it)->channelPtr(channel);
         }
 
         void renderFrame(generic::Frame& frame)
@@ -1716,6 +5727,8 @@ namespace generic {
             flushCommitBuffer();
 
             frame.renderFuture = std::async([&frame]() {
+                std::shared_lock<std::shared_mutex> l(stateMutex);
+
                 auto fit = std::find_if(backend::frames.begin(),backend::frames.end(),
                                         [&frame](const Frame::SP& f) {
                                             return f->handle == frame.getResourceHandle();
@@ -1737,10 +5750,11 @@ namespace generic {
                                             return wrld->handle == frame.world;
                                         });
 
-                assert(fit != backend::frames.end());
-                assert(rit != backend::renderers.end());
-                assert(cit != backend::cameras.end());
-                assert(wit != backend::worlds.end());
+                // The frame (or what it renders) may have been released
+                // after the render was issued but before this task started
+                if (fit == backend::frames.end() || rit == backend::renderers.end()
+                 || cit == backend::cameras.end() || wit == backend::worlds.end())
+                    return;
 
                 auto start = std::chrono::steady_clock::now();
                 if ((*fit)->updated || (*rit)->updated || (*cit)->updated) {
@@ -1,10 +1,13 @@
 #pragma once
 
+#include "amrfield.hpp"
 #include "ao.hpp"
 #include "camera.hpp"
 #include "cylindergeom.hpp"
+#include "directionallight.hpp"
 #include "frame.hpp"
 #include "group.hpp"
+#include "hdrilight.hpp"
 #include "instance.hpp"
 #include "light.hpp"
 #include "matte.hpp"
@@ -13,9 +16,12 @@
 #include "perspectivecamera.hpp"
 #include "pointlight.hpp"
 #include "quadlight.hpp"
+#include "sparseregular.hpp"
+#include "spheregeom.hpp"
 #include "structuredregular.hpp"
 #include "surface.hpp"
 #include "trianglegeom.hpp"
+#include "unstructuredfield.hpp"
 #include "volume.hpp"
 #include "world.hpp"
 
@@ -39,12 +45,18 @@ namespace generic {
 
         void commit(generic::QuadLight& light);
 
+        void commit(generic::DirectionalLight& light);
+
+        void commit(generic::HDRILight& light);
+
         void commit(generic::Frame& frame);
 
         void commit(generic::TriangleGeom& geom);
 
         void commit(generic::CylinderGeom& geom);
 
+        void commit(generic::SphereGeom& geom);
+
         void commit(generic::Matte& mat);
 
         void commit(generic::Surface& surf);
@@ -53,6 +65,12 @@ namespace generic {
 
         void commit(generic::StructuredRegular& sr);
 
+        void commit(generic::AMRField& amr);
+
+        void commit(generic::SparseRegular& sr);
+
+        void commit(generic::UnstructuredField& uf);
+
         void commit(generic::Volume& vol);
 
         void commit(generic::Renderer& rend);
@@ -61,10 +79,22 @@ namespace generic {
 
         void commit(generic::Pathtracer& pt);
 
-        void* map(generic::Frame& frame);
+        // Pointer to a frame channel ("channel.color", "channel.depth", ...),
+        // null if the channel was not requested
+        void* map(generic::Frame& frame, const char* channel);
         void renderFrame(generic::Frame& frame);
         int wait(generic::Frame& frame, ANARIWaitMask m);
 
+        // Reclaim the backend objects of a resource whose last reference
+        // was released; happens when the commit buffer is flushed next
+        void release(ResourceHandle handle);
+
+        // Memory held by backend framebuffers and acceleration structures
+        size_t getSizeInBytes();
+
+        // Traverse the TLASes of worlds committed from now on as 4-wide BVHs
+        void setWideBVH(bool wide);
+
     } // backend
 } // generic
 
@@ -3,6 +3,7 @@
 #include "backend.hpp"
 #include "camera.hpp"
 #include "logging.hpp"
+#include "param.hpp"
 #include "perspectivecamera.hpp"
 
 namespace generic {
@@ -34,63 +35,36 @@ namespace generic {
     {
     }
 
+    static constexpr auto paramTable = sortParams({
+        GENERIC_PARAM(CameraParams,"position",ANARI_FLOAT32_VEC3,position),
+        GENERIC_PARAM(CameraParams,"direction",ANARI_FLOAT32_VEC3,direction),
+        GENERIC_PARAM(CameraParams,"up",ANARI_FLOAT32_VEC3,up),
+        GENERIC_PARAM(CameraParams,"transform",ANARI_FLOAT32_MAT3x4,transform),
+        GENERIC_PARAM(CameraParams,"imageRegion",ANARI_FLOAT32_BOX2,imageRegion),
+        GENERIC_PARAM(CameraParams,"apertureRadius",ANARI_FLOAT32,apertureRadius),
+        GENERIC_PARAM(CameraParams,"focusDistance",ANARI_FLOAT32,focusDistance),
+        GENERIC_PARAM(CameraParams,"stereoMode",ANARI_STRING,stereoMode),
+        GENERIC_PARAM(CameraParams,"interpupillaryDistance",ANARI_FLOAT32,interpupillaryDistance),
+    });
+    static_assert(uniqueParamHashes(paramTable));
+
     void Camera::setParameter(const char* name,
                               ANARIDataType type,
                               const void* mem)
     {
-        if (strncmp(name,"position",8)==0 && type==ANARI_FLOAT32_VEC3) {
-            memcpy(position,mem,sizeof(position));
-        } else if (strncmp(name,"direction",9)==0 && type==ANARI_FLOAT32_VEC3) {
-            memcpy(direction,mem,sizeof(direction));
-        } else if (strncmp(name,"up",2)==0 && type==ANARI_FLOAT32_VEC3) {
-            memcpy(up,mem,sizeof(up));
-        } else if (strncmp(name,"transform",9)==0 && type==ANARI_FLOAT32_MAT3x4) {
-            memcpy(transform,mem,sizeof(transform));
-        } else if (strncmp(name,"imageRegion",11)==0 && type==ANARI_FLOAT32_BOX2) {
-            memcpy(imageRegion,mem,sizeof(imageRegion));
-        } else if (strncmp(name,"apertureRadius",14)==0 && type==ANARI_FLOAT32) {
-            memcpy(&apertureRadius,mem,sizeof(apertureRadius));
-        } else if (strncmp(name,"focusDistance",13)==0 && type==ANARI_FLOAT32) {
-            memcpy(&focusDistance,mem,sizeof(focusDistance));
-        } else if (strncmp(name,"stereoMode",11)==0 && type==ANARI_STRING) {
-            stereoMode = (const char*)mem;
-        } else if (strncmp(name,"interpupillaryDistance",23)==0 && type==ANARI_FLOAT32) {
-            memcpy(&interpupillaryDistance,mem,sizeof(interpupillaryDistance));
-        } else {
-            LOG(logging::Level::Warning) << "Camera: Unsupported parameter "
-                << "/parameter type: " << name << " / " << type;
-        }
+        if (setParam(paramTable,static_cast<CameraParams&>(*this),name,type,mem))
+            return;
+
+        LOG(logging::Level::Warning) << "Camera: Unsupported parameter "
+            << "/parameter type: " << name << " / " << type;
     }
 
     void Camera::unsetParameter(const char* name)
     {
-        if (strncmp(name,"position",8)==0) {
-            position[0] = position[1] = position[2] = 0.f;
-        } else if (strncmp(name,"direction",9)==0) {
-            direction[0] = direction[1] = 0.f; direction[2] = -1.f;
-        } else if (strncmp(name,"up",2)==0) {
-            up[0] = 0.f; up[1] = 1.f; up[2] = 0.f;
-        } else if (strncmp(name,"transform",9)==0) {
-            for (int i=0; i<3; ++i) {
-                for (int j=0; j<3; ++j) {
-                    transform[i][j] = (i==j) ? 1.f : 0.f;
-                }
-            }
-            transform[3][0] = transform[3][1] = transform[3][2] = 0.f;
-        } else if (strncmp(name,"imageRegion",11)==0) {
-            imageRegion[0][0] = imageRegion[0][1] = 0.f;
-            imageRegion[1][0] = imageRegion[1][1] = 1.f;
-        } else if (strncmp(name,"apertureRadius",14)==0) {
-            apertureRadius = 0.f;
-        } else if (strncmp(name,"focusDistance",13)==0) {
-            focusDistance = 1.f;
-        } else if (strncmp(name,"stereoMode",11)==0) {
-            stereoMode = "none";
-        } else if (strncmp(name,"interpupillaryDistance",23)==0) {
-            interpupillaryDistance = .0635f;
-        } else {
-            LOG(logging::Level::Warning) << "Camera: Unsupported parameter " << name;
-        }
+        if (unsetParam(paramTable,static_cast<CameraParams&>(*this),name))
+            return;
+
+        LOG(logging::Level::Warning) << "Camera: Unsupported parameter " << name;
     }
 
     std::unique_ptr<Camera> createCamera(const char* subtype)
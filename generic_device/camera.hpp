@@ -5,7 +5,20 @@
 
 namespace generic {
 
-    class Camera : public Object
+    struct CameraParams
+    {
+        float position[3] = {0.f,0.f,0.f};
+        float direction[3] = {0.f,0.f,-1.f};
+        float up[3] = {0.f,1.f,0.f};
+        float transform[4][3] = {{1.f,0.f,0.f},{0.f,1.f,0.f},{0.f,0.f,1.f},{0.f,0.f,0.f}};
+        float imageRegion[2][2] = {{0.f,0.f},{1.f,1.f}};
+        float apertureRadius = 0.f;
+        float focusDistance = 1.f;
+        char stereoMode[16] = "none";
+        float interpupillaryDistance = .0635f;
+    };
+
+    class Camera : public Object, public CameraParams
     {
     public:
         Camera();
@@ -27,16 +40,6 @@ namespace generic {
 
         virtual void unsetParameter(const char* name);
 
-        float position[3] = {0.f,0.f,0.f};
-        float direction[3] = {0.f,0.f,-1.f};
-        float up[3] = {0.f,1.f,0.f};
-        float transform[4][3] = {{1.f,0.f,0.f},{0.f,1.f,0.f},{0.f,0.f,1.f},{0.f,0.f,0.f}};
-        float imageRegion[2][2] = {{0.f,0.f},{1.f,1.f}};
-        float apertureRadius = 0.f;
-        float focusDistance = 1.f;
-        const char* stereoMode = "none";
-        float interpupillaryDistance = .0635f;
-
     private:
         ANARICamera resourceHandle;
     };
@@ -1,7 +1,9 @@
 #include <string.h>
+#include "array.hpp"
 #include "backend.hpp"
 #include "cylindergeom.hpp"
 #include "logging.hpp"
+#include "param.hpp"
 
 namespace generic {
 
@@ -11,15 +13,59 @@ namespace generic {
 
     CylinderGeom::~CylinderGeom()
     {
+        ReleaseResource(vertex_position);
+        ReleaseResource(vertex_cap);
+        ReleaseResource(vertex_color);
+        ReleaseResource(vertex_attribute0);
+        ReleaseResource(vertex_attribute1);
+        ReleaseResource(vertex_attribute2);
+        ReleaseResource(vertex_attribute3);
+        ReleaseResource(primitive_index);
+        ReleaseResource(primitive_radius);
     }
 
     void CylinderGeom::commit()
     {
-        if (vertex_position == nullptr)
+        if (vertex_position == nullptr) {
             LOG(logging::Level::Error) << "Cylinder error: vertex.position not set but "
                 << "is a required parameter";
-        else
-            backend::commit(*this);
+            return;
+        }
+
+        // Other element types are converted on commit
+        Array1D* position = (Array1D*)GetResource(vertex_position);
+        Array1D* index = (Array1D*)GetResource(primitive_index);
+        Array1D* radius = (Array1D*)GetResource(primitive_radius);
+        Array1D* cap = (Array1D*)GetResource(vertex_cap);
+        if (!position->convertibleTo(ANARI_FLOAT32_VEC3)
+         || (index != nullptr && !index->convertibleTo(ANARI_UINT32_VEC2))
+         || (radius != nullptr && !radius->convertibleTo(ANARI_FLOAT32))
+         || (cap != nullptr && !cap->convertibleTo(ANARI_UINT32))) {
+            LOG(logging::Level::Error) << "Cylinder error: unsupported vertex.position, "
+                << "primitive.index, primitive.radius or vertex.cap element type";
+            return;
+        }
+
+        size_t numCylinders = index != nullptr ? index->numItems[0] : position->numItems[0]/2;
+
+        if (radius != nullptr && radius->numItems[0] < numCylinders) {
+            LOG(logging::Level::Error) << "Cylinder error: primitive.radius has fewer "
+                << "elements than there are cylinders";
+            return;
+        }
+
+        if (cap != nullptr && cap->numItems[0] < position->numItems[0]) {
+            LOG(logging::Level::Error) << "Cylinder error: vertex.cap has fewer "
+                << "elements than vertex.position";
+            return;
+        }
+
+        if (index == nullptr && position->numItems[0]%2 != 0) {
+            LOG(logging::Level::Warning) << "Cylinder warning: vertex.position size "
+                << "is not a multiple of two, ignoring the trailing vertex";
+        }
+
+        backend::commit(*this);
     }
 
     void CylinderGeom::release()
@@ -30,65 +76,38 @@ namespace generic {
     {
     }
 
+    static constexpr auto paramTable = sortParams({
+        GENERIC_PARAM(CylinderGeomParams,"vertex.position",ANARI_ARRAY1D,vertex_position),
+        GENERIC_PARAM(CylinderGeomParams,"vertex.cap",ANARI_ARRAY1D,vertex_cap),
+        GENERIC_PARAM(CylinderGeomParams,"vertex.color",ANARI_ARRAY1D,vertex_color),
+        GENERIC_PARAM(CylinderGeomParams,"vertex.attribute0",ANARI_ARRAY1D,vertex_attribute0),
+        GENERIC_PARAM(CylinderGeomParams,"vertex.attribute1",ANARI_ARRAY1D,vertex_attribute1),
+        GENERIC_PARAM(CylinderGeomParams,"vertex.attribute2",ANARI_ARRAY1D,vertex_attribute2),
+        GENERIC_PARAM(CylinderGeomParams,"vertex.attribute3",ANARI_ARRAY1D,vertex_attribute3),
+        GENERIC_PARAM(CylinderGeomParams,"primitive.index",ANARI_ARRAY1D,primitive_index),
+        GENERIC_PARAM(CylinderGeomParams,"primitive.radius",ANARI_ARRAY1D,primitive_radius),
+        GENERIC_PARAM(CylinderGeomParams,"radius",ANARI_FLOAT32,radius),
+        GENERIC_PARAM(CylinderGeomParams,"caps",ANARI_STRING,caps),
+    });
+    static_assert(uniqueParamHashes(paramTable));
+
     void CylinderGeom::setParameter(const char* name,
                                     ANARIDataType type,
                                     const void* mem)
     {
-        if (strncmp(name,"vertex.position",15)==0 && type==ANARI_ARRAY1D) {
-            vertex_position = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"vertex.cap",10)==0 && type==ANARI_ARRAY1D) {
-            vertex_cap = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"vertex.color",12)==0 && type==ANARI_ARRAY1D) {
-            vertex_color = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"vertex.attribute0",17)==0 && type==ANARI_ARRAY1D) {
-            vertex_attribute0 = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"vertex.attribute1",17)==0 && type==ANARI_ARRAY1D) {
-            vertex_attribute1 = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"vertex.attribute2",17)==0 && type==ANARI_ARRAY1D) {
-            vertex_attribute2 = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"vertex.attribute3",17)==0 && type==ANARI_ARRAY1D) {
-            vertex_attribute3 = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"primitive.index",15)==0 && type==ANARI_ARRAY1D) {
-            primitive_index = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"primitive.radius",16)==0 && type==ANARI_ARRAY1D) {
-            primitive_radius = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"radius",6)==0 && type==ANARI_FLOAT32) {
-            memcpy(&radius,mem,sizeof(radius));
-        } else if (strncmp(name,"caps",4)==0 && type==ANARI_STRING) {
-            caps = (const char*)mem;
-        } else {
-            LOG(logging::Level::Warning) << "Cylinder: Unsupported parameter "
-                << "/ parameter type: " << name << " / " << type;
-        }
+        if (setParam(paramTable,static_cast<CylinderGeomParams&>(*this),name,type,mem))
+            return;
+
+        LOG(logging::Level::Warning) << "Cylinder: Unsupported parameter "
+            << "/ parameter type: " << name << " / " << type;
     }
 
     void CylinderGeom::unsetParameter(const char* name)
     {
-        if (strncmp(name,"vertex.position",15)==0) {
-            vertex_position = nullptr;
-        } else if (strncmp(name,"vertex.cap",10)==0) {
-            vertex_cap = nullptr;
-        } else if (strncmp(name,"vertex.color",12)==0) {
-            vertex_color = nullptr;
-        } else if (strncmp(name,"vertex.attribute0",17)==0) {
-            vertex_attribute0 = nullptr;
-        } else if (strncmp(name,"vertex.attribute1",17)==0) {
-            vertex_attribute1 = nullptr;
-        } else if (strncmp(name,"vertex.attribute2",17)==0) {
-            vertex_attribute2 = nullptr;
-        } else if (strncmp(name,"vertex.attribute3",17)==0) {
-            vertex_attribute3 = nullptr;
-        } else if (strncmp(name,"primitive.index",15)==0) {
-            primitive_index = nullptr;
-        } else if (strncmp(name,"primitive.radius",16)==0) {
-            primitive_radius = nullptr;
-        } else if (strncmp(name,"radius",6)==0) {
-            radius = 1.f;
-        } else if (strncmp(name,"caps",4)==0) {
-            caps = "none";
-        } else {
-            LOG(logging::Level::Warning) << "Cylinder: Unsupported parameter " << name;
-        }
+        if (unsetParam(paramTable,static_cast<CylinderGeomParams&>(*this),name))
+            return;
+
+        LOG(logging::Level::Warning) << "Cylinder: Unsupported parameter " << name;
     }
 
 } // generic
@@ -4,7 +4,22 @@
 
 namespace generic {
 
-    class CylinderGeom : public Geometry
+    struct CylinderGeomParams
+    {
+        ANARIArray1D vertex_position = nullptr;
+        ANARIArray1D vertex_cap = nullptr;
+        ANARIArray1D vertex_color = nullptr;
+        ANARIArray1D vertex_attribute0 = nullptr;
+        ANARIArray1D vertex_attribute1 = nullptr;
+        ANARIArray1D vertex_attribute2 = nullptr;
+        ANARIArray1D vertex_attribute3 = nullptr;
+        ANARIArray1D primitive_index = nullptr;
+        ANARIArray1D primitive_radius = nullptr;
+        float radius = 1.f;
+        char caps[16] = "none";
+    };
+
+    class CylinderGeom : public Geometry, public CylinderGeomParams
     {
     public:
         CylinderGeom();
@@ -21,18 +36,6 @@ namespace generic {
                           const void* mem);
 
         void unsetParameter(const char* name);
-
-        ANARIArray1D vertex_position = nullptr;
-        ANARIArray1D vertex_cap = nullptr;
-        ANARIArray1D vertex_color = nullptr;
-        ANARIArray1D vertex_attribute0 = nullptr;
-        ANARIArray1D vertex_attribute1 = nullptr;
-        ANARIArray1D vertex_attribute2 = nullptr;
-        ANARIArray1D vertex_attribute3 = nullptr;
-        ANARIArray1D primitive_index = nullptr;
-        ANARIArray1D primitive_radius = nullptr;
-        float radius = 1.f;
-        const char* caps = "none";
     };
 
 } // generic
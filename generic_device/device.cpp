@@ -1,6 +1,10 @@
 #include <anari/backend/LibraryImpl.h>
+#include <anari/anari_cpp.hpp>
 
+#include <string.h>
+#include <algorithm>
 #include "array.hpp"
+#include "backend.hpp"
 #include "camera.hpp"
 #include "device.hpp"
 #include "frame.hpp"
@@ -60,8 +64,10 @@ namespace generic {
         return as->internalData;
     }
 
-    void Device::unmapArray(ANARIArray)
+    void Device::unmapArray(ANARIArray array)
     {
+        ArrayStorage* as = (ArrayStorage*)GetResource(array);
+        as->retainObjects();
     }
 
     //--- Renderable Objects ------------------------------
@@ -134,21 +140,45 @@ namespace generic {
                               ANARIDataType type,
                               const void* mem)
     {
-        Object* obj = (Object*)GetResource(object);
-        if (obj == nullptr)
+        if (object == (ANARIObject)this) {
+            if (strcmp(name,"wideBVH")==0 && type==ANARI_BOOL) {
+                bool wide = false;
+                memcpy(&wide,mem,sizeof(wide));
+                backend::setWideBVH(wide);
+            } else {
+                LOG(logging::Level::Warning) << "ANARIDevice: Unsupported parameter "
+                    << "/ parameter type: " << name << " / " << type;
+            }
+            return;
+        }
+
+        Resource* res = GetResource(object);
+        if (res == nullptr) {
             LOG(logging::Level::Error) << "ANARIDevice error: setting parameter on object: " << name;
+            return;
+        }
+
+        std::unique_lock<std::mutex> l(res->paramMutex);
+        if (ArrayStorage* as = dynamic_cast<ArrayStorage*>(res))
+            as->setParameter(name,type,mem);
         else
-            obj->setParameter(name,type,mem);
+            ((Object*)res)->setParameter(name,type,mem);
     }
 
     void Device::unsetParameter(ANARIObject object,
                                 const char* name)
     {
-        Object* obj = (Object*)GetResource(object);
-        if (obj == nullptr)
+        Resource* res = GetResource(object);
+        if (res == nullptr) {
             LOG(logging::Level::Error) << "ANARIDevice error: unsetting parameter on object: " << name;
+            return;
+        }
+
+        std::unique_lock<std::mutex> l(res->paramMutex);
+        if (ArrayStorage* as = dynamic_cast<ArrayStorage*>(res))
+            as->unsetParameter(name);
         else
-            obj->unsetParameter(name);
+            ((Object*)res)->unsetParameter(name);
     }
 
     void* Device::mapParameterArray1D(ANARIObject object,
@@ -157,6 +187,8 @@ namespace generic {
                               uint64_t numElements1,
                               uint64_t *elementStride)
     {
+        ANARIArray1D array = newArray1D(nullptr,nullptr,nullptr,dataType,numElements1);
+        return mapParameterArray(object,name,ANARI_ARRAY1D,array,elementStride);
     }
 
     void* Device::mapParameterArray2D(ANARIObject object,
@@ -166,6 +198,9 @@ namespace generic {
                               uint64_t numElements2,
                               uint64_t *elementStride)
     {
+        ANARIArray2D array = newArray2D(nullptr,nullptr,nullptr,dataType,numElements1,
+                                        numElements2);
+        return mapParameterArray(object,name,ANARI_ARRAY2D,array,elementStride);
     }
 
     void* Device::mapParameterArray3D(ANARIObject object,
@@ -176,38 +211,93 @@ namespace generic {
                                       uint64_t numElements3,
                                       uint64_t *elementStride)
     {
+        ANARIArray3D array = newArray3D(nullptr,nullptr,nullptr,dataType,numElements1,
+                                        numElements2,numElements3);
+        return mapParameterArray(object,name,ANARI_ARRAY3D,array,elementStride);
     }
 
     void Device::unmapParameterArray(ANARIObject object,
                                      const char* name)
     {
+        MappedParameter param;
+
+        {
+            std::unique_lock<std::mutex> l(mappedParametersMutex);
+            auto it = std::find_if(mappedParameters.begin(),mappedParameters.end(),
+                                   [object,name](const MappedParameter& p) {
+                                       return p.object == object && p.name == name;
+                                   });
+
+            if (it == mappedParameters.end()) {
+                LOG(logging::Level::Error) << "ANARIDevice error: unmapping parameter that "
+                    << "was not mapped: " << name;
+                return;
+            }
+
+            param = *it;
+            mappedParameters.erase(it);
+        }
+
+        unmapArray(param.array);
+
+        // The object takes its own reference, drop the device's one
+        setParameter(object,name,param.arrayType,&param.array);
+        ReleaseResource(param.array);
+    }
+
+    void* Device::mapParameterArray(ANARIObject object,
+                                    const char* name,
+                                    ANARIDataType arrayType,
+                                    ANARIArray array,
+                                    uint64_t* elementStride)
+    {
+        ArrayStorage* as = (ArrayStorage*)GetResource(array);
+
+        if (elementStride != nullptr)
+            *elementStride = anari::sizeOf(as->elementType);
+
+        std::unique_lock<std::mutex> l(mappedParametersMutex);
+        mappedParameters.push_back({object,name,arrayType,array});
+
+        return as->internalData;
     }
 
     void Device::commitParameters(ANARIObject object)
     {
+        if (object == (ANARIObject)this)
+            return;
+
         Object* obj = (Object*)GetResource(object);
-        if (obj == nullptr)
+        if (obj == nullptr) {
             LOG(logging::Level::Error) << "ANARIDevice error: commit called on uninitialized object";
-        else
-            obj->commit();
+            return;
+        }
+
+        // The backend snapshots the parameters while the lock is held
+        std::unique_lock<std::mutex> l(obj->paramMutex);
+        obj->commit();
     }
 
     void Device::release(ANARIObject object) 
     {
-        Object* obj = (Object*)GetResource(object);
-        if (obj == nullptr)
+        Resource* res = GetResource(object);
+        if (res == nullptr) {
             LOG(logging::Level::Error) << "ANARIDevice error: release called on uninitialized object";
-        else
-            obj->release();
+        } else {
+            res->release();
+            ReleaseResource(object);
+        }
     }
 
     void Device::retain(ANARIObject object)
     {
-        Object* obj = (Object*)GetResource(object);
-        if (obj == nullptr)
+        Resource* res = GetResource(object);
+        if (res == nullptr) {
             LOG(logging::Level::Error) << "ANARIDevice error: retain called on uninitialized object";
-        else
-            obj->retain();
+        } else {
+            res->retain();
+            RetainResource(object);
+        }
     }
 
     //--- Object Query Interface --------------------------
@@ -219,6 +309,26 @@ namespace generic {
                             uint64_t size,
                             ANARIWaitMask mask)
     {
+        if (object == (ANARIObject)this) {
+            // Live objects and bytes, the latter counting array data owned
+            // by the device plus backend framebuffers and BVHs
+            if (strcmp(name,"liveObjects")==0 && type==ANARI_UINT64) {
+                uint64_t numObjects = GetNumResources();
+                memcpy(mem,&numObjects,sizeof(numObjects));
+                return 1;
+            } else if (strcmp(name,"liveBytes")==0 && type==ANARI_UINT64) {
+                uint64_t numBytes = ArrayStorage::getAllocatedBytes()
+                                  + backend::getSizeInBytes();
+                memcpy(mem,&numBytes,sizeof(numBytes));
+                return 1;
+            } else if (strcmp(name,"copiedBytes")==0 && type==ANARI_UINT64) {
+                uint64_t numBytes = ArrayStorage::getCopiedBytes();
+                memcpy(mem,&numBytes,sizeof(numBytes));
+                return 1;
+            }
+            return 0;
+        }
+
         Object* obj = (Object*)GetResource(object);
         if (obj == nullptr) {
             LOG(logging::Level::Error) << "ANARIDevice error: querying prpertion on object: " << name;
@@ -277,14 +387,41 @@ namespace generic {
                                        ANARIDataType* pixelType)
     {
         Frame* frame = (Frame*)GetResource(fb);
+        if (frame == nullptr) {
+            *width = *height = 0;
+            *pixelType = ANARI_UNKNOWN;
+            return nullptr;
+        }
+
         *width = frame->size[0];
         *height = frame->size[1];
+        *pixelType = ANARI_UNKNOWN;
         if (strncmp(channel,"channel.color",13)==0) {
             *pixelType = frame->color;
         } else if (strncmp(channel,"channel.depth",13)==0) {
             *pixelType = frame->depth;
+        } else if (strncmp(channel,"channel.normal",14)==0) {
+            *pixelType = frame->normal;
+        } else if (strncmp(channel,"channel.albedo",14)==0) {
+            *pixelType = frame->albedo;
+        } else if (strncmp(channel,"channel.primitiveId",19)==0) {
+            *pixelType = frame->primitiveId;
+        } else if (strncmp(channel,"channel.objectId",16)==0) {
+            *pixelType = frame->objectId;
+        } else if (strncmp(channel,"channel.instanceId",18)==0) {
+            *pixelType = frame->instanceId;
+        }
+
+        // Channels that were not requested are not written, don't let the
+        // application read them
+        const void* ptr = frame->map(channel);
+        if (ptr == nullptr) {
+            LOG(logging::Level::Warning) << "ANARIDevice: mapping frame channel "
+                << "that was not requested: " << channel;
+            *width = *height = 0;
+            *pixelType = ANARI_UNKNOWN;
         }
-        return frame->map(channel);
+        return ptr;
     }
 
     void Device::frameBufferUnmap(ANARIFrame fb,
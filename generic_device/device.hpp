@@ -1,6 +1,9 @@
 
 #pragma once
 
+#include <mutex>
+#include <string>
+#include <vector>
 #include <anari/backend/helium/utility/ParameterizedObject.h>
 #include <anari/backend/DeviceImpl.h>
 
@@ -158,6 +161,26 @@ namespace generic {
     public:
         Device();
        ~Device();
+
+    private:
+        // Arrays handed out by mapParameterArray*(), bound to the
+        // object parameter on unmapParameterArray()
+        struct MappedParameter
+        {
+            ANARIObject object;
+            std::string name;
+            ANARIDataType arrayType;
+            ANARIArray array;
+        };
+
+        std::mutex mappedParametersMutex;
+        std::vector<MappedParameter> mappedParameters;
+
+        void* mapParameterArray(ANARIObject object,
+                                const char* name,
+                                ANARIDataType arrayType,
+                                ANARIArray array,
+                                uint64_t* elementStride);
     };
 
 } // generic
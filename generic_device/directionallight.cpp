@@ -0,0 +1,58 @@
+#include <string.h>
+#include "backend.hpp"
+#include "param.hpp"
+#include "directionallight.hpp"
+
+namespace generic {
+
+    DirectionalLight::DirectionalLight()
+        : Light()
+    {
+    }
+
+    DirectionalLight::~DirectionalLight()
+    {
+    }
+
+    void DirectionalLight::commit()
+    {
+        backend::commit(*this);
+        Light::commit();
+    }
+
+    void DirectionalLight::release()
+    {
+        Light::release();
+    }
+
+    void DirectionalLight::retain()
+    {
+        Light::retain();
+    }
+
+    static constexpr auto paramTable = sortParams({
+        GENERIC_PARAM(DirectionalLightParams,"direction",ANARI_FLOAT32_VEC3,direction),
+        GENERIC_PARAM(DirectionalLightParams,"irradiance",ANARI_FLOAT32,irradiance),
+    });
+    static_assert(uniqueParamHashes(paramTable));
+
+    void DirectionalLight::setParameter(const char* name,
+                                        ANARIDataType type,
+                                        const void* mem)
+    {
+        if (setParam(paramTable,static_cast<DirectionalLightParams&>(*this),name,type,mem))
+            return;
+
+        Light::setParameter(name,type,mem);
+    }
+
+    void DirectionalLight::unsetParameter(const char* name)
+    {
+        if (unsetParam(paramTable,static_cast<DirectionalLightParams&>(*this),name))
+            return;
+
+        Light::unsetParameter(name);
+    }
+
+} // generic
+
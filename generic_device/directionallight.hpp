@@ -0,0 +1,33 @@
+#pragma once
+
+#include "light.hpp"
+
+namespace generic {
+
+    struct DirectionalLightParams
+    {
+        float direction[3] = {0.f,0.f,-1.f};
+        float irradiance = 1.f;
+    };
+
+    class DirectionalLight : public Light, public DirectionalLightParams
+    {
+    public:
+        DirectionalLight();
+       ~DirectionalLight();
+
+        void commit();
+
+        void release();
+
+        void retain();
+
+        void setParameter(const char* name,
+                          ANARIDataType type,
+                          const void* mem);
+
+        void unsetParameter(const char* name);
+    };
+
+} // generic
+
@@ -3,6 +3,7 @@
 #include "backend.hpp"
 #include "frame.hpp"
 #include "logging.hpp"
+#include "param.hpp"
 #include "frame.hpp"
 
 namespace generic {
@@ -14,11 +15,14 @@ namespace generic {
 
     Frame::~Frame()
     {
+        ReleaseResource(world);
+        ReleaseResource(camera);
+        ReleaseResource(renderer);
     }
 
     const void* Frame::map(const char* channel)
     {
-        return backend::map(*this);
+        return backend::map(*this,channel);
     }
 
     int Frame::wait(ANARIWaitMask m)
@@ -33,6 +37,23 @@ namespace generic {
 
     void Frame::commit()
     {
+        if (color != ANARI_UNKNOWN && color != ANARI_UFIXED8_VEC4
+         && color != ANARI_UFIXED8_RGBA_SRGB && color != ANARI_FLOAT32_VEC4
+         && color != ANARI_FLOAT16_VEC4) {
+            LOG(logging::Level::Warning) << "Frame: unsupported channel.color type "
+                << color << ", falling back to ANARI_UFIXED8_VEC4";
+        }
+
+        if ((depth != ANARI_UNKNOWN && depth != ANARI_FLOAT32)
+         || (normal != ANARI_UNKNOWN && normal != ANARI_FLOAT32_VEC3)
+         || (albedo != ANARI_UNKNOWN && albedo != ANARI_FLOAT32_VEC3)
+         || (primitiveId != ANARI_UNKNOWN && primitiveId != ANARI_UINT32)
+         || (objectId != ANARI_UNKNOWN && objectId != ANARI_UINT32)
+         || (instanceId != ANARI_UNKNOWN && instanceId != ANARI_UINT32)) {
+            LOG(logging::Level::Warning) << "Frame: unsupported channel type, "
+                << "the channel will not be written";
+        }
+
         backend::commit(*this);
     }
 
@@ -44,45 +65,40 @@ namespace generic {
     {
     }
 
+    static constexpr auto paramTable = sortParams({
+        GENERIC_PARAM(FrameParams,"world",ANARI_WORLD,world),
+        GENERIC_PARAM(FrameParams,"camera",ANARI_CAMERA,camera),
+        GENERIC_PARAM(FrameParams,"renderer",ANARI_RENDERER,renderer),
+        GENERIC_PARAM(FrameParams,"size",ANARI_UINT32_VEC2,size),
+        GENERIC_PARAM(FrameParams,"channel.color",ANARI_DATA_TYPE,color),
+        GENERIC_PARAM(FrameParams,"channel.depth",ANARI_DATA_TYPE,depth),
+        GENERIC_PARAM(FrameParams,"channel.normal",ANARI_DATA_TYPE,normal),
+        GENERIC_PARAM(FrameParams,"channel.albedo",ANARI_DATA_TYPE,albedo),
+        GENERIC_PARAM(FrameParams,"channel.primitiveId",ANARI_DATA_TYPE,primitiveId),
+        GENERIC_PARAM(FrameParams,"channel.objectId",ANARI_DATA_TYPE,objectId),
+        GENERIC_PARAM(FrameParams,"channel.instanceId",ANARI_DATA_TYPE,instanceId),
+        GENERIC_PARAM(FrameParams,"denoise",ANARI_BOOL,denoise),
+        GENERIC_PARAM(FrameParams,"tonemap",ANARI_STRING,tonemap),
+    });
+    static_assert(uniqueParamHashes(paramTable));
+
     void Frame::setParameter(const char* name,
                              ANARIDataType type,
                              const void* mem)
     {
-        if (strncmp(name,"world",5)==0 && type==ANARI_WORLD) {
-            world = *(ANARIWorld*)mem; // TODO: reference count
-        } else if (strncmp(name,"camera",6)==0 && type==ANARI_CAMERA) {
-            camera = *(ANARICamera*)mem; // TODO: reference count
-        } else if (strncmp(name,"renderer",8)==0 && type==ANARI_RENDERER) {
-            renderer = *(ANARIRenderer*)mem; // TODO: reference count
-        } else if (strncmp(name,"size",4)==0 && type==ANARI_UINT32_VEC2) {
-            memcpy(size,mem,sizeof(size));
-        } else if (strncmp(name,"channel.color",13)==0 && type==ANARI_DATA_TYPE) {
-            memcpy(&color,mem,sizeof(color));
-        } else if (strncmp(name,"channel.depth",13)==0 && type==ANARI_DATA_TYPE) {
-            memcpy(&depth,mem,sizeof(depth));
-        } else {
-            LOG(logging::Level::Warning) << "Frame: Unsupported parameter "
-                << "/ parameter type: " << name << " / " << type;
-        }
+        if (setParam(paramTable,static_cast<FrameParams&>(*this),name,type,mem))
+            return;
+
+        LOG(logging::Level::Warning) << "Frame: Unsupported parameter "
+            << "/ parameter type: " << name << " / " << type;
     }
 
     void Frame::unsetParameter(const char* name)
     {
-        if (strncmp(name,"world",5)==0) {
-            world = nullptr;
-        } else if (strncmp(name,"camera",6)==0) {
-            camera = nullptr;
-        } else if (strncmp(name,"renderer",8)==0) {
-            renderer = nullptr;
-        } else if (strncmp(name,"size",4)==0) {
-            size[0] = size[1] = 0;
-        } else if (strncmp(name,"color",5)==0) {
-            color = {};
-        } else if (strncmp(name,"depth",5)==0) {
-            depth = {};
-        } else {
-            LOG(logging::Level::Warning) << "Frame: Unsupported parameter " << name;
-        }
+        if (unsetParam(paramTable,static_cast<FrameParams&>(*this),name))
+            return;
+
+        LOG(logging::Level::Warning) << "Frame: Unsupported parameter " << name;
     }
 
     int Frame::getProperty(const char* name,
@@ -6,7 +6,28 @@
 
 namespace generic {
 
-    class Frame : public Object
+    struct FrameParams
+    {
+        ANARIWorld world = nullptr;
+        ANARICamera camera = nullptr;
+        ANARIRenderer renderer = nullptr;
+        unsigned size[2] = {0,0};
+        ANARIDataType color = ANARI_UNKNOWN;
+        ANARIDataType depth = ANARI_UNKNOWN;
+        ANARIDataType normal = ANARI_UNKNOWN;
+        ANARIDataType albedo = ANARI_UNKNOWN;
+        ANARIDataType primitiveId = ANARI_UNKNOWN;
+        ANARIDataType objectId = ANARI_UNKNOWN;
+        ANARIDataType instanceId = ANARI_UNKNOWN;
+
+        // Filter the color channel guided by depth, normal and albedo
+        bool denoise = false;
+
+        // Tone mapping for 8-bit color: "none", "aces" or "acesApprox"
+        char tonemap[16] = "none";
+    };
+
+    class Frame : public Object, public FrameParams
     {
     public:
         Frame();
@@ -36,13 +57,6 @@ namespace generic {
                         uint64_t size,
                         uint32_t waitMask);
 
-        ANARIWorld world = nullptr;
-        ANARICamera camera = nullptr;
-        ANARIRenderer renderer = nullptr;
-        unsigned size[2] = {0,0};
-        ANARIDataType color = ANARI_UNKNOWN;
-        ANARIDataType depth = ANARI_UNKNOWN;
-
         std::future<void> renderFuture;
 
         // last duration for rendering
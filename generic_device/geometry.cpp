@@ -3,6 +3,7 @@
 #include "cylindergeom.hpp"
 #include "geometry.hpp"
 #include "logging.hpp"
+#include "spheregeom.hpp"
 #include "trianglegeom.hpp"
 
 namespace generic {
@@ -56,6 +57,8 @@ namespace generic {
             return std::make_unique<TriangleGeom>();
         else if (strncmp(subtype,"cylinder",8)==0)
             return std::make_unique<CylinderGeom>();
+        else if (strncmp(subtype,"sphere",6)==0)
+            return std::make_unique<SphereGeom>();
         else {
             LOG(logging::Level::Error) << "Geometry subtype unavailable: " << subtype;
             return std::make_unique<Geometry>();
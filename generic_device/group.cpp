@@ -3,6 +3,7 @@
 #include "backend.hpp"
 #include "group.hpp"
 #include "logging.hpp"
+#include "param.hpp"
 
 namespace generic {
 
@@ -13,6 +14,9 @@ namespace generic {
 
     Group::~Group()
     {
+        ReleaseResource(surface);
+        ReleaseResource(volume);
+        ReleaseResource(light);
     }
 
     ResourceHandle Group::getResourceHandle()
@@ -33,33 +37,30 @@ namespace generic {
     {
     }
 
+    static constexpr auto paramTable = sortParams({
+        GENERIC_PARAM(GroupParams,"surface",ANARI_ARRAY1D,surface),
+        GENERIC_PARAM(GroupParams,"volume",ANARI_ARRAY1D,volume),
+        GENERIC_PARAM(GroupParams,"light",ANARI_ARRAY1D,light),
+    });
+    static_assert(uniqueParamHashes(paramTable));
+
     void Group::setParameter(const char* name,
                              ANARIDataType type,
                              const void* mem)
     {
-        if (strncmp(name,"surface",7)==0 && type==ANARI_ARRAY1D) {
-            surface = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"volume",6)==0 && type==ANARI_ARRAY1D) {
-            volume = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"light",5)==0 && type==ANARI_ARRAY1D) {
-            light = *(ANARIArray1D*)mem; // TODO: reference count
-        } else {
-            LOG(logging::Level::Warning) << "Group: Unsupported parameter "
-                << "/ parameter type: " << name << " / " << type;
-        }
+        if (setParam(paramTable,static_cast<GroupParams&>(*this),name,type,mem))
+            return;
+
+        LOG(logging::Level::Warning) << "Group: Unsupported parameter "
+            << "/ parameter type: " << name << " / " << type;
     }
 
     void Group::unsetParameter(const char* name)
     {
-        if (strncmp(name,"surface",7)==0) {
-            surface = nullptr;
-        } else if (strncmp(name,"volume",6)==0) {
-            volume = nullptr;
-        } else if (strncmp(name,"light",5)==0) {
-            light = nullptr;
-        } else {
-            LOG(logging::Level::Warning) << "Group: Unsupported parameter " << name;
-        }
+        if (unsetParam(paramTable,static_cast<GroupParams&>(*this),name))
+            return;
+
+        LOG(logging::Level::Warning) << "Group: Unsupported parameter " << name;
     }
 
 } // generic
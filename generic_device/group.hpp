@@ -5,7 +5,14 @@
 
 namespace generic {
 
-    class Group : public Object
+    struct GroupParams
+    {
+        ANARIArray1D surface = nullptr;
+        ANARIArray1D volume = nullptr;
+        ANARIArray1D light = nullptr;
+    };
+
+    class Group : public Object, public GroupParams
     {
     public:
         Group();
@@ -25,9 +32,6 @@ namespace generic {
 
         void unsetParameter(const char* name);
 
-        ANARIArray1D surface = nullptr;
-        ANARIArray1D volume = nullptr;
-        ANARIArray1D light = nullptr;
         // TODO: bounds
 
     private:
@@ -0,0 +1,76 @@
+#include <string.h>
+#include "array.hpp"
+#include "backend.hpp"
+#include "hdrilight.hpp"
+#include "logging.hpp"
+#include "param.hpp"
+
+namespace generic {
+
+    HDRILight::HDRILight()
+        : Light()
+    {
+    }
+
+    HDRILight::~HDRILight()
+    {
+        ReleaseResource(radiance);
+    }
+
+    void HDRILight::commit()
+    {
+        if (radiance == nullptr) {
+            LOG(logging::Level::Error) << "Light.HDRI error: "
+                << "radiance not set but is a required parameter";
+            return;
+        }
+
+        Array2D* rad = (Array2D*)GetResource(radiance);
+        if (rad->elementType != ANARI_FLOAT32_VEC3) {
+            LOG(logging::Level::Error) << "Light.HDRI error: "
+                << "radiance must be a FLOAT32_VEC3 array";
+            return;
+        }
+
+        backend::commit(*this);
+        Light::commit();
+    }
+
+    void HDRILight::release()
+    {
+        Light::release();
+    }
+
+    void HDRILight::retain()
+    {
+        Light::retain();
+    }
+
+    static constexpr auto paramTable = sortParams({
+        GENERIC_PARAM(HDRILightParams,"radiance",ANARI_ARRAY2D,radiance),
+        GENERIC_PARAM(HDRILightParams,"up",ANARI_FLOAT32_VEC3,up),
+        GENERIC_PARAM(HDRILightParams,"direction",ANARI_FLOAT32_VEC3,direction),
+        GENERIC_PARAM(HDRILightParams,"scale",ANARI_FLOAT32,scale),
+    });
+    static_assert(uniqueParamHashes(paramTable));
+
+    void HDRILight::setParameter(const char* name,
+                                 ANARIDataType type,
+                                 const void* mem)
+    {
+        if (setParam(paramTable,static_cast<HDRILightParams&>(*this),name,type,mem))
+            return;
+
+        Light::setParameter(name,type,mem);
+    }
+
+    void HDRILight::unsetParameter(const char* name)
+    {
+        if (unsetParam(paramTable,static_cast<HDRILightParams&>(*this),name))
+            return;
+
+        Light::unsetParameter(name);
+    }
+
+} // generic
+
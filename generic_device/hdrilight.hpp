@@ -0,0 +1,36 @@
+#pragma once
+
+#include "light.hpp"
+
+namespace generic {
+
+    struct HDRILightParams
+    {
+        ANARIArray2D radiance = nullptr;
+        float up[3] = {0.f,0.f,1.f};
+        float direction[3] = {1.f,0.f,0.f};
+        float scale = 1.f;
+    };
+
+    // Environment light from an equirectangular radiance map
+    class HDRILight : public Light, public HDRILightParams
+    {
+    public:
+        HDRILight();
+       ~HDRILight();
+
+        void commit();
+
+        void release();
+
+        void retain();
+
+        void setParameter(const char* name,
+                          ANARIDataType type,
+                          const void* mem);
+
+        void unsetParameter(const char* name);
+    };
+
+} // generic
+
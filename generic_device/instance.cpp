@@ -3,6 +3,7 @@
 #include "backend.hpp"
 #include "instance.hpp"
 #include "logging.hpp"
+#include "param.hpp"
 
 namespace generic {
 
@@ -13,6 +14,7 @@ namespace generic {
 
     Instance::~Instance()
     {
+        ReleaseResource(group);
     }
 
     ResourceHandle Instance::getResourceHandle()
@@ -33,34 +35,29 @@ namespace generic {
     {
     }
 
+    static constexpr auto paramTable = sortParams({
+        GENERIC_PARAM(InstanceParams,"group",ANARI_GROUP,group),
+        GENERIC_PARAM(InstanceParams,"transform",ANARI_FLOAT32_MAT3x4,transform),
+    });
+    static_assert(uniqueParamHashes(paramTable));
+
     void Instance::setParameter(const char* name,
                                 ANARIDataType type,
                                 const void* mem)
     {
-        if (strncmp(name,"group",5)==0 && type==ANARI_GROUP) {
-            group = *(ANARIGroup*)mem; // TODO: reference count
-        } else if (strncmp(name,"transform",9)==0 && type==ANARI_FLOAT32_MAT3x4) {
-            memcpy(transform,mem,sizeof(transform));
-        } else {
-            LOG(logging::Level::Warning) << "Instance: Unsupported parameter "
-                << "/ parameter type: " << name << " / " << type;
-        }
+        if (setParam(paramTable,static_cast<InstanceParams&>(*this),name,type,mem))
+            return;
+
+        LOG(logging::Level::Warning) << "Instance: Unsupported parameter "
+            << "/ parameter type: " << name << " / " << type;
     }
 
     void Instance::unsetParameter(const char* name)
     {
-        if (strncmp(name,"group",5)==0) {
-            group = nullptr;
-        } else if (strncmp(name,"transform",9)==0) {
-            for (int i=0; i<3; ++i) {
-                for (int j=0; j<3; ++j) {
-                    transform[i][j] = (i==j) ? 1.f : 0.f;
-                }
-            }
-            transform[3][0] = transform[3][1] = transform[3][2] = 0.f;
-        } else {
-            LOG(logging::Level::Warning) << "Instance: Unsupported parameter " << name;
-        }
+        if (unsetParam(paramTable,static_cast<InstanceParams&>(*this),name))
+            return;
+
+        LOG(logging::Level::Warning) << "Instance: Unsupported parameter " << name;
     }
 
 } // generic
@@ -5,7 +5,13 @@
 
 namespace generic {
 
-    class Instance : public Object
+    struct InstanceParams
+    {
+        ANARIGroup group = nullptr;
+        float transform[4][3] = {{1.f,0.f,0.f},{0.f,1.f,0.f},{0.f,0.f,1.f},{0.f,0.f,0.f}};
+    };
+
+    class Instance : public Object, public InstanceParams
     {
     public:
         Instance();
@@ -25,9 +31,6 @@ namespace generic {
 
         void unsetParameter(const char* name);
 
-        ANARIGroup group = nullptr;
-        float transform[4][3] = {{1.f,0.f,0.f},{0.f,1.f,0.f},{0.f,0.f,1.f},{0.f,0.f,0.f}};
-
     private:
         ANARIInstance resourceHandle = nullptr;
     };
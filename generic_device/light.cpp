@@ -1,8 +1,11 @@
 #include <string.h>
 #include <type_traits>
 #include "backend.hpp"
+#include "directionallight.hpp"
+#include "hdrilight.hpp"
 #include "light.hpp"
 #include "logging.hpp"
+#include "param.hpp"
 #include "pointlight.hpp"
 #include "quadlight.hpp"
 
@@ -35,29 +38,29 @@ namespace generic {
     {
     }
 
+    static constexpr auto paramTable = sortParams({
+        GENERIC_PARAM(LightParams,"color",ANARI_FLOAT32_VEC3,color),
+        GENERIC_PARAM(LightParams,"visible",ANARI_BOOL,visible),
+    });
+    static_assert(uniqueParamHashes(paramTable));
+
     void Light::setParameter(const char* name,
                              ANARIDataType type,
                              const void* mem)
     {
-        if (strncmp(name,"color",5)==0 && type==ANARI_FLOAT32_VEC3) {
-            memcpy(color,mem,sizeof(color));
-        } else if (strncmp(name,"visible",7)==0 && type==ANARI_BOOL) {
-            memcpy(&visible,mem,sizeof(visible));
-        } else {
-            LOG(logging::Level::Warning) << "Light: Unsupported parameter "
-                << "/parameter type: " << name << " / " << type;
-        }
+        if (setParam(paramTable,static_cast<LightParams&>(*this),name,type,mem))
+            return;
+
+        LOG(logging::Level::Warning) << "Light: Unsupported parameter "
+            << "/parameter type: " << name << " / " << type;
     }
 
     void Light::unsetParameter(const char* name)
     {
-        if (strncmp(name,"color",5)==0) {
-            color[0] = color[1] = color[2] = 1.f;
-        } else if (strncmp(name,"visible",7)==0) {
-            visible = true;
-        } else {
-            LOG(logging::Level::Warning) << "Light: Unsupported parameter " << name;
-        }
+        if (unsetParam(paramTable,static_cast<LightParams&>(*this),name))
+            return;
+
+        LOG(logging::Level::Warning) << "Light: Unsupported parameter " << name;
     }
 
     std::unique_ptr<Light> createLight(const char* subtype)
@@ -66,6 +69,10 @@ namespace generic {
             return std::make_unique<PointLight>();
         else if (strncmp(subtype,"quad",4)==0)
             return std::make_unique<QuadLight>();
+        else if (strncmp(subtype,"directional",11)==0)
+            return std::make_unique<DirectionalLight>();
+        else if (strncmp(subtype,"hdri",4)==0)
+            return std::make_unique<HDRILight>();
         else {
             LOG(logging::Level::Error) << "Light subtype unavailable: " << subtype;
             return std::make_unique<Light>();
@@ -5,7 +5,13 @@
 
 namespace generic {
 
-    class Light : public Object
+    struct LightParams
+    {
+        float color[3] = {1.f,1.f,1.f};
+        int32_t visible = true;
+    };
+
+    class Light : public Object, public LightParams
     {
     public:
         Light();
@@ -27,9 +33,6 @@ namespace generic {
 
         virtual void unsetParameter(const char* name);
 
-        float color[3] = {1.f,1.f,1.f};
-        int32_t visible = true;
-
     private:
         ANARILight resourceHandle;
     };
@@ -1,6 +1,7 @@
 #include <string.h>
 #include "backend.hpp"
 #include "logging.hpp"
+#include "param.hpp"
 #include "matte.hpp"
 
 namespace generic {
@@ -27,25 +28,28 @@ namespace generic {
     {
     }
 
+    static constexpr auto paramTable = sortParams({
+        GENERIC_PARAM(MatteParams,"color",ANARI_FLOAT32_VEC3,color),
+    });
+    static_assert(uniqueParamHashes(paramTable));
+
     void Matte::setParameter(const char* name,
                              ANARIDataType type,
                              const void* mem)
     {
-        if (strncmp(name,"color",5)==0 && type==ANARI_FLOAT32_VEC3) {
-            memcpy(color,mem,sizeof(color));
-        } else {
-            LOG(logging::Level::Warning) << "matte: Unsupported parameter "
-                << "/ parameter type: " << name << " / " << type;
-        }
+        if (setParam(paramTable,static_cast<MatteParams&>(*this),name,type,mem))
+            return;
+
+        LOG(logging::Level::Warning) << "matte: Unsupported parameter "
+            << "/ parameter type: " << name << " / " << type;
     }
 
     void Matte::unsetParameter(const char* name)
     {
-        if (strncmp(name,"color",5)==0) {
-            color[0] = color[1] = color[2] = .8f;
-        } else {
-            LOG(logging::Level::Warning) << "matte: Unsupported parameter " << name;
-        }
+        if (unsetParam(paramTable,static_cast<MatteParams&>(*this),name))
+            return;
+
+        LOG(logging::Level::Warning) << "matte: Unsupported parameter " << name;
     }
 
 } // generic
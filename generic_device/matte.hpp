@@ -4,7 +4,12 @@
 
 namespace generic {
 
-    class Matte : public Material
+    struct MatteParams
+    {
+        float color[3] = {.8f,.8f,.8f};
+    };
+
+    class Matte : public Material, public MatteParams
     {
     public:
         Matte();
@@ -21,8 +26,6 @@ namespace generic {
                           const void* mem);
 
         void unsetParameter(const char* name);
-
-        float color[3] = {.8f,.8f,.8f};
     };
 
 } // generic
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <type_traits>
+#include <anari/anari.h>
+#include "resource.hpp"
+
+namespace generic {
+
+    // Parameter names are looked up by their FNV-1a hash first; paramIs()
+    // then rules out foreign names that just happen to hash to the same
+    // value as one of the object's parameters
+    constexpr uint32_t paramHash(const char* name, uint32_t h = 2166136261u)
+    {
+        return *name ? paramHash(name+1,(h^(uint8_t)*name)*16777619u) : h;
+    }
+
+    inline bool paramIs(const char* name, const char* expected)
+    {
+        return strcmp(name,expected)==0;
+    }
+
+    // How a parameter is stored: plain values are copied, object handles
+    // are reference counted, strings are copied into a fixed size buffer
+    enum class ParamKind { Value, Object, String, };
+
+    template <typename T>
+    constexpr ParamKind paramKind()
+    {
+        return std::is_pointer<T>::value ? ParamKind::Object
+             : std::is_same<std::remove_extent_t<T>,char>::value ? ParamKind::String
+             : ParamKind::Value;
+    }
+
+    // One entry of an object's parameter table; offsets are relative to the
+    // object's parameter struct, which must be standard layout
+    struct ParamDesc
+    {
+        uint32_t hash;
+        const char* name;
+        ANARIDataType type;
+        ParamKind kind;
+        size_t offset;
+        size_t size;
+        size_t flagOffset; // bool set on set and cleared on unset, or NoFlag
+
+        enum : size_t { NoFlag = ~size_t(0) };
+    };
+
+#define GENERIC_PARAM(P,name,type,member)                                 \
+    ::generic::ParamDesc{::generic::paramHash(name),name,type,            \
+                         ::generic::paramKind<decltype(P::member)>(),     \
+                         offsetof(P,member),sizeof(P::member),            \
+                         ::generic::ParamDesc::NoFlag}
+
+    // Same, but also records in member flag that the parameter was set
+#define GENERIC_PARAM_FLAG(P,name,type,member,flag)                       \
+    ::generic::ParamDesc{::generic::paramHash(name),name,type,            \
+                         ::generic::paramKind<decltype(P::member)>(),     \
+                         offsetof(P,member),sizeof(P::member),            \
+                         offsetof(P,flag)}
+
+    // An object's parameter table, sorted by hash at compile time so that
+    // lookups are a binary search
+    template <size_t N>
+    struct ParamTable
+    {
+        ParamDesc entries[N];
+
+        constexpr const ParamDesc* begin() const { return entries; }
+        constexpr const ParamDesc* end() const { return entries+N; }
+    };
+
+    template <size_t N>
+    constexpr ParamTable<N> sortParams(const ParamDesc (&table)[N])
+    {
+        ParamTable<N> result{};
+        for (size_t i=0; i<N; ++i) {
+            size_t j = i;
+            for (; j>0 && result.entries[j-1].hash > table[i].hash; --j) {
+                result.entries[j] = result.entries[j-1];
+            }
+            result.entries[j] = table[i];
+        }
+        return result;
+    }
+
+    // The binary search finds a single entry per hash, tables are checked
+    // with static_assert that no two of their names collide
+    template <size_t N>
+    constexpr bool uniqueParamHashes(const ParamTable<N>& table)
+    {
+        for (size_t i=1; i<N; ++i) {
+            if (table.entries[i-1].hash == table.entries[i].hash)
+                return false;
+        }
+        return true;
+    }
+
+    template <size_t N>
+    inline const ParamDesc* findParam(const ParamTable<N>& table, const char* name)
+    {
+        uint32_t hash = paramHash(name);
+        const ParamDesc* desc = std::lower_bound(table.begin(),table.end(),hash,
+                                                 [](const ParamDesc& d, uint32_t h) {
+                                                     return d.hash < h;
+                                                 });
+        if (desc != table.end() && desc->hash == hash && paramIs(name,desc->name))
+            return desc;
+        return nullptr;
+    }
+
+    // Set a parameter from the table; returns false if the object has no
+    // parameter of that name and type, so callers can defer to the base
+    // class or report it
+    template <typename P, size_t N>
+    bool setParam(const ParamTable<N>& table, P& params, const char* name,
+                  ANARIDataType type, const void* mem)
+    {
+        static_assert(std::is_standard_layout<P>::value,
+                      "Parameter structs must be standard layout");
+
+        const ParamDesc* desc = findParam(table,name);
+        if (desc == nullptr || desc->type != type)
+            return false;
+
+        uint8_t* dst = (uint8_t*)&params+desc->offset;
+
+        if (desc->kind == ParamKind::Object) {
+            ResourceHandle src, old;
+            memcpy(&src,mem,sizeof(src));
+            memcpy(&old,dst,sizeof(old));
+            AssignResource(old,src);
+            memcpy(dst,&old,sizeof(old));
+        } else if (desc->kind == ParamKind::String) {
+            strncpy((char*)dst,(const char*)mem,desc->size-1);
+            dst[desc->size-1] = '\0';
+        } else {
+            memcpy(dst,mem,desc->size);
+        }
+
+        if (desc->flagOffset != ParamDesc::NoFlag)
+            *((bool*)((uint8_t*)&params+desc->flagOffset)) = true;
+
+        return true;
+    }
+
+    // Reset a parameter to the default of the parameter struct
+    template <typename P, size_t N>
+    bool unsetParam(const ParamTable<N>& table, P& params, const char* name)
+    {
+        static const P defaults{};
+
+        const ParamDesc* desc = findParam(table,name);
+        if (desc == nullptr)
+            return false;
+
+        uint8_t* dst = (uint8_t*)&params+desc->offset;
+        const uint8_t* src = (const uint8_t*)&defaults+desc->offset;
+
+        if (desc->kind == ParamKind::Object) {
+            ResourceHandle old;
+            memcpy(&old,dst,sizeof(old));
+            AssignResource(old,nullptr);
+            memcpy(dst,&old,sizeof(old));
+        } else {
+            memcpy(dst,src,desc->size);
+        }
+
+        if (desc->flagOffset != ParamDesc::NoFlag)
+            *((bool*)((uint8_t*)&params+desc->flagOffset)) = false;
+
+        return true;
+    }
+
+} // generic
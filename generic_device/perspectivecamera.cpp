@@ -1,5 +1,6 @@
 #include <string.h>
 #include "backend.hpp"
+#include "param.hpp"
 #include "perspectivecamera.hpp"
 
 namespace generic {
@@ -29,28 +30,28 @@ namespace generic {
         Camera::retain();
     }
 
+    static constexpr auto paramTable = sortParams({
+        GENERIC_PARAM(PerspectiveCameraParams,"fovy",ANARI_FLOAT32,fovy),
+        GENERIC_PARAM(PerspectiveCameraParams,"aspect",ANARI_FLOAT32,aspect),
+    });
+    static_assert(uniqueParamHashes(paramTable));
+
     void PerspectiveCamera::setParameter(const char* name,
                                          ANARIDataType type,
                                          const void* mem)
     {
-        if (strncmp(name,"fovy",4)==0 && type==ANARI_FLOAT32) {
-            memcpy(&fovy,mem,sizeof(fovy));
-        } else if (strncmp(name,"aspect",6)==0 && type==ANARI_FLOAT32) {
-            memcpy(&aspect,mem,sizeof(aspect));
-        } else {
-            Camera::setParameter(name,type,mem);
-        }
+        if (setParam(paramTable,static_cast<PerspectiveCameraParams&>(*this),name,type,mem))
+            return;
+
+        Camera::setParameter(name,type,mem);
     }
 
     void PerspectiveCamera::unsetParameter(const char* name)
     {
-        if (strncmp(name,"fovy",4)==0) {
-            fovy = M_PI/3.f;
-        } else if (strncmp(name,"aspect",6)==0) {
-            aspect = 1.f;
-        } else {
-            Camera::unsetParameter(name);
-        }
+        if (unsetParam(paramTable,static_cast<PerspectiveCameraParams&>(*this),name))
+            return;
+
+        Camera::unsetParameter(name);
     }
 
 } // generic
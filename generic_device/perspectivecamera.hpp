@@ -5,7 +5,13 @@
 
 namespace generic {
 
-    class PerspectiveCamera : public Camera
+    struct PerspectiveCameraParams
+    {
+        float fovy = M_PI/3.f;
+        float aspect = 1.f;
+    };
+
+    class PerspectiveCamera : public Camera, public PerspectiveCameraParams
     {
     public:
         PerspectiveCamera();
@@ -22,9 +28,6 @@ namespace generic {
                           const void* mem);
 
         void unsetParameter(const char* name);
-
-        float fovy = M_PI/3.f;
-        float aspect = 1.f;
     };
 
 } // generic
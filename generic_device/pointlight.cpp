@@ -1,5 +1,6 @@
 #include <string.h>
 #include "backend.hpp"
+#include "param.hpp"
 #include "pointlight.hpp"
 
 namespace generic {
@@ -29,44 +30,31 @@ namespace generic {
         Light::retain();
     }
 
+    static constexpr auto paramTable = sortParams({
+        GENERIC_PARAM(PointLightParams,"position",ANARI_FLOAT32_VEC3,position),
+        GENERIC_PARAM_FLAG(PointLightParams,"intensity",ANARI_FLOAT32,intensity,intensityWasSet),
+        GENERIC_PARAM_FLAG(PointLightParams,"power",ANARI_FLOAT32,power,powerWasSet),
+        GENERIC_PARAM(PointLightParams,"radius",ANARI_FLOAT32,radius),
+        GENERIC_PARAM(PointLightParams,"radiance",ANARI_FLOAT32,radiance),
+    });
+    static_assert(uniqueParamHashes(paramTable));
+
     void PointLight::setParameter(const char* name,
                                   ANARIDataType type,
                                   const void* mem)
     {
-        if (strncmp(name,"position",8)==0 && type==ANARI_FLOAT32_VEC3) {
-            memcpy(position,mem,sizeof(position));
-        } else if (strncmp(name,"intensity",9)==0 && type==ANARI_FLOAT32) {
-            memcpy(&intensity,mem,sizeof(intensity));
-            intensityWasSet = true;
-        } else if (strncmp(name,"power",5)==0 && type==ANARI_FLOAT32) {
-            memcpy(&power,mem,sizeof(power));
-            powerWasSet = true;
-        } else if (strncmp(name,"radius",6)==0 && type==ANARI_FLOAT32) {
-            memcpy(&radius,mem,sizeof(radius));
-        } else if (strncmp(name,"radiance",8)==0 && type==ANARI_FLOAT32) {
-            memcpy(&radiance,mem,sizeof(radiance));
-        } else {
-            Light::setParameter(name,type,mem);
-        }
+        if (setParam(paramTable,static_cast<PointLightParams&>(*this),name,type,mem))
+            return;
+
+        Light::setParameter(name,type,mem);
     }
 
     void PointLight::unsetParameter(const char* name)
     {
-        if (strncmp(name,"position",8)==0) {
-            position[0] = position[1] = position[2] = 0.f;
-        } else if (strncmp(name,"intensity",9)==0) {
-            intensity = 1.f;
-            intensityWasSet = false;
-        } else if (strncmp(name,"power",5)==0) {
-            power = 1.f;
-            powerWasSet = false;
-        } else if (strncmp(name,"radius",6)==0) {
-            radius = 0.f;
-        } else if (strncmp(name,"radiance",8)==0) {
-            radiance = 1.f;
-        } else {
-            Light::unsetParameter(name);
-        }
+        if (unsetParam(paramTable,static_cast<PointLightParams&>(*this),name))
+            return;
+
+        Light::unsetParameter(name);
     }
 
 } // generic
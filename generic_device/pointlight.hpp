@@ -4,7 +4,20 @@
 
 namespace generic {
 
-    class PointLight : public Light
+    struct PointLightParams
+    {
+        float position[3] = {0.f,0.f,0.f};
+        float intensity = 1.f;
+        float power = 1.f;
+        float radius = 0.f;
+        float radiance = 1.f;
+        // intensity, if set, takes precedence over power
+        bool intensityWasSet = false;
+        // power, if set, takes precedence over radiance
+        bool powerWasSet = false;
+    };
+
+    class PointLight : public Light, public PointLightParams
     {
     public:
         PointLight();
@@ -21,16 +34,6 @@ namespace generic {
                           const void* mem);
 
         void unsetParameter(const char* name);
-
-        float position[3] = {0.f,0.f,0.f};
-        float intensity = 1.f;
-        float power = 1.f;
-        float radius = 0.f;
-        float radiance = 1.f;
-        // intensity, if set, takes precedence over power
-        bool intensityWasSet = false;
-        // power, if set, takes precedence over radiance
-        bool powerWasSet = false;
     };
 
 } // generic
@@ -4,7 +4,22 @@
 
 namespace generic {
 
-    class QuadLight : public Light
+    struct QuadLightParams
+    {
+        float position[3] = {0.f,0.f,0.f};
+        float edge1[3] = {1.f,0.f,0.f};
+        float edge2[3] = {0.f,1.f,0.f};
+        float intensity = 1.f;
+        float power = 1.f;
+        float radiance = 1.f;
+        char side[256] = "front";
+        // intensity, if set, takes precedence over power
+        bool intensityWasSet = false;
+        // power, if set, takes precedence over radiance
+        bool powerWasSet = false;
+    };
+
+    class QuadLight : public Light, public QuadLightParams
     {
     public:
         QuadLight();
@@ -21,18 +36,6 @@ namespace generic {
                           const void* mem);
 
         void unsetParameter(const char* name);
-
-        float position[3] = {0.f,0.f,0.f};
-        float edge1[3] = {1.f,0.f,0.f};
-        float edge2[3] = {0.f,1.f,0.f};
-        float intensity = 1.f;
-        float power = 1.f;
-        float radiance = 1.f;
-        char side[256] = "front";
-        // intensity, if set, takes precedence over power
-        bool intensityWasSet = false;
-        // power, if set, takes precedence over radiance
-        bool powerWasSet = false;
     };
 
 } // generic
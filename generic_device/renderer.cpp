@@ -3,6 +3,7 @@
 #include "ao.hpp"
 #include "backend.hpp"
 #include "logging.hpp"
+#include "param.hpp"
 #include "renderer.hpp"
 #include "pathtracer.hpp"
 
@@ -40,25 +41,28 @@ namespace generic {
     {
     }
 
+    static constexpr auto paramTable = sortParams({
+        GENERIC_PARAM(RendererParams,"backgroundColor",ANARI_FLOAT32_VEC4,backgroundColor),
+    });
+    static_assert(uniqueParamHashes(paramTable));
+
     void Renderer::setParameter(const char* name,
                                 ANARIDataType type,
                                 const void* mem)
     {
-        if (strncmp(name,"backgroundColor",15)==0 && type==ANARI_FLOAT32_VEC4) {
-            memcpy(backgroundColor,mem,sizeof(backgroundColor));
-        } else {
-            LOG(logging::Level::Warning) << "Renderer: Unsupported parameter "
-                << "/parameter type: " << name << " / " << type;
-        }
+        if (setParam(paramTable,static_cast<RendererParams&>(*this),name,type,mem))
+            return;
+
+        LOG(logging::Level::Warning) << "Renderer: Unsupported parameter "
+            << "/parameter type: " << name << " / " << type;
     }
 
     void Renderer::unsetParameter(const char* name)
     {
-        if (strncmp(name,"backgroundColor",15)==0) {
-            backgroundColor[0] = backgroundColor[1] = backgroundColor[2] = backgroundColor[3] = 0.f;
-        } else {
-            LOG(logging::Level::Warning) << "Renderer: Unsupported parameter " << name;
-        }
+        if (unsetParam(paramTable,static_cast<RendererParams&>(*this),name))
+            return;
+
+        LOG(logging::Level::Warning) << "Renderer: Unsupported parameter " << name;
     }
 
     std::unique_ptr<Renderer> createRenderer(const char* subtype)
@@ -6,7 +6,12 @@
 
 namespace generic {
 
-    class Renderer : public Object
+    struct RendererParams
+    {
+        float backgroundColor[4] = {0.f,0.f,0.f,0.f};
+    };
+
+    class Renderer : public Object, public RendererParams
     {
     public:
         Renderer();
@@ -28,8 +33,6 @@ namespace generic {
 
         virtual void unsetParameter(const char* name);
 
-        float backgroundColor[4] = {0.f,0.f,0.f,0.f};
-
         constexpr static const char* Subtypes[3] = {
             "pathtracer", // 1st one is chosen by "default" 
             "ao",
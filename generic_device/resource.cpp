@@ -1,28 +1,103 @@
 #include <assert.h>
+#include <stdint.h>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 #include <utility>
+#include "backend.hpp"
 #include "resource.hpp"
 
 namespace generic {
 
-    static std::unordered_map<ResourceHandle,std::unique_ptr<Resource>> resources;
+    // Handles are created and looked up from every API entry point, possibly
+    // from several application threads at once. Split the registry into
+    // shards with their own lock so that lookups (by far the most frequent
+    // operation) only take a shared lock and rarely contend with creation
+    struct ResourceShard
+    {
+        std::shared_mutex mtx;
+        std::unordered_map<ResourceHandle,std::unique_ptr<Resource>> resources;
+    };
+
+    enum { NumShards = 64 };
+
+    static ResourceShard shards[NumShards];
+
+    static std::atomic<size_t> numResources{0};
+
+    static ResourceShard& shardOf(ResourceHandle handle)
+    {
+        // Handles are heap pointers, the lowest bits are always zero
+        uintptr_t h = (uintptr_t)handle >> 4;
+        h ^= h >> 7;
+        return shards[h % NumShards];
+    }
 
     ResourceHandle RegisterResource(std::unique_ptr<Resource> res)
     {
         ResourceHandle handle = res->getResourceHandle();
-        auto it = resources.insert({handle,std::move(res)});
+        ResourceShard& shard = shardOf(handle);
+        std::unique_lock<std::shared_mutex> l(shard.mtx);
+        auto it = shard.resources.insert({handle,std::move(res)});
+        ++numResources;
         return handle;
     }
 
     Resource* GetResource(ResourceHandle handle)
     {
-        auto it = resources.find(handle);
-        if (it == resources.end())
+        ResourceShard& shard = shardOf(handle);
+        std::shared_lock<std::shared_mutex> l(shard.mtx);
+        auto it = shard.resources.find(handle);
+        if (it == shard.resources.end())
             return nullptr;
 
         return it->second.get();
     }
-} // generic
 
+    void RetainResource(ResourceHandle handle)
+    {
+        if (handle == nullptr)
+            return;
+
+        Resource* res = GetResource(handle);
+        if (res != nullptr)
+            ++res->refCount;
+    }
+
+    void ReleaseResource(ResourceHandle handle)
+    {
+        if (handle == nullptr)
+            return;
+
+        Resource* res = GetResource(handle);
+        if (res != nullptr && --res->refCount == 0)
+            backend::release(handle);
+    }
+
+    void DestroyResource(ResourceHandle handle)
+    {
+        std::unique_ptr<Resource> res;
+
+        {
+            ResourceShard& shard = shardOf(handle);
+            std::unique_lock<std::shared_mutex> l(shard.mtx);
+            auto it = shard.resources.find(handle);
+            if (it == shard.resources.end())
+                return;
 
+            res = std::move(it->second);
+            shard.resources.erase(it);
+            --numResources;
+        }
+
+        // Destroy outside the lock, the destructor releases the
+        // resources this one references, which may live in the same shard
+        res.reset();
+    }
+
+    size_t GetNumResources()
+    {
+        return numResources;
+    }
+} // generic
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <stddef.h>
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 
 namespace generic {
 
@@ -15,11 +19,38 @@ namespace generic {
         virtual void release() = 0;
 
         virtual void retain() = 0;
+
+        // One reference is owned by the application, one more by every
+        // object or array holding this resource as a parameter
+        std::atomic<uint32_t> refCount{1};
+
+        // Serializes parameter changes with commits, which snapshot the
+        // parameters; applications may use one object from several threads
+        std::mutex paramMutex;
     };
 
     ResourceHandle RegisterResource(std::unique_ptr<Resource> res);
     Resource* GetResource(ResourceHandle handle);
 
-} // generic
+    // Reference counting; when the last reference is released, reclamation
+    // of the resource and of its backend counterpart is deferred to the
+    // next commit flush, so that pending commits never see dangling objects
+    void RetainResource(ResourceHandle handle);
+    void ReleaseResource(ResourceHandle handle);
 
+    // Remove a resource from the registry and delete it
+    void DestroyResource(ResourceHandle handle);
 
+    size_t GetNumResources();
+
+    // Replace a resource held as a parameter, retaining the new and
+    // releasing the old one
+    template <typename Handle, typename Value>
+    void AssignResource(Handle& dst, Value src)
+    {
+        RetainResource(src);
+        ReleaseResource(dst);
+        dst = src;
+    }
+
+} // generic
@@ -0,0 +1,114 @@
+#include <string.h>
+#include "array.hpp"
+#include "backend.hpp"
+#include "logging.hpp"
+#include "param.hpp"
+#include "sparseregular.hpp"
+
+namespace generic {
+
+    SparseRegular::SparseRegular()
+        : SpatialField()
+    {
+    }
+
+    SparseRegular::~SparseRegular()
+    {
+        ReleaseResource(data);
+        ReleaseResource(brickIndex);
+        ReleaseResource(brickData);
+    }
+
+    void SparseRegular::commit()
+    {
+        if (strcmp(filter,"linear")!=0 && strcmp(filter,"nearest")!=0) {
+            LOG(logging::Level::Warning) << "SpatialField.SparseRegular: "
+                << "unsupported filter \"" << filter << "\", using linear";
+            strncpy(filter,"linear",sizeof(filter)-1);
+        }
+
+        if (brickIndex != nullptr || brickData != nullptr) {
+            if (brickIndex == nullptr || brickData == nullptr) {
+                LOG(logging::Level::Error) << "SpatialField.SparseRegular error: "
+                    << "brickIndex and brickData must be set together";
+                return;
+            }
+
+            Array3D* index = (Array3D*)GetResource(brickIndex);
+            Array1D* bricks = (Array1D*)GetResource(brickData);
+
+            if (!index->convertibleTo(ANARI_INT32) || !bricks->convertibleTo(ANARI_FLOAT32)) {
+                LOG(logging::Level::Error) << "SpatialField.SparseRegular error: "
+                    << "unsupported brickIndex or brickData element type";
+                return;
+            }
+
+            const size_t voxelsPerBrick = BrickSize*BrickSize*BrickSize;
+            if (bricks->numItems[0]%voxelsPerBrick != 0) {
+                LOG(logging::Level::Error) << "SpatialField.SparseRegular error: "
+                    << "brickData size is not a multiple of " << voxelsPerBrick;
+                return;
+            }
+
+            for (int i=0; i<3; ++i) {
+                if (dimensions[i] > index->numItems[i]*BrickSize) {
+                    LOG(logging::Level::Error) << "SpatialField.SparseRegular error: "
+                        << "dimensions exceed the bricks in brickIndex";
+                    return;
+                }
+            }
+        } else if (data == nullptr) {
+            LOG(logging::Level::Error) << "SpatialField.SparseRegular error: "
+                << "neither data nor brickIndex/brickData set";
+            return;
+        } else {
+            Array3D* d = (Array3D*)GetResource(data);
+            if (!d->convertibleTo(ANARI_FLOAT32)) {
+                LOG(logging::Level::Error) << "SpatialField.SparseRegular error: "
+                    << "unsupported data element type";
+                return;
+            }
+        }
+
+        backend::commit(*this);
+    }
+
+    void SparseRegular::release()
+    {
+    }
+
+    void SparseRegular::retain()
+    {
+    }
+
+    static constexpr auto paramTable = sortParams({
+        GENERIC_PARAM(SparseRegularParams,"data",ANARI_ARRAY3D,data),
+        GENERIC_PARAM(SparseRegularParams,"brickIndex",ANARI_ARRAY3D,brickIndex),
+        GENERIC_PARAM(SparseRegularParams,"brickData",ANARI_ARRAY1D,brickData),
+        GENERIC_PARAM(SparseRegularParams,"dimensions",ANARI_UINT32_VEC3,dimensions),
+        GENERIC_PARAM(SparseRegularParams,"emptyValue",ANARI_FLOAT32,emptyValue),
+        GENERIC_PARAM(SparseRegularParams,"filter",ANARI_STRING,filter),
+    });
+    static_assert(uniqueParamHashes(paramTable));
+
+    void SparseRegular::setParameter(const char* name,
+                                     ANARIDataType type,
+                                     const void* mem)
+    {
+        if (setParam(paramTable,static_cast<SparseRegularParams&>(*this),name,type,mem))
+            return;
+
+        LOG(logging::Level::Warning) << "SparseRegular: Unsupported parameter "
+            << "/ parameter type: " << name << " / " << type;
+    }
+
+    void SparseRegular::unsetParameter(const char* name)
+    {
+        if (unsetParam(paramTable,static_cast<SparseRegularParams&>(*this),name))
+            return;
+
+        LOG(logging::Level::Warning) << "SparseRegular: Unsupported parameter " << name;
+    }
+
+} // generic
+
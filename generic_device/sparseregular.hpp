@@ -0,0 +1,44 @@
+#pragma once
+
+#include "spatialfield.hpp"
+
+namespace generic {
+
+    struct SparseRegularParams
+    {
+        ANARIArray3D data = nullptr;
+        ANARIArray3D brickIndex = nullptr;
+        ANARIArray1D brickData = nullptr;
+        uint32_t dimensions[3] = {0,0,0}; // bricked input only, 0: brickIndex*BrickSize
+        float emptyValue = 0.f;
+        char filter[16] = "linear"; // "linear" or "nearest"
+    };
+
+    // Regular grid that is stored sparsely by the backend. Input is
+    // either dense (data), which is split into bricks, dropping bricks
+    // whose voxels all equal emptyValue, or already bricked: brickIndex
+    // holds one INT32 per brick (-1 if empty) into brickData, which
+    // stores BrickSize^3 FLOAT32 voxels per brick, x fastest
+    class SparseRegular : public SpatialField, public SparseRegularParams
+    {
+    public:
+        SparseRegular();
+       ~SparseRegular();
+
+        void commit();
+
+        void release();
+
+        void retain();
+
+        void setParameter(const char* name,
+                          ANARIDataType type,
+                          const void* mem);
+
+        void unsetParameter(const char* name);
+
+        enum { BrickSize = 8 };
+    };
+
+} // generic
+
@@ -1,8 +1,11 @@
 #include <string.h>
 #include <type_traits>
+#include "amrfield.hpp"
 #include "logging.hpp"
+#include "sparseregular.hpp"
 #include "spatialfield.hpp"
 #include "structuredregular.hpp"
+#include "unstructuredfield.hpp"
 
 namespace generic {
 
@@ -53,6 +56,12 @@ namespace generic {
     {
         if (strncmp(subtype,"structuredRegular",17)==0)
             return std::make_unique<StructuredRegular>();
+        else if (strncmp(subtype,"amr",3)==0)
+            return std::make_unique<AMRField>();
+        else if (strncmp(subtype,"sparseRegular",13)==0)
+            return std::make_unique<SparseRegular>();
+        else if (strncmp(subtype,"unstructured",12)==0)
+            return std::make_unique<UnstructuredField>();
         else {
             LOG(logging::Level::Error) << "SpatialField subtype unavailable: " << subtype;
             return std::make_unique<SpatialField>();
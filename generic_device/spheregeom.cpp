@@ -0,0 +1,97 @@
+#include <string.h>
+#include "array.hpp"
+#include "backend.hpp"
+#include "logging.hpp"
+#include "param.hpp"
+#include "spheregeom.hpp"
+
+namespace generic {
+
+    SphereGeom::SphereGeom()
+    {
+    }
+
+    SphereGeom::~SphereGeom()
+    {
+        ReleaseResource(vertex_position);
+        ReleaseResource(vertex_radius);
+        ReleaseResource(vertex_color);
+        ReleaseResource(vertex_attribute0);
+        ReleaseResource(vertex_attribute1);
+        ReleaseResource(vertex_attribute2);
+        ReleaseResource(vertex_attribute3);
+        ReleaseResource(primitive_index);
+    }
+
+    void SphereGeom::commit()
+    {
+        if (vertex_position == nullptr) {
+            LOG(logging::Level::Error) << "Sphere error: vertex.position not set but "
+                << "is a required parameter";
+            return;
+        }
+
+        // Other element types are converted on commit
+        Array1D* position = (Array1D*)GetResource(vertex_position);
+        Array1D* radius = (Array1D*)GetResource(vertex_radius);
+        Array1D* index = (Array1D*)GetResource(primitive_index);
+        if (!position->convertibleTo(ANARI_FLOAT32_VEC3)
+         || (radius != nullptr && !radius->convertibleTo(ANARI_FLOAT32))
+         || (index != nullptr && !index->convertibleTo(ANARI_UINT32))) {
+            LOG(logging::Level::Error) << "Sphere error: unsupported vertex.position, "
+                << "vertex.radius or primitive.index element type";
+            return;
+        }
+
+        if (radius != nullptr && radius->numItems[0] < position->numItems[0]) {
+            LOG(logging::Level::Error) << "Sphere error: vertex.radius has fewer "
+                << "elements than vertex.position";
+            return;
+        }
+
+        backend::commit(*this);
+    }
+
+    void SphereGeom::release()
+    {
+    }
+
+    void SphereGeom::retain()
+    {
+    }
+
+    static constexpr auto paramTable = sortParams({
+        GENERIC_PARAM(SphereGeomParams,"vertex.position",ANARI_ARRAY1D,vertex_position),
+        GENERIC_PARAM(SphereGeomParams,"vertex.radius",ANARI_ARRAY1D,vertex_radius),
+        GENERIC_PARAM(SphereGeomParams,"vertex.color",ANARI_ARRAY1D,vertex_color),
+        GENERIC_PARAM(SphereGeomParams,"vertex.attribute0",ANARI_ARRAY1D,vertex_attribute0),
+        GENERIC_PARAM(SphereGeomParams,"vertex.attribute1",ANARI_ARRAY1D,vertex_attribute1),
+        GENERIC_PARAM(SphereGeomParams,"vertex.attribute2",ANARI_ARRAY1D,vertex_attribute2),
+        GENERIC_PARAM(SphereGeomParams,"vertex.attribute3",ANARI_ARRAY1D,vertex_attribute3),
+        GENERIC_PARAM(SphereGeomParams,"primitive.index",ANARI_ARRAY1D,primitive_index),
+        GENERIC_PARAM(SphereGeomParams,"radius",ANARI_FLOAT32,radius),
+    });
+    static_assert(uniqueParamHashes(paramTable));
+
+    void SphereGeom::setParameter(const char* name,
+                                  ANARIDataType type,
+                                  const void* mem)
+    {
+        if (setParam(paramTable,static_cast<SphereGeomParams&>(*this),name,type,mem))
+            return;
+
+        LOG(logging::Level::Warning) << "Sphere: Unsupported parameter "
+            << "/ parameter type: " << name << " / " << type;
+    }
+
+    void SphereGeom::unsetParameter(const char* name)
+    {
+        if (unsetParam(paramTable,static_cast<SphereGeomParams&>(*this),name))
+            return;
+
+        LOG(logging::Level::Warning) << "Sphere: Unsupported parameter " << name;
+    }
+
+} // generic
+
+
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "geometry.hpp"
+
+namespace generic {
+
+    struct SphereGeomParams
+    {
+        ANARIArray1D vertex_position = nullptr;
+        ANARIArray1D vertex_radius = nullptr;
+        ANARIArray1D vertex_color = nullptr;
+        ANARIArray1D vertex_attribute0 = nullptr;
+        ANARIArray1D vertex_attribute1 = nullptr;
+        ANARIArray1D vertex_attribute2 = nullptr;
+        ANARIArray1D vertex_attribute3 = nullptr;
+        ANARIArray1D primitive_index = nullptr;
+        float radius = .01f;
+    };
+
+    class SphereGeom : public Geometry, public SphereGeomParams
+    {
+    public:
+        SphereGeom();
+       ~SphereGeom();
+
+        void commit();
+
+        void release();
+
+        void retain();
+
+        void setParameter(const char* name,
+                          ANARIDataType type,
+                          const void* mem);
+
+        void unsetParameter(const char* name);
+    };
+
+} // generic
+
+
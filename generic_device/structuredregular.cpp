@@ -2,6 +2,7 @@
 #include "array.hpp"
 #include "backend.hpp"
 #include "logging.hpp"
+#include "param.hpp"
 #include "structuredregular.hpp"
 
 namespace generic {
@@ -13,15 +14,25 @@ namespace generic {
 
     StructuredRegular::~StructuredRegular()
     {
+        ReleaseResource(data);
     }
 
     void StructuredRegular::commit()
     {
-        if (data == nullptr)
+        if (data == nullptr) {
             LOG(logging::Level::Error) << "SpatialField.StructuredRegular error: "
                 << "data not set but is a required parameter";
-        else
-            backend::commit(*this);
+            return;
+        }
+
+        Array3D* d = (Array3D*)GetResource(data);
+        if (!d->convertibleTo(ANARI_FLOAT32)) {
+            LOG(logging::Level::Error) << "SpatialField.StructuredRegular error: "
+                << "unsupported data element type";
+            return;
+        }
+
+        backend::commit(*this);
     }
 
     void StructuredRegular::release()
@@ -32,29 +43,29 @@ namespace generic {
     {
     }
 
+    static constexpr auto paramTable = sortParams({
+        GENERIC_PARAM(StructuredRegularParams,"data",ANARI_ARRAY3D,data),
+        GENERIC_PARAM(StructuredRegularParams,"filter",ANARI_STRING,filter),
+    });
+    static_assert(uniqueParamHashes(paramTable));
+
     void StructuredRegular::setParameter(const char* name,
                                          ANARIDataType type,
                                          const void* mem)
     {
-        if (strncmp(name,"data",4)==0 && type==ANARI_ARRAY3D) {
-            data = *(ANARIArray3D*)mem;
-        } else if (strncmp(name,"filter",6)==0 && type==ANARI_STRING) {
-            filter = (const char*)mem;
-        } else {
-            LOG(logging::Level::Warning) << "StructuredRegular: Unsupported parameter "
-                << "/ parameter type: " << name << " / " << type;
-        }
+        if (setParam(paramTable,static_cast<StructuredRegularParams&>(*this),name,type,mem))
+            return;
+
+        LOG(logging::Level::Warning) << "StructuredRegular: Unsupported parameter "
+            << "/ parameter type: " << name << " / " << type;
     }
 
     void StructuredRegular::unsetParameter(const char* name)
     {
-        if (strncmp(name,"data",4)==0) {
-            data = nullptr;
-        } else if (strncmp(name,"filter",6)==0) {
-            filter = "linear";
-        } else {
-            LOG(logging::Level::Warning) << "StructuredRegular: Unsupported parameter " << name;
-        }
+        if (unsetParam(paramTable,static_cast<StructuredRegularParams&>(*this),name))
+            return;
+
+        LOG(logging::Level::Warning) << "StructuredRegular: Unsupported parameter " << name;
     }
 
 } // generic
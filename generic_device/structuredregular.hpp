@@ -4,7 +4,13 @@
 
 namespace generic {
 
-    class StructuredRegular : public SpatialField
+    struct StructuredRegularParams
+    {
+        ANARIArray3D data = nullptr;
+        char filter[16] = "linear";
+    };
+
+    class StructuredRegular : public SpatialField, public StructuredRegularParams
     {
     public:
         StructuredRegular();
@@ -22,11 +28,8 @@ namespace generic {
 
         void unsetParameter(const char* name);
 
-        ANARIArray3D data = nullptr;
         float origin[3] = {0,0,0};
         float spacing[3] = {1,1,1};
-        const char* filter = "linear";
-
     };
 
 } // generic
@@ -2,6 +2,7 @@
 #include <type_traits>
 #include "backend.hpp"
 #include "logging.hpp"
+#include "param.hpp"
 #include "surface.hpp"
 
 namespace generic {
@@ -13,6 +14,8 @@ namespace generic {
 
     Surface::~Surface()
     {
+        ReleaseResource(geometry);
+        ReleaseResource(material);
     }
 
     ResourceHandle Surface::getResourceHandle()
@@ -37,29 +40,29 @@ namespace generic {
     {
     }
 
+    static constexpr auto paramTable = sortParams({
+        GENERIC_PARAM(SurfaceParams,"geometry",ANARI_GEOMETRY,geometry),
+        GENERIC_PARAM(SurfaceParams,"material",ANARI_MATERIAL,material),
+    });
+    static_assert(uniqueParamHashes(paramTable));
+
     void Surface::setParameter(const char* name,
                                ANARIDataType type,
                                const void* mem)
     {
-        if (strncmp(name,"geometry",8)==0 && type==ANARI_GEOMETRY) {
-            geometry = *(ANARIGeometry*)mem; // TODO: reference count
-        } else if (strncmp(name,"material",8)==0 && type==ANARI_MATERIAL) {
-            material = *(ANARIMaterial*)mem; // TODO: reference count
-        } else {
-            LOG(logging::Level::Warning) << "Surface: Unsupported parameter "
-                << "/ parameter type: " << name << " / " << type;
-        }
+        if (setParam(paramTable,static_cast<SurfaceParams&>(*this),name,type,mem))
+            return;
+
+        LOG(logging::Level::Warning) << "Surface: Unsupported parameter "
+            << "/ parameter type: " << name << " / " << type;
     }
 
     void Surface::unsetParameter(const char* name)
     {
-        if (strncmp(name,"geometry",8)==0) {
-            geometry = nullptr;
-        } else if (strncmp(name,"material",8)==0) {
-            material = nullptr;
-        } else {
-            LOG(logging::Level::Warning) << "Surface: Unsupported parameter " << name;
-        }
+        if (unsetParam(paramTable,static_cast<SurfaceParams&>(*this),name))
+            return;
+
+        LOG(logging::Level::Warning) << "Surface: Unsupported parameter " << name;
     }
 
 } // generic
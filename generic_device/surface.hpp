@@ -5,7 +5,13 @@
 
 namespace generic {
 
-    class Surface : public Object
+    struct SurfaceParams
+    {
+        ANARIGeometry geometry = nullptr;
+        ANARIMaterial material = nullptr;
+    };
+
+    class Surface : public Object, public SurfaceParams
     {
     public:
         Surface();
@@ -25,9 +31,6 @@ namespace generic {
 
         void unsetParameter(const char* name);
 
-        ANARIGeometry geometry = nullptr;
-        ANARIMaterial material = nullptr;
-
     private:
         ANARISurface resourceHandle = nullptr;
     };
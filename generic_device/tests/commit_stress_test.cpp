@@ -0,0 +1,174 @@
+// Creates, commits and releases objects from several threads at once while
+// the main thread keeps rendering, so that commits are flushed concurrently
+// with parameters being changed. Fails on errors reported by the device;
+// crashes and hangs are the other things this is meant to catch.
+//
+// Usage: commit_stress_test [threads] [iterations]
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <anari/anari.h>
+
+static std::atomic<unsigned> errors{0};
+
+static void statusFunc(const void* userData,
+    ANARIDevice device,
+    ANARIObject source,
+    ANARIDataType sourceType,
+    ANARIStatusSeverity severity,
+    ANARIStatusCode code,
+    const char* message)
+{
+    if (severity <= ANARI_SEVERITY_ERROR)
+        errors++;
+
+    if (severity <= ANARI_SEVERITY_WARNING)
+        fprintf(stderr, "%s\n", message);
+}
+
+// Shared by all threads, outlives the arrays referencing it
+static const float vertices[] = {
+    0.f,0.f,0.f,
+    1.f,0.f,0.f,
+    1.f,1.f,0.f,
+};
+
+static void worker(ANARIDevice device, ANARIWorld world, size_t iterations, unsigned seed)
+{
+    for (size_t i=0; i<iterations; ++i) {
+        ANARIGeometry geom = anariNewGeometry(device,"triangle");
+        ANARIArray1D position = anariNewArray1D(device,vertices,nullptr,nullptr,
+                                                ANARI_FLOAT32_VEC3,3,0);
+        anariSetParameter(device,geom,"vertex.position",ANARI_ARRAY1D,&position);
+        anariCommitParameters(device,geom);
+
+        ANARIMaterial mat = anariNewMaterial(device,"matte");
+        float color[3] = {(seed%3)/2.f,(i%5)/4.f,.5f};
+        anariSetParameter(device,mat,"color",ANARI_FLOAT32_VEC3,color);
+        anariCommitParameters(device,mat);
+
+        ANARISurface surf = anariNewSurface(device);
+        anariSetParameter(device,surf,"geometry",ANARI_GEOMETRY,&geom);
+        anariSetParameter(device,surf,"material",ANARI_MATERIAL,&mat);
+        anariCommitParameters(device,surf);
+
+        // Change parameters right after committing, the flush must still
+        // see the values from the time of the commit
+        color[0] = 1.f-color[0];
+        anariSetParameter(device,mat,"color",ANARI_FLOAT32_VEC3,color);
+        anariUnsetParameter(device,surf,"material");
+
+        ANARILight light = anariNewLight(device,"directional");
+        float direction[3] = {0.f,-1.f,float(i%2)};
+        anariSetParameter(device,light,"direction",ANARI_FLOAT32_VEC3,direction);
+        anariCommitParameters(device,light);
+
+        ANARICamera camera = anariNewCamera(device,"perspective");
+        float aspect = 1.f+(i%4);
+        anariSetParameter(device,camera,"aspect",ANARI_FLOAT32,&aspect);
+        anariCommitParameters(device,camera);
+
+        // Every now and then, replace the world's surfaces; all threads
+        // share the world, so this also races setting against committing
+        if (i%16 == seed%16) {
+            ANARIArray1D surfaces = anariNewArray1D(device,&surf,nullptr,nullptr,
+                                                    ANARI_SURFACE,1,0);
+            anariSetParameter(device,world,"surface",ANARI_ARRAY1D,&surfaces);
+            anariCommitParameters(device,world);
+            anariRelease(device,surfaces);
+        }
+
+        anariRelease(device,camera);
+        anariRelease(device,light);
+        anariRelease(device,surf);
+        anariRelease(device,mat);
+        anariRelease(device,position);
+        anariRelease(device,geom);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned numThreads = argc > 1 ? (unsigned)strtoul(argv[1],nullptr,10) : 8;
+    size_t iterations = argc > 2 ? strtoull(argv[2],nullptr,10) : 200;
+
+    ANARILibrary library = anariLoadLibrary("generic", statusFunc);
+    if (library == nullptr) {
+        fprintf(stderr, "Error loading the generic ANARI library\n");
+        return EXIT_FAILURE;
+    }
+
+    ANARIDevice device = anariNewDevice(library,"default");
+    anariCommitParameters(device,device);
+
+    ANARIWorld world = anariNewWorld(device);
+    anariCommitParameters(device,world);
+
+    ANARICamera camera = anariNewCamera(device,"perspective");
+    float position[3] = {.5f,.5f,2.f};
+    float direction[3] = {0.f,0.f,-1.f};
+    anariSetParameter(device,camera,"position",ANARI_FLOAT32_VEC3,position);
+    anariSetParameter(device,camera,"direction",ANARI_FLOAT32_VEC3,direction);
+    anariCommitParameters(device,camera);
+
+    ANARIRenderer renderer = anariNewRenderer(device,"default");
+    anariCommitParameters(device,renderer);
+
+    ANARIFrame frame = anariNewFrame(device);
+    uint32_t size[2] = {64,64};
+    ANARIDataType channelType = ANARI_UFIXED8_RGBA_SRGB;
+    anariSetParameter(device,frame,"size",ANARI_UINT32_VEC2,size);
+    anariSetParameter(device,frame,"channel.color",ANARI_DATA_TYPE,&channelType);
+    anariSetParameter(device,frame,"world",ANARI_WORLD,&world);
+    anariSetParameter(device,frame,"camera",ANARI_CAMERA,&camera);
+    anariSetParameter(device,frame,"renderer",ANARI_RENDERER,&renderer);
+    anariCommitParameters(device,frame);
+
+    std::atomic<bool> done{false};
+    std::vector<std::thread> threads;
+    for (unsigned t=0; t<numThreads; ++t) {
+        threads.emplace_back([=]() {
+            worker(device,world,iterations,t);
+        });
+    }
+
+    // Render while the workers commit; each frame flushes the commit buffer
+    std::thread waiter([&]() {
+        for (std::thread& t : threads) {
+            t.join();
+        }
+        done = true;
+    });
+
+    size_t frames = 0;
+    while (!done) {
+        anariRenderFrame(device,frame);
+        anariFrameReady(device,frame,ANARI_WAIT);
+        uint32_t width, height;
+        ANARIDataType type;
+        anariMapFrame(device,frame,"channel.color",&width,&height,&type);
+        anariUnmapFrame(device,frame,"channel.color");
+        ++frames;
+    }
+
+    waiter.join();
+
+    // Flush what was committed after the last frame
+    anariRenderFrame(device,frame);
+    anariFrameReady(device,frame,ANARI_WAIT);
+
+    printf("%u threads x %zu iterations, %zu frames, %u errors\n",
+           numThreads, iterations, frames, errors.load());
+
+    anariRelease(device,frame);
+    anariRelease(device,renderer);
+    anariRelease(device,camera);
+    anariRelease(device,world);
+    anariRelease(device,device);
+    anariUnloadLibrary(library);
+
+    return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,173 @@
+// Memory and speed of the compact triangle mode: builds an indexed, bumpy
+// grid mesh and renders it with "compact" off and on, each with binary and
+// with wide BVHs. Reports the bytes the device allocated for the geometry
+// (BVHs, including the framebuffer), the time of the first frame (BVH
+// builds included) and the average time of the following frames.
+//
+// Usage: compact_mesh_bench [triangles] [frames]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <anari/anari.h>
+
+static void statusFunc(const void* userData,
+    ANARIDevice device,
+    ANARIObject source,
+    ANARIDataType sourceType,
+    ANARIStatusSeverity severity,
+    ANARIStatusCode code,
+    const char* message)
+{
+    if (severity <= ANARI_SEVERITY_WARNING)
+        fprintf(stderr, "%s\n", message);
+}
+
+static uint64_t liveBytes(ANARIDevice device)
+{
+    uint64_t bytes = 0;
+    anariGetProperty(device,device,"liveBytes",ANARI_UINT64,&bytes,sizeof(bytes),ANARI_WAIT);
+    return bytes;
+}
+
+// The mesh outlives all arrays; a deleter that does nothing lets the
+// device use it in place rather than copy it on release
+static void keepBuffer(const void* userPtr, const void* appMemory)
+{
+}
+
+static double renderFrame(ANARIDevice device, ANARIFrame frame)
+{
+    auto start = std::chrono::steady_clock::now();
+    anariRenderFrame(device,frame);
+    anariFrameReady(device,frame,ANARI_WAIT);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end-start).count();
+}
+
+int main(int argc, char** argv)
+{
+    size_t numTriangles = argc > 1 ? strtoull(argv[1],nullptr,10) : 4000000;
+    int numFrames = argc > 2 ? atoi(argv[2]) : 10;
+
+    // n x n quads, two triangles each
+    unsigned n = (unsigned)std::ceil(std::sqrt(numTriangles/2.0));
+    numTriangles = size_t(n)*n*2;
+
+    std::vector<float> vertices;
+    vertices.reserve(size_t(n+1)*(n+1)*3);
+    for (unsigned y=0; y<=n; ++y) {
+        for (unsigned x=0; x<=n; ++x) {
+            float u = x/(float)n, v = y/(float)n;
+            vertices.push_back(u);
+            vertices.push_back(v);
+            vertices.push_back(.05f*std::sin(u*40.f)*std::cos(v*40.f));
+        }
+    }
+
+    std::vector<uint32_t> indices;
+    indices.reserve(numTriangles*3);
+    for (unsigned y=0; y<n; ++y) {
+        for (unsigned x=0; x<n; ++x) {
+            uint32_t i0 = y*(n+1)+x, i1 = i0+1, i2 = i0+n+1, i3 = i2+1;
+            indices.insert(indices.end(),{i0,i1,i3, i0,i3,i2});
+        }
+    }
+
+    ANARILibrary library = anariLoadLibrary("generic", statusFunc);
+    if (library == nullptr) {
+        fprintf(stderr, "Error loading the generic ANARI library\n");
+        return EXIT_FAILURE;
+    }
+
+    ANARIDevice device = anariNewDevice(library,"default");
+    anariCommitParameters(device,device);
+
+    ANARICamera camera = anariNewCamera(device,"perspective");
+    float position[3] = {.5f,-.3f,1.f};
+    float direction[3] = {0.f,.8f,-1.f};
+    anariSetParameter(device,camera,"position",ANARI_FLOAT32_VEC3,position);
+    anariSetParameter(device,camera,"direction",ANARI_FLOAT32_VEC3,direction);
+    anariCommitParameters(device,camera);
+
+    ANARIRenderer renderer = anariNewRenderer(device,"ao");
+    anariCommitParameters(device,renderer);
+
+    ANARIWorld world = anariNewWorld(device);
+    anariCommitParameters(device,world);
+
+    ANARIFrame frame = anariNewFrame(device);
+    uint32_t size[2] = {1024,1024};
+    ANARIDataType channelType = ANARI_UFIXED8_RGBA_SRGB;
+    anariSetParameter(device,frame,"size",ANARI_UINT32_VEC2,size);
+    anariSetParameter(device,frame,"channel.color",ANARI_DATA_TYPE,&channelType);
+    anariSetParameter(device,frame,"world",ANARI_WORLD,&world);
+    anariSetParameter(device,frame,"camera",ANARI_CAMERA,&camera);
+    anariSetParameter(device,frame,"renderer",ANARI_RENDERER,&renderer);
+    anariCommitParameters(device,frame);
+
+    printf("%zu triangles, %d frames at %ux%u\n", numTriangles, numFrames, size[0], size[1]);
+    printf("%-8s %-7s %14s %14s %14s\n", "compact", "wide", "bytes", "first [s]", "frame [s]");
+
+    for (int config=0; config<4; ++config) {
+        bool compact = config & 1;
+        bool wide = config & 2;
+
+        anariSetParameter(device,device,"wideBVH",ANARI_BOOL,&wide);
+        anariCommitParameters(device,device);
+
+        // Empty world; the baseline includes the framebuffer
+        anariUnsetParameter(device,world,"surface");
+        anariCommitParameters(device,world);
+        renderFrame(device,frame);
+        uint64_t baseline = liveBytes(device);
+
+        ANARIArray1D vertexArray = anariNewArray1D(device,vertices.data(),keepBuffer,nullptr,
+                                                   ANARI_FLOAT32_VEC3,vertices.size()/3,0);
+        ANARIArray1D indexArray = anariNewArray1D(device,indices.data(),keepBuffer,nullptr,
+                                                  ANARI_UINT32_VEC3,indices.size()/3,0);
+
+        ANARIGeometry geom = anariNewGeometry(device,"triangle");
+        anariSetParameter(device,geom,"vertex.position",ANARI_ARRAY1D,&vertexArray);
+        anariSetParameter(device,geom,"primitive.index",ANARI_ARRAY1D,&indexArray);
+        anariSetParameter(device,geom,"compact",ANARI_BOOL,&compact);
+        anariCommitParameters(device,geom);
+
+        ANARISurface surf = anariNewSurface(device);
+        anariSetParameter(device,surf,"geometry",ANARI_GEOMETRY,&geom);
+        anariCommitParameters(device,surf);
+
+        // Managed, surf is a local
+        ANARIArray1D surfaces = anariNewArray1D(device,nullptr,nullptr,nullptr,ANARI_SURFACE,1,0);
+        *(ANARISurface*)anariMapArray(device,surfaces) = surf;
+        anariUnmapArray(device,surfaces);
+        anariSetParameter(device,world,"surface",ANARI_ARRAY1D,&surfaces);
+        anariCommitParameters(device,world);
+
+        anariRelease(device,surfaces);
+        anariRelease(device,surf);
+        anariRelease(device,geom);
+        anariRelease(device,indexArray);
+        anariRelease(device,vertexArray);
+
+        double first = renderFrame(device,frame);
+        uint64_t bytes = liveBytes(device)-baseline;
+
+        double total = 0.0;
+        for (int i=0; i<numFrames; ++i) {
+            total += renderFrame(device,frame);
+        }
+
+        printf("%-8s %-7s %14llu %14.3f %14.4f\n", compact ? "on" : "off", wide ? "on" : "off",
+               (unsigned long long)bytes, first, numFrames > 0 ? total/numFrames : 0.0);
+    }
+
+    anariRelease(device,frame);
+    anariRelease(device,world);
+    anariRelease(device,renderer);
+    anariRelease(device,camera);
+    anariRelease(device,device);
+    anariUnloadLibrary(library);
+}
@@ -0,0 +1,198 @@
+// Build time of large cylinder geometries: random-walk streamlines split
+// into segments, committed non-indexed (two vertices per segment) and
+// indexed (segments share the vertices of their streamline), each with
+// per-segment radii and vertex.cap. Reports the time of the frame that
+// flushes the commit (the BVH build included) next to the time of the
+// following frames, which do not rebuild.
+//
+// Usage: cylinder_build_bench [segments] [frames]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <anari/anari.h>
+
+static void statusFunc(const void* userData,
+    ANARIDevice device,
+    ANARIObject source,
+    ANARIDataType sourceType,
+    ANARIStatusSeverity severity,
+    ANARIStatusCode code,
+    const char* message)
+{
+    if (severity <= ANARI_SEVERITY_WARNING)
+        fprintf(stderr, "%s\n", message);
+}
+
+// The streamlines outlive all arrays; a deleter that does nothing lets
+// the device use them in place rather than copy them on release
+static void keepBuffer(const void* userPtr, const void* appMemory)
+{
+}
+
+static double renderFrame(ANARIDevice device, ANARIFrame frame)
+{
+    auto start = std::chrono::steady_clock::now();
+    anariRenderFrame(device,frame);
+    anariFrameReady(device,frame,ANARI_WAIT);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end-start).count();
+}
+
+int main(int argc, char** argv)
+{
+    size_t numSegments = argc > 1 ? strtoull(argv[1],nullptr,10) : 1000000;
+    int numFrames = argc > 2 ? atoi(argv[2]) : 10;
+
+    // Streamlines of 100 segments through the unit cube
+    const size_t segmentsPerLine = 100;
+    size_t numLines = (numSegments+segmentsPerLine-1)/segmentsPerLine;
+    numSegments = numLines*segmentsPerLine;
+
+    std::minstd_rand rng(0);
+    std::uniform_real_distribution<float> dist(0.f,1.f);
+
+    std::vector<float> lineVertices;
+    lineVertices.reserve(numLines*(segmentsPerLine+1)*3);
+    for (size_t l=0; l<numLines; ++l) {
+        float p[3] = {dist(rng),dist(rng),dist(rng)};
+        for (size_t s=0; s<=segmentsPerLine; ++s) {
+            lineVertices.insert(lineVertices.end(),{p[0],p[1],p[2]});
+            for (int c=0; c<3; ++c) {
+                p[c] += (dist(rng)-.5f)*.01f;
+            }
+        }
+    }
+
+    std::vector<float> segmentVertices;
+    std::vector<uint32_t> indices;
+    segmentVertices.reserve(numSegments*6);
+    indices.reserve(numSegments*2);
+    for (size_t l=0; l<numLines; ++l) {
+        for (size_t s=0; s<segmentsPerLine; ++s) {
+            uint32_t v = uint32_t(l*(segmentsPerLine+1)+s);
+            const float* v1 = &lineVertices[v*3];
+            const float* v2 = &lineVertices[(v+1)*3];
+            segmentVertices.insert(segmentVertices.end(),{v1[0],v1[1],v1[2],v2[0],v2[1],v2[2]});
+            indices.insert(indices.end(),{v,v+1});
+        }
+    }
+
+    std::vector<float> radii(numSegments);
+    for (float& r : radii) {
+        r = .0005f+dist(rng)*.001f;
+    }
+
+    // Cap where streamlines start and end
+    std::vector<uint32_t> lineCaps(lineVertices.size()/3,0);
+    std::vector<uint32_t> segmentCaps(segmentVertices.size()/3,0);
+    for (size_t l=0; l<numLines; ++l) {
+        lineCaps[l*(segmentsPerLine+1)] = 1;
+        lineCaps[(l+1)*(segmentsPerLine+1)-1] = 1;
+        segmentCaps[l*segmentsPerLine*2] = 1;
+        segmentCaps[(l+1)*segmentsPerLine*2-1] = 1;
+    }
+
+    ANARILibrary library = anariLoadLibrary("generic", statusFunc);
+    if (library == nullptr) {
+        fprintf(stderr, "Error loading the generic ANARI library\n");
+        return EXIT_FAILURE;
+    }
+
+    ANARIDevice device = anariNewDevice(library,"default");
+    anariCommitParameters(device,device);
+
+    ANARICamera camera = anariNewCamera(device,"perspective");
+    float position[3] = {.5f,.5f,2.5f};
+    float direction[3] = {0.f,0.f,-1.f};
+    anariSetParameter(device,camera,"position",ANARI_FLOAT32_VEC3,position);
+    anariSetParameter(device,camera,"direction",ANARI_FLOAT32_VEC3,direction);
+    anariCommitParameters(device,camera);
+
+    ANARIRenderer renderer = anariNewRenderer(device,"ao");
+    anariCommitParameters(device,renderer);
+
+    ANARIWorld world = anariNewWorld(device);
+    anariCommitParameters(device,world);
+
+    ANARIFrame frame = anariNewFrame(device);
+    uint32_t size[2] = {1024,1024};
+    ANARIDataType channelType = ANARI_UFIXED8_RGBA_SRGB;
+    anariSetParameter(device,frame,"size",ANARI_UINT32_VEC2,size);
+    anariSetParameter(device,frame,"channel.color",ANARI_DATA_TYPE,&channelType);
+    anariSetParameter(device,frame,"world",ANARI_WORLD,&world);
+    anariSetParameter(device,frame,"camera",ANARI_CAMERA,&camera);
+    anariSetParameter(device,frame,"renderer",ANARI_RENDERER,&renderer);
+    anariCommitParameters(device,frame);
+
+    printf("%zu segments in %zu streamlines, %d frames at %ux%u\n",
+           numSegments, numLines, numFrames, size[0], size[1]);
+    printf("%-8s %14s %14s\n", "indexed", "build [s]", "frame [s]");
+
+    for (int config=0; config<2; ++config) {
+        bool indexed = config & 1;
+
+        const std::vector<float>& vertices = indexed ? lineVertices : segmentVertices;
+        const std::vector<uint32_t>& caps = indexed ? lineCaps : segmentCaps;
+
+        ANARIArray1D vertexArray = anariNewArray1D(device,vertices.data(),keepBuffer,nullptr,
+                                                   ANARI_FLOAT32_VEC3,vertices.size()/3,0);
+        ANARIArray1D capArray = anariNewArray1D(device,caps.data(),keepBuffer,nullptr,
+                                                ANARI_UINT32,caps.size(),0);
+        ANARIArray1D radiusArray = anariNewArray1D(device,radii.data(),keepBuffer,nullptr,
+                                                   ANARI_FLOAT32,radii.size(),0);
+
+        ANARIGeometry geom = anariNewGeometry(device,"cylinder");
+        anariSetParameter(device,geom,"vertex.position",ANARI_ARRAY1D,&vertexArray);
+        anariSetParameter(device,geom,"vertex.cap",ANARI_ARRAY1D,&capArray);
+        anariSetParameter(device,geom,"primitive.radius",ANARI_ARRAY1D,&radiusArray);
+
+        ANARIArray1D indexArray = nullptr;
+        if (indexed) {
+            indexArray = anariNewArray1D(device,indices.data(),keepBuffer,nullptr,
+                                         ANARI_UINT32_VEC2,indices.size()/2,0);
+            anariSetParameter(device,geom,"primitive.index",ANARI_ARRAY1D,&indexArray);
+        }
+
+        anariCommitParameters(device,geom);
+
+        ANARISurface surf = anariNewSurface(device);
+        anariSetParameter(device,surf,"geometry",ANARI_GEOMETRY,&geom);
+        anariCommitParameters(device,surf);
+
+        // Managed, surf is a local
+        ANARIArray1D surfaces = anariNewArray1D(device,nullptr,nullptr,nullptr,ANARI_SURFACE,1,0);
+        *(ANARISurface*)anariMapArray(device,surfaces) = surf;
+        anariUnmapArray(device,surfaces);
+        anariSetParameter(device,world,"surface",ANARI_ARRAY1D,&surfaces);
+        anariCommitParameters(device,world);
+
+        anariRelease(device,surfaces);
+        anariRelease(device,surf);
+        anariRelease(device,geom);
+        if (indexArray != nullptr)
+            anariRelease(device,indexArray);
+        anariRelease(device,radiusArray);
+        anariRelease(device,capArray);
+        anariRelease(device,vertexArray);
+
+        double build = renderFrame(device,frame);
+
+        double total = 0.0;
+        for (int i=0; i<numFrames; ++i) {
+            total += renderFrame(device,frame);
+        }
+
+        printf("%-8s %14.3f %14.4f\n", indexed ? "on" : "off",
+               build, numFrames > 0 ? total/numFrames : 0.0);
+    }
+
+    anariRelease(device,frame);
+    anariRelease(device,world);
+    anariRelease(device,renderer);
+    anariRelease(device,camera);
+    anariRelease(device,device);
+    anariUnloadLibrary(library);
+}
@@ -0,0 +1,278 @@
+// Renders rows of cylinders and checks the primitive IDs of the pixels they
+// cover: non-indexed cylinders with per-cylinder radii, indexed cylinders
+// with the global radius, and caps set globally and through vertex.cap.
+// Fails on pixels that do not show the expected cylinder (or background),
+// and on errors reported by the device.
+//
+// Usage: cylinder_test
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <anari/anari.h>
+
+static unsigned errors = 0;
+
+static void statusFunc(const void* userData,
+    ANARIDevice device,
+    ANARIObject source,
+    ANARIDataType sourceType,
+    ANARIStatusSeverity severity,
+    ANARIStatusCode code,
+    const char* message)
+{
+    if (severity <= ANARI_SEVERITY_ERROR)
+        errors++;
+
+    if (severity <= ANARI_SEVERITY_WARNING)
+        fprintf(stderr, "%s\n", message);
+}
+
+static const unsigned Size = 512;
+static const unsigned Miss = ~0u;
+
+// The camera sits at (.5,.5,2) and looks down -z with a 60 degree field of
+// view, so the z=0 plane maps linearly to pixels
+static unsigned pixelX(float x)
+{
+    float extent = 2.f*2.f*std::tan(float(M_PI)/6.f);
+    return unsigned(((x-.5f)/extent+.5f)*Size);
+}
+
+struct Scene
+{
+    ANARIDevice device;
+    ANARIWorld world;
+    ANARIFrame frame;
+    std::vector<uint32_t> primitiveIDs;
+
+    void render(ANARIGeometry geom)
+    {
+        anariCommitParameters(device,geom);
+
+        ANARISurface surf = anariNewSurface(device);
+        anariSetParameter(device,surf,"geometry",ANARI_GEOMETRY,&geom);
+        anariCommitParameters(device,surf);
+
+        ANARIArray1D surfaces = anariNewArray1D(device,nullptr,nullptr,nullptr,ANARI_SURFACE,1,0);
+        *(ANARISurface*)anariMapArray(device,surfaces) = surf;
+        anariUnmapArray(device,surfaces);
+        anariSetParameter(device,world,"surface",ANARI_ARRAY1D,&surfaces);
+        anariCommitParameters(device,world);
+
+        anariRelease(device,surfaces);
+        anariRelease(device,surf);
+
+        anariRenderFrame(device,frame);
+        anariFrameReady(device,frame,ANARI_WAIT);
+
+        uint32_t width, height;
+        ANARIDataType type;
+        const uint32_t* ids = (const uint32_t*)anariMapFrame(device,frame,"channel.primitiveId",
+                                                             &width,&height,&type);
+        if (ids != nullptr && width == Size && height == Size && type == ANARI_UINT32)
+            primitiveIDs.assign(ids,ids+size_t(width)*height);
+        else
+            primitiveIDs.assign(size_t(Size)*Size,Miss-1);
+        anariUnmapFrame(device,frame,"channel.primitiveId");
+    }
+
+    // Rows of vertical cylinders are checked along the middle row
+    bool expect(const char* test, float x, unsigned primID) const
+    {
+        unsigned px = pixelX(x);
+        unsigned id = primitiveIDs[size_t(Size/2)*Size+px];
+        if (id != primID) {
+            fprintf(stderr, "%s: pixel %u shows %d, expected %d\n",
+                    test, px, (int)id, (int)primID);
+            return false;
+        }
+        return true;
+    }
+};
+
+// Non-indexed, every two vertices form a cylinder; each has its own radius
+static bool testNonIndexed(Scene& scene, unsigned n)
+{
+    ANARIDevice device = scene.device;
+
+    std::vector<float> vertices;
+    std::vector<float> radii;
+    for (unsigned i=0; i<n; ++i) {
+        float x = (i+.5f)/n;
+        vertices.insert(vertices.end(),{x,.1f,0.f, x,.9f,0.f});
+        radii.push_back(.2f/n+.2f/n*i/n);
+    }
+
+    ANARIArray1D vertexArray = anariNewArray1D(device,vertices.data(),nullptr,nullptr,
+                                               ANARI_FLOAT32_VEC3,vertices.size()/3,0);
+    ANARIArray1D radiusArray = anariNewArray1D(device,radii.data(),nullptr,nullptr,
+                                               ANARI_FLOAT32,radii.size(),0);
+
+    ANARIGeometry geom = anariNewGeometry(device,"cylinder");
+    anariSetParameter(device,geom,"vertex.position",ANARI_ARRAY1D,&vertexArray);
+    anariSetParameter(device,geom,"primitive.radius",ANARI_ARRAY1D,&radiusArray);
+    scene.render(geom);
+
+    anariRelease(device,geom);
+    anariRelease(device,radiusArray);
+    anariRelease(device,vertexArray);
+
+    bool ok = true;
+    for (unsigned i=0; i<n; ++i) {
+        float x = (i+.5f)/n;
+        ok &= scene.expect("non-indexed",x,i);
+        ok &= scene.expect("non-indexed",x+radii[i]*.6f,i);
+        ok &= scene.expect("non-indexed",x+radii[i]*1.4f,Miss);
+    }
+    return ok;
+}
+
+// Indexed, in reverse order of the vertices; all share the global radius
+static bool testIndexed(Scene& scene, unsigned n)
+{
+    ANARIDevice device = scene.device;
+
+    std::vector<float> vertices;
+    std::vector<uint32_t> indices;
+    for (unsigned i=0; i<n; ++i) {
+        float x = (i+.5f)/n;
+        vertices.insert(vertices.end(),{x,.1f,0.f, x,.9f,0.f});
+        uint32_t v = (n-1-i)*2;
+        indices.insert(indices.end(),{v,v+1});
+    }
+    float radius = .25f/n;
+
+    ANARIArray1D vertexArray = anariNewArray1D(device,vertices.data(),nullptr,nullptr,
+                                               ANARI_FLOAT32_VEC3,vertices.size()/3,0);
+    ANARIArray1D indexArray = anariNewArray1D(device,indices.data(),nullptr,nullptr,
+                                              ANARI_UINT32_VEC2,indices.size()/2,0);
+
+    ANARIGeometry geom = anariNewGeometry(device,"cylinder");
+    anariSetParameter(device,geom,"vertex.position",ANARI_ARRAY1D,&vertexArray);
+    anariSetParameter(device,geom,"primitive.index",ANARI_ARRAY1D,&indexArray);
+    anariSetParameter(device,geom,"radius",ANARI_FLOAT32,&radius);
+    scene.render(geom);
+
+    anariRelease(device,geom);
+    anariRelease(device,indexArray);
+    anariRelease(device,vertexArray);
+
+    bool ok = true;
+    for (unsigned i=0; i<n; ++i) {
+        float x = (i+.5f)/n;
+        ok &= scene.expect("indexed",x,n-1-i);
+        ok &= scene.expect("indexed",x+radius*.6f,n-1-i);
+        ok &= scene.expect("indexed",x+radius*1.4f,Miss);
+    }
+    return ok;
+}
+
+// A tube along the view direction; rays near its axis pass through unless
+// one of the ends is capped
+static bool testCaps(Scene& scene, const char* caps, const uint32_t* vertexCaps, bool hit)
+{
+    ANARIDevice device = scene.device;
+
+    float vertices[] = {.5f,.5f,0.f, .5f,.5f,-1.f};
+    float radius = .2f;
+
+    ANARIArray1D vertexArray = anariNewArray1D(device,vertices,nullptr,nullptr,
+                                               ANARI_FLOAT32_VEC3,2,0);
+
+    ANARIGeometry geom = anariNewGeometry(device,"cylinder");
+    anariSetParameter(device,geom,"vertex.position",ANARI_ARRAY1D,&vertexArray);
+    anariSetParameter(device,geom,"radius",ANARI_FLOAT32,&radius);
+    anariSetParameter(device,geom,"caps",ANARI_STRING,caps);
+
+    ANARIArray1D capArray = nullptr;
+    if (vertexCaps != nullptr) {
+        capArray = anariNewArray1D(device,vertexCaps,nullptr,nullptr,ANARI_UINT32,2,0);
+        anariSetParameter(device,geom,"vertex.cap",ANARI_ARRAY1D,&capArray);
+    }
+
+    scene.render(geom);
+
+    anariRelease(device,geom);
+    if (capArray != nullptr)
+        anariRelease(device,capArray);
+    anariRelease(device,vertexArray);
+
+    char test[64];
+    snprintf(test, sizeof(test), "caps \"%s\"%s", caps,
+             vertexCaps == nullptr ? "" : vertexCaps[0] ? ", vertex.cap 1/0"
+             : vertexCaps[1] ? ", vertex.cap 0/1" : ", vertex.cap 0/0");
+
+    // Slightly off the axis, rays exactly parallel to it are degenerate
+    return scene.expect(test,.55f,hit ? 0 : Miss);
+}
+
+int main(int argc, char** argv)
+{
+    ANARILibrary library = anariLoadLibrary("generic", statusFunc);
+    if (library == nullptr) {
+        fprintf(stderr, "Error loading the generic ANARI library\n");
+        return EXIT_FAILURE;
+    }
+
+    ANARIDevice device = anariNewDevice(library,"default");
+    anariCommitParameters(device,device);
+
+    ANARICamera camera = anariNewCamera(device,"perspective");
+    float position[3] = {.5f,.5f,2.f};
+    float direction[3] = {0.f,0.f,-1.f};
+    float fovy = float(M_PI)/3.f;
+    float aspect = 1.f;
+    anariSetParameter(device,camera,"position",ANARI_FLOAT32_VEC3,position);
+    anariSetParameter(device,camera,"direction",ANARI_FLOAT32_VEC3,direction);
+    anariSetParameter(device,camera,"fovy",ANARI_FLOAT32,&fovy);
+    anariSetParameter(device,camera,"aspect",ANARI_FLOAT32,&aspect);
+    anariCommitParameters(device,camera);
+
+    ANARIRenderer renderer = anariNewRenderer(device,"default");
+    anariCommitParameters(device,renderer);
+
+    ANARIWorld world = anariNewWorld(device);
+    anariCommitParameters(device,world);
+
+    ANARIFrame frame = anariNewFrame(device);
+    uint32_t size[2] = {Size,Size};
+    ANARIDataType colorType = ANARI_UFIXED8_RGBA_SRGB;
+    ANARIDataType idType = ANARI_UINT32;
+    anariSetParameter(device,frame,"size",ANARI_UINT32_VEC2,size);
+    anariSetParameter(device,frame,"channel.color",ANARI_DATA_TYPE,&colorType);
+    anariSetParameter(device,frame,"channel.primitiveId",ANARI_DATA_TYPE,&idType);
+    anariSetParameter(device,frame,"world",ANARI_WORLD,&world);
+    anariSetParameter(device,frame,"camera",ANARI_CAMERA,&camera);
+    anariSetParameter(device,frame,"renderer",ANARI_RENDERER,&renderer);
+    anariCommitParameters(device,frame);
+
+    Scene scene{device,world,frame};
+
+    const uint32_t capsFirst[] = {1,0};
+    const uint32_t capsSecond[] = {0,1};
+    const uint32_t capsNone[] = {0,0};
+
+    bool ok = true;
+    ok &= testNonIndexed(scene,8);
+    ok &= testIndexed(scene,8);
+    ok &= testCaps(scene,"none",nullptr,false);
+    ok &= testCaps(scene,"first",nullptr,true);
+    ok &= testCaps(scene,"second",nullptr,true);
+    ok &= testCaps(scene,"none",capsFirst,true);
+    ok &= testCaps(scene,"none",capsSecond,true);
+    // vertex.cap takes precedence over the global mode
+    ok &= testCaps(scene,"both",capsNone,false);
+
+    printf("%s, %u errors\n", ok ? "passed" : "failed", errors);
+
+    anariRelease(device,frame);
+    anariRelease(device,world);
+    anariRelease(device,renderer);
+    anariRelease(device,camera);
+    anariRelease(device,device);
+    anariUnloadLibrary(library);
+
+    return ok && errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,92 @@
+// Throughput of anariSetParameter() on the generic device: sets a mix of
+// camera, light and frame parameters in a tight loop, including ones that
+// are only found in the base class table, and reports the time per call.
+//
+// Usage: param_dispatch_bench [iterations]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <anari/anari.h>
+
+static void statusFunc(const void* userData,
+    ANARIDevice device,
+    ANARIObject source,
+    ANARIDataType sourceType,
+    ANARIStatusSeverity severity,
+    ANARIStatusCode code,
+    const char* message)
+{
+    if (severity <= ANARI_SEVERITY_WARNING)
+        fprintf(stderr, "%s\n", message);
+}
+
+int main(int argc, char** argv)
+{
+    size_t iterations = argc > 1 ? strtoull(argv[1],nullptr,10) : 1000000;
+
+    ANARILibrary library = anariLoadLibrary("generic", statusFunc);
+    if (library == nullptr) {
+        fprintf(stderr, "Error loading the generic ANARI library\n");
+        return EXIT_FAILURE;
+    }
+
+    ANARIDevice device = anariNewDevice(library,"default");
+    anariCommitParameters(device,device);
+
+    ANARICamera camera = anariNewCamera(device,"perspective");
+    ANARILight light = anariNewLight(device,"quad");
+    ANARIFrame frame = anariNewFrame(device);
+
+    float position[3] = {1.f,2.f,3.f};
+    float fovy = .8f;
+    float ipd = .065f;
+    float color[3] = {1.f,.9f,.8f};
+    uint32_t size[2] = {1920,1080};
+    ANARIDataType channelType = ANARI_UFIXED8_RGBA_SRGB;
+
+    struct Call
+    {
+        ANARIObject object;
+        const char* name;
+        ANARIDataType type;
+        const void* mem;
+    };
+
+    const Call calls[] = {
+        { camera, "position",               ANARI_FLOAT32_VEC3, position     },
+        { camera, "fovy",                   ANARI_FLOAT32,      &fovy        },
+        { camera, "interpupillaryDistance", ANARI_FLOAT32,      &ipd         }, // base class
+        { light,  "side",                   ANARI_STRING,       "both"       },
+        { light,  "color",                  ANARI_FLOAT32_VEC3, color        }, // base class
+        { frame,  "size",                   ANARI_UINT32_VEC2,  size         },
+        { frame,  "channel.color",          ANARI_DATA_TYPE,    &channelType },
+    };
+    const size_t numCalls = sizeof(calls)/sizeof(calls[0]);
+
+    // Warm up
+    for (size_t i=0; i<numCalls; ++i) {
+        anariSetParameter(device,calls[i].object,calls[i].name,calls[i].type,calls[i].mem);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t it=0; it<iterations; ++it) {
+        for (size_t i=0; i<numCalls; ++i) {
+            anariSetParameter(device,calls[i].object,calls[i].name,calls[i].type,calls[i].mem);
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end-start).count();
+    double total = double(iterations)*numCalls;
+
+    printf("%.0f anariSetParameter() calls in %.3f s: %.1f ns/call, %.2f Mcalls/s\n",
+           total, seconds, seconds*1e9/total, total/seconds*1e-6);
+
+    anariRelease(device,frame);
+    anariRelease(device,light);
+    anariRelease(device,camera);
+    anariRelease(device,device);
+    anariUnloadLibrary(library);
+}
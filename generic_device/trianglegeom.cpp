@@ -1,6 +1,8 @@
 #include <string.h>
+#include "array.hpp"
 #include "backend.hpp"
 #include "logging.hpp"
+#include "param.hpp"
 #include "trianglegeom.hpp"
 
 namespace generic {
@@ -11,15 +13,40 @@ namespace generic {
 
     TriangleGeom::~TriangleGeom()
     {
+        ReleaseResource(vertex_position);
+        ReleaseResource(vertex_normal);
+        ReleaseResource(vertex_color);
+        ReleaseResource(vertex_attribute0);
+        ReleaseResource(vertex_attribute1);
+        ReleaseResource(vertex_attribute2);
+        ReleaseResource(vertex_attribute3);
+        ReleaseResource(primitive_index);
     }
 
     void TriangleGeom::commit()
     {
-        if (vertex_position == nullptr)
+        if (vertex_position == nullptr) {
             LOG(logging::Level::Error) << "Triangle error: vertex.position not set but "
                 << "is a required parameter";
-        else
-            backend::commit(*this);
+            return;
+        }
+
+        // Other element types are converted on commit
+        Array1D* position = (Array1D*)GetResource(vertex_position);
+        Array1D* index = (Array1D*)GetResource(primitive_index);
+        if (!position->convertibleTo(ANARI_FLOAT32_VEC3)
+         || (index != nullptr && !index->convertibleTo(ANARI_UINT32_VEC3))) {
+            LOG(logging::Level::Error) << "Triangle error: unsupported vertex.position "
+                << "or primitive.index element type";
+            return;
+        }
+
+        if (index == nullptr && position->numItems[0]%3 != 0) {
+            LOG(logging::Level::Warning) << "Triangle warning: vertex.position size "
+                << "is not a multiple of three, ignoring trailing vertices";
+        }
+
+        backend::commit(*this);
     }
 
     void TriangleGeom::release()
@@ -30,53 +57,36 @@ namespace generic {
     {
     }
 
+    static constexpr auto paramTable = sortParams({
+        GENERIC_PARAM(TriangleGeomParams,"vertex.position",ANARI_ARRAY1D,vertex_position),
+        GENERIC_PARAM(TriangleGeomParams,"vertex.normal",ANARI_ARRAY1D,vertex_normal),
+        GENERIC_PARAM(TriangleGeomParams,"vertex.color",ANARI_ARRAY1D,vertex_color),
+        GENERIC_PARAM(TriangleGeomParams,"vertex.attribute0",ANARI_ARRAY1D,vertex_attribute0),
+        GENERIC_PARAM(TriangleGeomParams,"vertex.attribute1",ANARI_ARRAY1D,vertex_attribute1),
+        GENERIC_PARAM(TriangleGeomParams,"vertex.attribute2",ANARI_ARRAY1D,vertex_attribute2),
+        GENERIC_PARAM(TriangleGeomParams,"vertex.attribute3",ANARI_ARRAY1D,vertex_attribute3),
+        GENERIC_PARAM(TriangleGeomParams,"primitive.index",ANARI_ARRAY1D,primitive_index),
+        GENERIC_PARAM(TriangleGeomParams,"compact",ANARI_BOOL,compact),
+    });
+    static_assert(uniqueParamHashes(paramTable));
+
     void TriangleGeom::setParameter(const char* name,
                                     ANARIDataType type,
                                     const void* mem)
     {
-        if (strncmp(name,"vertex.position",15)==0 && type==ANARI_ARRAY1D) {
-            vertex_position = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"vertex.normal",13)==0 && type==ANARI_ARRAY1D) {
-            vertex_normal = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"vertex.color",12)==0 && type==ANARI_ARRAY1D) {
-            vertex_color = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"vertex.attribute0",17)==0 && type==ANARI_ARRAY1D) {
-            vertex_attribute0 = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"vertex.attribute1",17)==0 && type==ANARI_ARRAY1D) {
-            vertex_attribute1 = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"vertex.attribute2",17)==0 && type==ANARI_ARRAY1D) {
-            vertex_attribute2 = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"vertex.attribute3",17)==0 && type==ANARI_ARRAY1D) {
-            vertex_attribute3 = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"primitive.index",15)==0 && type==ANARI_ARRAY1D) {
-            primitive_index = *(ANARIArray1D*)mem; // TODO: reference count
-        } else {
-            LOG(logging::Level::Warning) << "Triangle: Unsupported parameter "
-                << "/ parameter type: " << name << " / " << type;
-        }
+        if (setParam(paramTable,static_cast<TriangleGeomParams&>(*this),name,type,mem))
+            return;
+
+        LOG(logging::Level::Warning) << "Triangle: Unsupported parameter "
+            << "/ parameter type: " << name << " / " << type;
     }
 
     void TriangleGeom::unsetParameter(const char* name)
     {
-        if (strncmp(name,"vertex.position",15)==0) {
-            vertex_position = nullptr;
-        } else if (strncmp(name,"vertex.normal",13)==0) {
-            vertex_normal = nullptr;
-        } else if (strncmp(name,"vertex.color",12)==0) {
-            vertex_color = nullptr;
-        } else if (strncmp(name,"vertex.attribute0",17)==0) {
-            vertex_attribute0 = nullptr;
-        } else if (strncmp(name,"vertex.attribute1",17)==0) {
-            vertex_attribute1 = nullptr;
-        } else if (strncmp(name,"vertex.attribute2",17)==0) {
-            vertex_attribute2 = nullptr;
-        } else if (strncmp(name,"vertex.attribute3",17)==0) {
-            vertex_attribute3 = nullptr;
-        } else if (strncmp(name,"primitive.index",15)==0) {
-            primitive_index = nullptr;
-        } else {
-            LOG(logging::Level::Warning) << "Triangle: Unsupported parameter " << name;
-        }
+        if (unsetParam(paramTable,static_cast<TriangleGeomParams&>(*this),name))
+            return;
+
+        LOG(logging::Level::Warning) << "Triangle: Unsupported parameter " << name;
     }
 
 } // generic
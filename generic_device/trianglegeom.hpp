@@ -4,7 +4,22 @@
 
 namespace generic {
 
-    class TriangleGeom : public Geometry
+    struct TriangleGeomParams
+    {
+        ANARIArray1D vertex_position = nullptr;
+        ANARIArray1D vertex_normal = nullptr;
+        ANARIArray1D vertex_color = nullptr;
+        ANARIArray1D vertex_attribute0 = nullptr;
+        ANARIArray1D vertex_attribute1 = nullptr;
+        ANARIArray1D vertex_attribute2 = nullptr;
+        ANARIArray1D vertex_attribute3 = nullptr;
+        ANARIArray1D primitive_index = nullptr;
+
+        // Compact BVH storage for very large meshes, see backend
+        bool compact = false;
+    };
+
+    class TriangleGeom : public Geometry, public TriangleGeomParams
     {
     public:
         TriangleGeom();
@@ -21,15 +36,6 @@ namespace generic {
                           const void* mem);
 
         void unsetParameter(const char* name);
-
-        ANARIArray1D vertex_position = nullptr;
-        ANARIArray1D vertex_normal = nullptr;
-        ANARIArray1D vertex_color = nullptr;
-        ANARIArray1D vertex_attribute0 = nullptr;
-        ANARIArray1D vertex_attribute1 = nullptr;
-        ANARIArray1D vertex_attribute2 = nullptr;
-        ANARIArray1D vertex_attribute3 = nullptr;
-        ANARIArray1D primitive_index = nullptr;
     };
 
 } // generic
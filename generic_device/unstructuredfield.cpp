@@ -0,0 +1,151 @@
+#include <string.h>
+#include "array.hpp"
+#include "backend.hpp"
+#include "logging.hpp"
+#include "param.hpp"
+#include "unstructuredfield.hpp"
+
+namespace generic {
+
+    UnstructuredField::UnstructuredField()
+        : SpatialField()
+    {
+    }
+
+    UnstructuredField::~UnstructuredField()
+    {
+        ReleaseResource(vertexPosition);
+        ReleaseResource(vertexData);
+        ReleaseResource(cellIndex);
+        ReleaseResource(cellType);
+        ReleaseResource(index);
+    }
+
+    void UnstructuredField::commit()
+    {
+        if (vertexPosition == nullptr || vertexData == nullptr || index == nullptr
+         || cellIndex == nullptr || cellType == nullptr) {
+            LOG(logging::Level::Error) << "SpatialField.Unstructured error: "
+                << "vertex.position, vertex.data, index, cell.index and cell.type "
+                << "are required parameters";
+            return;
+        }
+
+        Array1D* position = (Array1D*)GetResource(vertexPosition);
+        Array1D* data = (Array1D*)GetResource(vertexData);
+        Array1D* idx = (Array1D*)GetResource(index);
+        Array1D* cidx = (Array1D*)GetResource(cellIndex);
+        Array1D* ctype = (Array1D*)GetResource(cellType);
+
+        if (!position->convertibleTo(ANARI_FLOAT32_VEC3) || !data->convertibleTo(ANARI_FLOAT32)) {
+            LOG(logging::Level::Error) << "SpatialField.Unstructured error: "
+                << "vertex.position must be a vec3 and vertex.data a scalar type";
+            return;
+        }
+
+        if (position->numItems[0] != data->numItems[0]) {
+            LOG(logging::Level::Error) << "SpatialField.Unstructured error: "
+                << "vertex.position and vertex.data must have the same size";
+            return;
+        }
+
+        if ((idx->elementType != ANARI_UINT32 && idx->elementType != ANARI_UINT64)
+         || (cidx->elementType != ANARI_UINT32 && cidx->elementType != ANARI_UINT64)
+         || ctype->elementType != ANARI_UINT8) {
+            LOG(logging::Level::Error) << "SpatialField.Unstructured error: "
+                << "index and cell.index must be UINT32 or UINT64, cell.type UINT8";
+            return;
+        }
+
+        if (cidx->numItems[0] != ctype->numItems[0]) {
+            LOG(logging::Level::Error) << "SpatialField.Unstructured error: "
+                << "cell.index and cell.type must have the same size";
+            return;
+        }
+
+        auto indexAt = [](const Array1D* arr, size_t i) -> uint64_t {
+            const uint8_t* elem = arr->internalData+i*arr->getElementStride();
+            if (arr->elementType == ANARI_UINT64)
+                return *(const uint64_t*)elem;
+            else
+                return *(const uint32_t*)elem;
+        };
+
+        // The backend indexes the arrays without further checks, so reject
+        // cells that reach past index or reference missing vertices
+        uint64_t numIndices = idx->numItems[0];
+        uint64_t numVerts = position->numItems[0];
+        size_t numBadCells = 0;
+
+        for (size_t i=0; i<cidx->numItems[0]; ++i) {
+            uint8_t type = ctype->internalData[i*ctype->getElementStride()];
+
+            uint64_t numCellVerts = 0;
+            if (type == 10)      // tetrahedron
+                numCellVerts = 4;
+            else if (type == 12) // hexahedron
+                numCellVerts = 8;
+            else if (type == 13) // wedge
+                numCellVerts = 6;
+            else if (type == 14) // pyramid
+                numCellVerts = 5;
+            else
+                continue; // skipped by the backend
+
+            uint64_t first = indexAt(cidx,i);
+            bool valid = first <= numIndices && numCellVerts <= numIndices-first;
+            for (uint64_t j=0; j<numCellVerts && valid; ++j) {
+                valid = indexAt(idx,first+j) < numVerts;
+            }
+
+            if (!valid)
+                ++numBadCells;
+        }
+
+        if (numBadCells > 0) {
+            LOG(logging::Level::Error) << "SpatialField.Unstructured error: "
+                << numBadCells << " cells with out-of-range index or vertex IDs";
+            return;
+        }
+
+        backend::commit(*this);
+    }
+
+    void UnstructuredField::release()
+    {
+    }
+
+    void UnstructuredField::retain()
+    {
+    }
+
+    static constexpr auto paramTable = sortParams({
+        GENERIC_PARAM(UnstructuredFieldParams,"vertex.position",ANARI_ARRAY1D,vertexPosition),
+        GENERIC_PARAM(UnstructuredFieldParams,"vertex.data",ANARI_ARRAY1D,vertexData),
+        GENERIC_PARAM(UnstructuredFieldParams,"cell.index",ANARI_ARRAY1D,cellIndex),
+        GENERIC_PARAM(UnstructuredFieldParams,"cell.type",ANARI_ARRAY1D,cellType),
+        GENERIC_PARAM(UnstructuredFieldParams,"index",ANARI_ARRAY1D,index),
+    });
+    static_assert(uniqueParamHashes(paramTable));
+
+    void UnstructuredField::setParameter(const char* name,
+                                         ANARIDataType type,
+                                         const void* mem)
+    {
+        if (setParam(paramTable,static_cast<UnstructuredFieldParams&>(*this),name,type,mem))
+            return;
+
+        LOG(logging::Level::Warning) << "UnstructuredField: Unsupported parameter "
+            << "/ parameter type: " << name << " / " << type;
+    }
+
+    void UnstructuredField::unsetParameter(const char* name)
+    {
+        if (unsetParam(paramTable,static_cast<UnstructuredFieldParams&>(*this),name))
+            return;
+
+        LOG(logging::Level::Warning) << "UnstructuredField: Unsupported parameter " << name;
+    }
+
+} // generic
+
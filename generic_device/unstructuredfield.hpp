@@ -0,0 +1,39 @@
+#pragma once
+
+#include "spatialfield.hpp"
+
+namespace generic {
+
+    struct UnstructuredFieldParams
+    {
+        ANARIArray1D vertexPosition = nullptr;
+        ANARIArray1D vertexData = nullptr;
+        ANARIArray1D index = nullptr;
+        ANARIArray1D cellIndex = nullptr;
+        ANARIArray1D cellType = nullptr;
+    };
+
+    // Unstructured grid with per-vertex data; cell.index holds the offset
+    // of each cell's first vertex into index, cell.type uses the VTK cell
+    // type IDs (tetrahedron, hexahedron, wedge, pyramid)
+    class UnstructuredField : public SpatialField, public UnstructuredFieldParams
+    {
+    public:
+        UnstructuredField();
+       ~UnstructuredField();
+
+        void commit();
+
+        void release();
+
+        void retain();
+
+        void setParameter(const char* name,
+                          ANARIDataType type,
+                          const void* mem);
+
+        void unsetParameter(const char* name);
+    };
+
+} // generic
+
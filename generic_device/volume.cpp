@@ -1,6 +1,7 @@
 #include <string.h>
 #include "backend.hpp"
 #include "logging.hpp"
+#include "param.hpp"
 #include "volume.hpp"
 
 namespace generic {
@@ -12,6 +13,11 @@ namespace generic {
 
     Volume::~Volume()
     {
+        ReleaseResource(field);
+        ReleaseResource(color);
+        ReleaseResource(color_position);
+        ReleaseResource(opacity);
+        ReleaseResource(opacity_position);
     }
 
     ResourceHandle Volume::getResourceHandle()
@@ -32,49 +38,35 @@ namespace generic {
     {
     }
 
+    static constexpr auto paramTable = sortParams({
+        GENERIC_PARAM(VolumeParams,"field",ANARI_SPATIAL_FIELD,field),
+        GENERIC_PARAM(VolumeParams,"valueRange",ANARI_FLOAT32_BOX1,valueRange),
+        GENERIC_PARAM(VolumeParams,"color",ANARI_ARRAY1D,color),
+        GENERIC_PARAM(VolumeParams,"color.position",ANARI_ARRAY1D,color_position),
+        GENERIC_PARAM(VolumeParams,"opacity",ANARI_ARRAY1D,opacity),
+        GENERIC_PARAM(VolumeParams,"opacity.position",ANARI_ARRAY1D,opacity_position),
+        GENERIC_PARAM(VolumeParams,"densityScale",ANARI_FLOAT32,densityScale),
+        GENERIC_PARAM(VolumeParams,"preIntegration",ANARI_BOOL,preIntegration),
+    });
+    static_assert(uniqueParamHashes(paramTable));
+
     void Volume::setParameter(const char* name,
                               ANARIDataType type,
                               const void* mem)
     {
-        if (strncmp(name,"field",5)==0 && type==ANARI_SPATIAL_FIELD) {
-            field = *(ANARISpatialField*)mem; // TODO: reference count
-        } else if (strncmp(name,"valueRange",10)==0 && type==ANARI_FLOAT32_BOX1) {
-            memcpy(valueRange,mem,sizeof(valueRange));
-        } else if (strncmp(name,"color",5)==0 && type==ANARI_ARRAY1D) {
-            color = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"color.position",14)==0 && type==ANARI_ARRAY1D) {
-            color_position = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"opacity",7)==0 && type==ANARI_ARRAY1D) {
-            opacity = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"opacity.position",16)==0 && type==ANARI_ARRAY1D) {
-            opacity_position = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"densityScale",12)==0 && type==ANARI_FLOAT32) {
-            memcpy(&densityScale,mem,sizeof(densityScale));
-        } else {
-            LOG(logging::Level::Warning) << "Volume: Unsupported parameter "
-                << "/ parameter type: " << name << " / " << type;
-        }
+        if (setParam(paramTable,static_cast<VolumeParams&>(*this),name,type,mem))
+            return;
+
+        LOG(logging::Level::Warning) << "Volume: Unsupported parameter "
+            << "/ parameter type: " << name << " / " << type;
     }
 
     void Volume::unsetParameter(const char* name)
     {
-        if (strncmp(name,"field",5)==0) {
-            field = nullptr;
-        } else if (strncmp(name,"valueRange",10)==0) {
-            valueRange[0] = 0.f; valueRange[1] = 1.f;
-        } else if (strncmp(name,"color",5)==0) {
-            color = nullptr;
-        } else if (strncmp(name,"color.position",14)==0) {
-            color_position = nullptr;
-        } else if (strncmp(name,"opacity",7)==0) {
-            opacity = nullptr;
-        } else if (strncmp(name,"opacity.position",16)==0) {
-            opacity_position = nullptr;
-        } else if (strncmp(name,"densityScale",12)==0) {
-            densityScale = 1.f;
-        } else {
-            LOG(logging::Level::Warning) << "Volume: Unsupported parameter " << name;
-        }
+        if (unsetParam(paramTable,static_cast<VolumeParams&>(*this),name))
+            return;
+
+        LOG(logging::Level::Warning) << "Volume: Unsupported parameter " << name;
     }
 
     std::unique_ptr<Volume> createVolume(const char* subtype)
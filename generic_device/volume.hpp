@@ -5,7 +5,20 @@
 
 namespace generic {
 
-    class Volume : public Object
+    struct VolumeParams
+    {
+        ANARISpatialField field = nullptr;
+        float valueRange[2] = {0.f,1.f};
+        ANARIArray1D color = nullptr;
+        ANARIArray1D color_position = nullptr;
+        ANARIArray1D opacity = nullptr;
+        ANARIArray1D opacity_position = nullptr;
+        float densityScale = 1.f;
+        // classify ray marching segments with a pre-integrated TF
+        int32_t preIntegration = false;
+    };
+
+    class Volume : public Object, public VolumeParams
     {
     public:
         Volume();
@@ -25,14 +38,6 @@ namespace generic {
 
         void unsetParameter(const char* name);
 
-        ANARISpatialField field = nullptr;
-        float valueRange[2] = {0.f,1.f};
-        ANARIArray1D color = nullptr;
-        ANARIArray1D color_position = nullptr;
-        ANARIArray1D opacity = nullptr;
-        ANARIArray1D opacity_position = nullptr;
-        float densityScale = 1.f;
-
     private:
         ANARIVolume resourceHandle;
     };
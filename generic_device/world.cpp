@@ -2,6 +2,7 @@
 #include "array.hpp"
 #include "backend.hpp"
 #include "logging.hpp"
+#include "param.hpp"
 #include "world.hpp"
 
 namespace generic {
@@ -13,6 +14,10 @@ namespace generic {
 
     World::~World()
     {
+        ReleaseResource(instance);
+        ReleaseResource(surface);
+        ReleaseResource(volume);
+        ReleaseResource(light);
     }
 
     ResourceHandle World::getResourceHandle()
@@ -33,37 +38,31 @@ namespace generic {
     {
     }
 
+    static constexpr auto paramTable = sortParams({
+        GENERIC_PARAM(WorldParams,"instance",ANARI_ARRAY1D,instance),
+        GENERIC_PARAM(WorldParams,"surface",ANARI_ARRAY1D,surface),
+        GENERIC_PARAM(WorldParams,"volume",ANARI_ARRAY1D,volume),
+        GENERIC_PARAM(WorldParams,"light",ANARI_ARRAY1D,light),
+    });
+    static_assert(uniqueParamHashes(paramTable));
+
     void World::setParameter(const char* name,
                              ANARIDataType type,
                              const void* mem)
     {
-        if (strncmp(name,"instance",8)==0 && type==ANARI_ARRAY1D) {
-            instance = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"surface",7)==0 && type==ANARI_ARRAY1D) {
-            surface = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"volume",6)==0 && type==ANARI_ARRAY1D) {
-            volume = *(ANARIArray1D*)mem; // TODO: reference count
-        } else if (strncmp(name,"light",5)==0 && type==ANARI_ARRAY1D) {
-            light = *(ANARIArray1D*)mem; // TODO: reference count
-        } else {
-            LOG(logging::Level::Warning) << "World: Unsupported parameter "
-                << "/ parameter type: " << name << " / " << type;
-        }
+        if (setParam(paramTable,static_cast<WorldParams&>(*this),name,type,mem))
+            return;
+
+        LOG(logging::Level::Warning) << "World: Unsupported parameter "
+            << "/ parameter type: " << name << " / " << type;
     }
 
     void World::unsetParameter(const char* name)
     {
-        if (strncmp(name,"instance",8)==0) {
-            instance = nullptr;
-        } else if (strncmp(name,"surface",7)==0) {
-            surface = nullptr;
-        } else if (strncmp(name,"volume",6)==0) {
-            volume = nullptr;
-        } else if (strncmp(name,"light",5)==0) {
-            light = nullptr;
-        } else {
-            LOG(logging::Level::Warning) << "World: Unsupported parameter " << name;
-        }
+        if (unsetParam(paramTable,static_cast<WorldParams&>(*this),name))
+            return;
+
+        LOG(logging::Level::Warning) << "World: Unsupported parameter " << name;
     }
 
 } // generic
@@ -5,7 +5,15 @@
 
 namespace generic {
 
-    class World : public Object
+    struct WorldParams
+    {
+        ANARIArray1D instance = nullptr;
+        ANARIArray1D surface = nullptr;
+        ANARIArray1D volume = nullptr;
+        ANARIArray1D light = nullptr;
+    };
+
+    class World : public Object, public WorldParams
     {
     public:
         World();
@@ -25,11 +33,6 @@ namespace generic {
 
         void unsetParameter(const char* name);
 
-        ANARIArray1D instance = nullptr;
-        ANARIArray1D surface = nullptr;
-        ANARIArray1D volume = nullptr;
-        ANARIArray1D light = nullptr;
-
     private:
         ANARIWorld resourceHandle;
     };
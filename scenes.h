@@ -479,11 +479,13 @@ struct AMRScene : Scene
         // see here: https://github.com/openvkl/openvkl/blob/master/openvkl/devices/cpu/volume/amr/AMRData.h#L28
         // how these are defined (upper is an integer coordinate and does not include the
         // extent of the rightmost cells)
+        // Level 0 is the coarsest level; with the default cell widths of
+        // 2^-L, the level 1 block refines cell (1,0,0) of block 0
         blockBoundData[0] = {
             {0,0,0},{1,1,1} // thats a 2^3 box
         };
         blockBoundData[1] = {
-            {1,0,0},{1,0,0}
+            {2,0,0},{3,1,1}
         };
         ANARIArray1D blockBounds = anariNewArray1D(device,blockBoundData.data(),0,0,
                                                    ANARI_INT32_BOX3,
@@ -497,9 +499,9 @@ struct AMRScene : Scene
 
         std::vector<ANARIArray3D> blockDataData(2);
         std::vector<float> block0(8); for (int i=0; i<8; ++i) block0[i] = i/float(8);
-        std::vector<float> block1(1); block1[0] = 1.f;
+        std::vector<float> block1(8); for (int i=0; i<8; ++i) block1[i] = 1.f-i/float(16);
         blockDataData[0] = anariNewArray3D(device,block0.data(),0,0,ANARI_FLOAT32,2,2,2);
-        blockDataData[1] = anariNewArray3D(device,block1.data(),0,0,ANARI_FLOAT32,1,1,1);
+        blockDataData[1] = anariNewArray3D(device,block1.data(),0,0,ANARI_FLOAT32,2,2,2);
         ANARIArray1D blockData = anariNewArray1D(device,blockDataData.data(),0,0,
                                                  ANARI_ARRAY3D,blockDataData.size());
 
@@ -555,7 +557,7 @@ struct AMRScene : Scene
 
     visionaray::aabb getBounds()
     {
-        return {{0,0,0},{4,2,2}};
+        return {{0,0,0},{2,2,2}};
     }
 
     void afterRenderFrame()
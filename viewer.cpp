@@ -1,4 +1,6 @@
 #include <stdio.h>
+#include <string.h>
+#include <chrono>
 #include <iomanip>
 #include <iostream>
 #include <ostream>
@@ -104,6 +106,33 @@ static uint32_t cvt_uint32_aces(const visionaray::vec4 &v)
   return cvt_uint32(visionaray::vec4(aces_fitted(v.xyz()), v.w));
 }
 
+// IEEE binary16 to binary32, for FLOAT16_VEC4 frames
+static float half_to_float(uint16_t h)
+{
+  uint32_t sign = uint32_t(h & 0x8000) << 16;
+  uint32_t exponent = (h >> 10) & 0x1f;
+  uint32_t mantissa = h & 0x3ff;
+  uint32_t bits;
+  if (exponent == 0 && mantissa == 0) {
+    bits = sign;
+  } else if (exponent == 0) {
+    // Subnormal, normalize
+    exponent = 127 - 15 + 1;
+    while (!(mantissa & 0x400)) {
+      mantissa <<= 1;
+      --exponent;
+    }
+    bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+  } else if (exponent == 31) {
+    bits = sign | 0x7f800000 | (mantissa << 13);
+  } else {
+    bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+  }
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
 struct Viewer : visionaray::viewer_glut
 {
     visionaray::pinhole_camera cam;
@@ -119,6 +148,8 @@ struct Viewer : visionaray::viewer_glut
         ACES_Approx,
     } tonemapping = ACES;
 
+    bool measureLatency = false;
+
     Viewer() : viewer_glut(512,512,"ANARI experiments") {
 
         using namespace support;
@@ -175,6 +206,14 @@ struct Viewer : visionaray::viewer_glut
             cl::ArgRequired,
             cl::init(tonemapping)
             ) );
+
+        add_cmdline_option( cl::makeOption<bool&>(
+            cl::Parser<>(),
+            "latency",
+            cl::Desc("Measure map-to-display latency at 4K for each color format, then continue"),
+            cl::ArgDisallowed,
+            cl::init(measureLatency)
+            ) );
     }
 
     void resetANARICamera() {
@@ -210,8 +249,112 @@ struct Viewer : visionaray::viewer_glut
         anariCommitParameters(anari.device, anari.world);
     }
 
+    // Float frames are tone mapped here, 8-bit frames are drawn as is
+    void displayColor(const void *fb, uint32_t w, uint32_t h, ANARIDataType type) {
+        if (fb == nullptr)
+            return;
+
+        const void *fbPointer = fb;
+        uint32_t *converted{nullptr};
+        if (type == ANARI_FLOAT32_VEC4 || type == ANARI_FLOAT16_VEC4) {
+            converted = new uint32_t[w*size_t(h)];
+            const float *fPtr = (const float *)fb;
+            const uint16_t *hPtr = (const uint16_t *)fb;
+            for (size_t i=0; i<w*size_t(h); ++i) {
+                visionaray::vec4 color = type == ANARI_FLOAT32_VEC4
+                    ? visionaray::vec4(fPtr[i*4], fPtr[i*4+1], fPtr[i*4+2], fPtr[i*4+3])
+                    : visionaray::vec4(half_to_float(hPtr[i*4]), half_to_float(hPtr[i*4+1]),
+                                       half_to_float(hPtr[i*4+2]), half_to_float(hPtr[i*4+3]));
+                if (tonemapping == ACES)
+                    converted[i] = cvt_uint32_aces(color);
+                else if (tonemapping == ACES_Approx)
+                    converted[i] = cvt_uint32_aces_approx(color);
+                else
+                    converted[i] = cvt_uint32(color);
+            }
+            fbPointer = converted;
+        }
+        visionaray::vec4f bgColor(background_color(),1.f);
+        glClearColor(bgColor[0],bgColor[1],bgColor[2],bgColor[3]);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glDrawPixels(w,h,GL_RGBA,GL_UNSIGNED_BYTE,fbPointer);
+        delete[] converted;
+    }
+
+    // Time from mapping the color channel until its pixels were drawn, at
+    // 4K and for each color format the device can write. Only the lower
+    // left part of the image fits into the window, but all of it is
+    // mapped, converted and sent to GL
+    void runLatencyTest() {
+        struct Format {
+            const char *name;
+            ANARIDataType type;
+            const char *tonemap;
+        };
+        const Format formats[] = {
+            { "FLOAT32_VEC4, viewer ACES",  ANARI_FLOAT32_VEC4,      "none" },
+            { "FLOAT16_VEC4, viewer ACES",  ANARI_FLOAT16_VEC4,      "none" },
+            { "UFIXED8_VEC4, device ACES",  ANARI_UFIXED8_VEC4,      "aces" },
+            { "UFIXED8_RGBA_SRGB",          ANARI_UFIXED8_RGBA_SRGB, "none" },
+        };
+        const int numFrames = 20;
+
+        Tonemapping prevTonemapping = tonemapping;
+        tonemapping = ACES;
+
+        unsigned size[2] = { 3840, 2160 };
+        anariSetParameter(anari.device, anari.frame, "size", ANARI_UINT32_VEC2, size);
+
+        printf("Map-to-display latency at %ux%u, average of %d frames\n", size[0], size[1], numFrames);
+        printf("%-28s %12s %14s\n", "format", "latency [ms]", "mapped bytes");
+
+        for (const Format &f : formats) {
+            anariSetParameter(anari.device, anari.frame, "channel.color", ANARI_DATA_TYPE, &f.type);
+            anariSetParameter(anari.device, anari.frame, "tonemap", ANARI_STRING, f.tonemap);
+            anariCommitParameters(anari.device, anari.frame);
+
+            double total = 0.0;
+            size_t bytes = 0;
+            for (int i=0; i<numFrames; ++i) {
+                anariRenderFrame(anari.device, anari.frame);
+                anariFrameReady(anari.device, anari.frame, ANARI_WAIT);
+
+                auto start = std::chrono::steady_clock::now();
+                uint32_t widthOUT;
+                uint32_t heightOUT;
+                ANARIDataType typeOUT;
+                const void *fb = anariMapFrame(anari.device, anari.frame, "channel.color", &widthOUT, &heightOUT, &typeOUT);
+                displayColor(fb,widthOUT,heightOUT,typeOUT);
+                glFinish();
+                anariUnmapFrame(anari.device, anari.frame, "channel.color");
+                auto end = std::chrono::steady_clock::now();
+
+                total += std::chrono::duration<double>(end-start).count();
+                bytes = fb != nullptr ? widthOUT*size_t(heightOUT)*anari::sizeOf(typeOUT) : 0;
+            }
+
+            printf("%-28s %12.2f %14zu\n", f.name, total/numFrames*1e3, bytes);
+        }
+
+        // Back to the window's size and the interactive format
+        tonemapping = prevTonemapping;
+        size[0] = width();
+        size[1] = height();
+        anariSetParameter(anari.device, anari.frame, "size", ANARI_UINT32_VEC2, size);
+        anariSetParameter(anari.device, anari.frame, "channel.color", ANARI_DATA_TYPE, &anari.colorFormat);
+        anariSetParameter(anari.device, anari.frame, "tonemap", ANARI_STRING, "none");
+        anariCommitParameters(anari.device, anari.frame);
+    }
+
     void on_display() {
 
+        if (measureLatency) {
+            runLatencyTest();
+            measureLatency = false;
+        }
+
         float duration = 0.f;
         if (anariGetProperty(anari.device, anari.frame, "duration", ANARI_FLOAT32, &duration, sizeof(duration), ANARI_NO_WAIT)) {
             std::stringstream str;
@@ -237,58 +380,29 @@ struct Viewer : visionaray::viewer_glut
             uint32_t heightOUT;
             ANARIDataType typeOUT;
             const void *fb = anariMapFrame(anari.device, anari.frame, "channel.color", &widthOUT, &heightOUT, &typeOUT);
-            void *fbPointer{nullptr};
-            if (tonemapping == ACES) {
-                fbPointer = new uint32_t[widthOUT*heightOUT];
-                const float *fPtr = (const float *)fb;
-                uint32_t *uPtr = (uint32_t *)fbPointer;
-                for (size_t i=0; i<widthOUT*size_t(heightOUT); ++i) {
-                    visionaray::vec4 color(
-                        fPtr[i*4], fPtr[i*4+1], fPtr[i*4+2], fPtr[i*4+3]
-                    );
-                    uPtr[i] = cvt_uint32_aces(color);
-                }
-            } else if (tonemapping == ACES_Approx) {
-                fbPointer = new uint32_t[widthOUT*heightOUT];
-                const float *fPtr = (const float *)fb;
-                uint32_t *uPtr = (uint32_t *)fbPointer;
-                for (size_t i=0; i<widthOUT*size_t(heightOUT); ++i) {
-                    visionaray::vec4 color(
-                        fPtr[i*4], fPtr[i*4+1], fPtr[i*4+2], fPtr[i*4+3]
-                    );
-                    uPtr[i] = cvt_uint32_aces_approx(color);
-                }
-            } else {
-                fbPointer = (void *)fb;
-            }
-            visionaray::vec4f bgColor(background_color(),1.f);
-            glClearColor(bgColor[0],bgColor[1],bgColor[2],bgColor[3]);
-            glClear(GL_COLOR_BUFFER_BIT);
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-            glDrawPixels(width(),height(),GL_RGBA,GL_UNSIGNED_BYTE,fbPointer);
+            displayColor(fb,widthOUT,heightOUT,typeOUT);
             anariUnmapFrame(anari.device, anari.frame, "channel.color");
-            if (fbPointer != fb) {
-                delete[] (uint32_t *)fbPointer;
-            }
         } else {
             uint32_t widthOUT;
             uint32_t heightOUT;
             ANARIDataType typeOUT;
             const float *dbPointer = (float *)anariMapFrame(anari.device, anari.frame, "channel.depth", &widthOUT, &heightOUT, &typeOUT);
-            float *cpy = (float *)malloc(width()*height()*anari::sizeOf(typeOUT));
-            memcpy(cpy,dbPointer,width()*height()*sizeof(float));
-            float max = 0.f;
-            for (int i=0; i<width()*height(); ++i) {
-                if (!std::isinf(cpy[i]))
-                    max = std::max(max,cpy[i]);
-            }
-            for (int i=0; i<width()*height(); ++i) {
-                cpy[i] /= max;
+            if (dbPointer != nullptr && typeOUT == ANARI_FLOAT32) {
+                size_t numPixels = widthOUT*size_t(heightOUT);
+                float *cpy = (float *)malloc(numPixels*sizeof(float));
+                memcpy(cpy,dbPointer,numPixels*sizeof(float));
+                float max = 0.f;
+                for (size_t i=0; i<numPixels; ++i) {
+                    if (!std::isinf(cpy[i]))
+                        max = std::max(max,cpy[i]);
+                }
+                for (size_t i=0; i<numPixels; ++i) {
+                    cpy[i] /= max;
+                }
+                glClear(GL_DEPTH_BUFFER_BIT);
+                glDrawPixels(widthOUT,heightOUT,GL_LUMINANCE,GL_FLOAT,cpy);
+                free(cpy);
             }
-            glClear(GL_DEPTH_BUFFER_BIT);
-            glDrawPixels(width(),height(),GL_LUMINANCE,GL_FLOAT,cpy);
-            free(cpy);
             anariUnmapFrame(anari.device, anari.frame, "channel.depth");
         }
 
@@ -364,6 +478,7 @@ struct Viewer : visionaray::viewer_glut
         Scene* scene = nullptr;
         std::string deviceSubtype;
         std::string hdri;
+        ANARIDataType colorFormat{ANARI_UFIXED8_VEC4};
 
 
 
@@ -455,14 +570,13 @@ struct Viewer : visionaray::viewer_glut
             frame = anariNewFrame(device);
             anariSetParameter(device, frame, "world", ANARI_WORLD, &world);
             anariCommitParameters(device, frame);
-            ANARIDataType fbFormat{ANARI_UFIXED8_VEC4};
             if (instance.tonemapping == sRGB)
-                fbFormat = ANARI_UFIXED8_RGBA_SRGB;
+                colorFormat = ANARI_UFIXED8_RGBA_SRGB;
             else if (instance.tonemapping == ACES || instance.tonemapping == ACES_Approx)
-                fbFormat = ANARI_FLOAT32_VEC4;
+                colorFormat = ANARI_FLOAT32_VEC4;
             ANARIDataType dbFormat = ANARI_FLOAT32;
-            anariSetParameter(device, frame, "channel.color", ANARI_DATA_TYPE, &fbFormat);
-            //anariSetParameter(device, frame, "channel.depth", ANARI_DATA_TYPE, &dbFormat);
+            anariSetParameter(device, frame, "channel.color", ANARI_DATA_TYPE, &colorFormat);
+            anariSetParameter(device, frame, "channel.depth", ANARI_DATA_TYPE, &dbFormat);
             anariSetParameter(device, frame, "renderer", ANARI_RENDERER, &renderer);
             //renderer = anariNewRenderer(device, "raycast");
             //renderer = anariNewRenderer(device, "ao");